@@ -0,0 +1,37 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "../src/core/DesignIO.h"
+
+// Random design with `count` components of all four kinds at quarter-turn
+// rotations and `count` short horizontal wires, on grid cells of a square
+// that grows with count so the density is the same at every size.
+inline void generate_design(size_t count, DesignStore& design, uint32_t seed = 42) {
+    std::mt19937 rng(seed);
+    const int half = std::max(100, static_cast<int>(std::sqrt(static_cast<double>(count)) * 2));
+    std::uniform_int_distribution<int> cell(-half, half);
+    design.clear();
+    design.reserve(count, count);
+    for (size_t i = 0; i < count; ++i) {
+        auto kind = static_cast<ComponentKind>(i % 4);
+        double h = kind == ComponentKind::Transistor ? 40 : 20;
+        double x = cell(rng) * 20 - 20;
+        double y = cell(rng) * 20 - h / 2;
+        design.add_component(kind, x, y, 40, h, 90.0 * (i % 4), default_component_value(kind));
+
+        double wx = cell(rng) * 20, wy = cell(rng) * 20;
+        design.add_wire(wx, wy, wx + 20 * (1 + i % 7), wy);
+    }
+}
+
+inline void generate_design(size_t count, ComponentList& components, WireList& wires, uint32_t seed = 42) {
+    DesignStore design;
+    generate_design(count, design, seed);
+    design.to_lists(components, wires);
+}
@@ -0,0 +1,288 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+// Microbenchmarks of the editor's hot paths on synthetic designs of 1k to 1M
+// components and as many wires. Uses Google Benchmark, so results can be
+// written as JSON for tracking across versions:
+//
+//   acad-bench --benchmark_out=results.json --benchmark_out_format=json
+//   acad-bench --benchmark_filter='Load.*/100000'
+
+#include <benchmark/benchmark.h>
+#include <cairomm/context.h>
+#include <cairomm/surface.h>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/core/DesignIO.h"
+#include "../src/core/DesignRules.h"
+#include "../src/core/HitTest.h"
+#include "../src/core/Router.h"
+#include "../src/core/SpatialIndex.h"
+#include "../src/render/Renderer.h"
+#include "../src/util/ThreadPool.h"
+#include "SyntheticDesign.h"
+
+namespace {
+
+constexpr size_t QUERY_POINTS = 4096;
+constexpr int VIEW_WIDTH = 1920;
+constexpr int VIEW_HEIGHT = 1080;
+
+// The design of the size being measured, indexed the way the canvas indexes
+// it. Only one size is kept so the 1M case doesn't hold several copies.
+struct Fixture {
+    size_t count = 0;
+    DesignStore design;
+    SpatialIndex<ComponentHandle> component_index;
+    SpatialIndex<WireHandle> wire_index;
+    // Half on an object, half anywhere in the design's extent.
+    std::vector<std::pair<double, double>> component_points;
+    std::vector<std::pair<double, double>> wire_points;
+};
+
+const Fixture& fixture(size_t count) {
+    static std::unique_ptr<Fixture> current;
+    if (current && current->count == count) return *current;
+
+    current.reset();
+    auto f = std::make_unique<Fixture>();
+    f->count = count;
+    generate_design(count, f->design);
+    const DesignStore& d = f->design;
+    for (size_t i = 0; i < count; ++i) {
+        f->component_index.insert(d.component_handle(i), d.geometry(i).draw_bounds());
+        f->wire_index.insert(d.wire_handle(i), d.wire_bounds(i));
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<size_t> pick(0, count - 1);
+    const double half = std::max(100.0, std::sqrt(static_cast<double>(count)) * 2) * 20;
+    std::uniform_real_distribution<double> anywhere(-half, half);
+    for (size_t i = 0; i < QUERY_POINTS; ++i) {
+        if (i % 2 == 0) {
+            const ComponentGeometry comp = d.geometry(pick(rng));
+            f->component_points.emplace_back(comp.x + comp.width / 2, comp.y + comp.height / 2);
+            const size_t wire = pick(rng);
+            f->wire_points.emplace_back((d.wires().x1[wire] + d.wires().x2[wire]) / 2, d.wires().y1[wire] + 1);
+        } else {
+            f->component_points.emplace_back(anywhere(rng), anywhere(rng));
+            f->wire_points.emplace_back(anywhere(rng), anywhere(rng));
+        }
+    }
+    current = std::move(f);
+    return *current;
+}
+
+std::string temp_file(const char* extension) {
+    return (std::filesystem::temp_directory_path() / ("acad-bench" + std::string(extension))).string();
+}
+
+// As CircuitCanvas does before a batched hit test.
+template <typename Handle>
+void candidate_positions(const DesignStore& design, const std::vector<Handle>& handles,
+                         std::vector<uint32_t>& out) {
+    out.clear();
+    for (Handle h : handles)
+        out.push_back(static_cast<uint32_t>(design.index_of(h)));
+    std::sort(out.begin(), out.end());
+}
+
+void sizes(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(10)->Range(1000, 1000000);
+}
+
+// CircuitCanvas::get_component_at
+void BM_GetComponentAt(benchmark::State& state) {
+    const Fixture& f = fixture(state.range(0));
+    std::vector<ComponentHandle> handles;
+    std::vector<uint32_t> positions;
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& [x, y] = f.component_points[i++ % QUERY_POINTS];
+        f.component_index.candidates_at(x, y, handles);
+        candidate_positions(f.design, handles, positions);
+        benchmark::DoNotOptimize(topmost_component_at(f.design, positions, x, y));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(hit_test_isa());
+}
+BENCHMARK(BM_GetComponentAt)->Apply(sizes);
+
+// The wire lookup on every pointer motion.
+void BM_WireHover(benchmark::State& state) {
+    const Fixture& f = fixture(state.range(0));
+    std::vector<WireHandle> handles;
+    std::vector<uint32_t> positions;
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& [x, y] = f.wire_points[i++ % QUERY_POINTS];
+        f.wire_index.candidates_at(x, y, handles);
+        candidate_positions(f.design, handles, positions);
+        benchmark::DoNotOptimize(topmost_wire_at(f.design, positions, x, y));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(hit_test_isa());
+}
+BENCHMARK(BM_WireHover)->Apply(sizes);
+
+// Everything entirely inside a full-HD rectangle at the design's center,
+// scanning the whole store with the batched kernels.
+void BM_BoxSelect(benchmark::State& state) {
+    const Fixture& f = fixture(state.range(0));
+    const Rect box{-VIEW_WIDTH / 2.0, -VIEW_HEIGHT / 2.0, VIEW_WIDTH / 2.0, VIEW_HEIGHT / 2.0};
+    std::vector<size_t> components, wires;
+    for (auto _ : state) {
+        components.clear();
+        wires.clear();
+        components_inside_rect(f.design, nullptr, box, components);
+        wires_inside_rect(f.design, nullptr, box, wires);
+        benchmark::DoNotOptimize(components.data());
+        benchmark::DoNotOptimize(wires.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 2 * f.count);
+    state.counters["selected"] = static_cast<double>(components.size() + wires.size());
+    state.SetLabel(hit_test_isa());
+}
+BENCHMARK(BM_BoxSelect)->Apply(sizes)->Unit(benchmark::kMicrosecond);
+
+constexpr size_t ROUTE_CONNECTIONS = 2000;
+constexpr double ROUTE_REACH = 50 * GRID_SIZE;
+
+// Router::route_all on every core, over connections from a pin of a random
+// part to a pin of another part at most ROUTE_REACH away on each axis.
+void BM_RouteBatch(benchmark::State& state) {
+    const Fixture& f = fixture(state.range(0));
+    const DesignStore& d = f.design;
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<size_t> pick(0, f.count - 1);
+    std::vector<RouteRequest> requests;
+    Pin pins[ComponentGeometry::MAX_PINS];
+    while (requests.size() < ROUTE_CONNECTIONS) {
+        d.geometry(pick(rng)).pins(pins);
+        const Pin from = pins[0];
+        const Rect reach{from.x - ROUTE_REACH, from.y - ROUTE_REACH, from.x + ROUTE_REACH, from.y + ROUTE_REACH};
+        const std::vector<ComponentHandle> near = f.component_index.query(reach);
+        if (near.size() < 2) continue;
+        d.geometry(d.index_of(near[rng() % near.size()])).pins(pins);
+        requests.push_back({from.x, from.y, pins[1].x, pins[1].y});
+    }
+
+    static ThreadPool pool;
+    const Router router(d);
+    std::vector<RoutePath> routes;
+    size_t routed = 0;
+    for (auto _ : state) {
+        routed = router.route_all(requests, routes, pool);
+        benchmark::DoNotOptimize(routes.data());
+    }
+    state.SetItemsProcessed(state.iterations() * requests.size());
+    state.counters["routed"] = static_cast<double>(routed);
+    state.counters["threads"] = static_cast<double>(pool.size());
+}
+BENCHMARK(BM_RouteBatch)->Apply(sizes)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// The world pass of CircuitCanvas::on_draw at zoom 1 over a full-HD view
+// centered on the design, into an offscreen image. The grid and overlays
+// are left out.
+void BM_DrawViewport(benchmark::State& state) {
+    const Fixture& f = fixture(state.range(0));
+    auto surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, VIEW_WIDTH, VIEW_HEIGHT);
+    const Rect visible{-VIEW_WIDTH / 2.0, -VIEW_HEIGHT / 2.0, VIEW_WIDTH / 2.0, VIEW_HEIGHT / 2.0};
+    size_t drawn = 0;
+    for (auto _ : state) {
+        auto cr = Cairo::Context::create(surface);
+        cr->set_source_rgb(1, 1, 1);
+        cr->paint();
+        cr->translate(VIEW_WIDTH / 2.0, VIEW_HEIGHT / 2.0);
+        drawn = 0;
+        const DesignStore::WireColumns& w = f.design.wires();
+        for (WireHandle wire : f.wire_index.query(visible)) {
+            size_t i = f.design.index_of(wire);
+            draw_wire(cr, w.x1[i], w.y1[i], w.x2[i], w.y2[i]);
+            ++drawn;
+        }
+        for (ComponentHandle comp : f.component_index.query(visible)) {
+            draw_component(cr, f.design.geometry(f.design.index_of(comp)));
+            ++drawn;
+        }
+        surface->flush();
+    }
+    state.counters["drawn"] = static_cast<double>(drawn);
+}
+BENCHMARK(BM_DrawViewport)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+// DesignRuleChecker::check_all, as CircuitCanvas runs it after a load.
+void BM_DrcCheckAll(benchmark::State& state) {
+    const Fixture& f = fixture(state.range(0));
+    size_t violations = 0;
+    for (auto _ : state) {
+        DesignRuleChecker rules;
+        rules.check_all(f.design);
+        violations = rules.violation_count();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+    state.counters["violations"] = static_cast<double>(violations);
+}
+BENCHMARK(BM_DrcCheckAll)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+// CircuitCanvas::save_to_file
+void save(benchmark::State& state, const char* extension) {
+    const Fixture& f = fixture(state.range(0));
+    const std::string path = temp_file(extension);
+    for (auto _ : state) {
+        if (!save_design(path, f.design)) state.SkipWithError("save failed");
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+    state.counters["bytes"] = static_cast<double>(std::filesystem::file_size(path));
+    std::remove(path.c_str());
+}
+
+// CircuitCanvas::load_from_file
+void load(benchmark::State& state, const char* extension) {
+    const Fixture& f = fixture(state.range(0));
+    const std::string path = temp_file(extension);
+    save_design(path, f.design);
+    for (auto _ : state) {
+        DesignStore design;
+        if (!load_design(path, design)) state.SkipWithError("load failed");
+        benchmark::DoNotOptimize(design.components().x.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+    std::remove(path.c_str());
+}
+
+void BM_SaveJson(benchmark::State& state) { save(state, ".json"); }
+void BM_SaveBinary(benchmark::State& state) { save(state, ".acb"); }
+void BM_LoadJson(benchmark::State& state) { load(state, ".json"); }
+void BM_LoadBinary(benchmark::State& state) { load(state, ".acb"); }
+BENCHMARK(BM_SaveJson)->Apply(sizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SaveBinary)->Apply(sizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadJson)->Apply(sizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadBinary)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+// CircuitComponent::deserialize over every component of an already parsed
+// document, i.e. the DOM loader's per-object cost.
+void BM_Deserialize(benchmark::State& state) {
+    const Fixture& f = fixture(state.range(0));
+    ComponentList components;
+    WireList wires;
+    f.design.to_lists(components, wires);
+    json array = json::array();
+    for (const auto& comp : components) array.push_back(comp->serialize());
+    for (auto _ : state) {
+        for (const auto& j : array)
+            benchmark::DoNotOptimize(CircuitComponent::deserialize(j));
+    }
+    state.SetItemsProcessed(state.iterations() * array.size());
+}
+BENCHMARK(BM_Deserialize)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,129 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+// Compares the streaming SAX JSON loader against the previous approach of
+// parsing the whole file into a DOM first. Each loader runs in its own forked
+// process so its peak RSS is measured in isolation.
+//
+//   acad-load-compare design.json
+//   acad-load-compare --generate 100000 design.json
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <nlohmann/json.hpp>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../src/core/DesignIO.h"
+#include "SyntheticDesign.h"
+
+namespace {
+
+bool load_with_dom(const std::string& filename, ComponentList& components, WireList& wires) {
+    std::ifstream file(filename);
+    if (!file.is_open()) return false;
+
+    nlohmann::json j;
+    file >> j;
+    for (const auto& jc : j["components"])
+        components.push_back(CircuitComponent::deserialize(jc));
+    for (const auto& jw : j["wires"])
+        wires.push_back(Wire::deserialize(jw));
+    return true;
+}
+
+double peak_rss_mb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+    return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+struct Result {
+    bool ok;
+    double ms;
+    double rss_mb;
+    size_t components;
+    size_t wires;
+};
+
+Result run_in_child(const std::string& filename, bool use_dom) {
+    int fds[2];
+    if (pipe(fds) != 0) return Result{false, 0, 0, 0, 0};
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        ComponentList components;
+        WireList wires;
+        auto start = std::chrono::steady_clock::now();
+        bool ok;
+        try {
+            ok = use_dom ? load_with_dom(filename, components, wires)
+                         : load_json_design(filename, components, wires);
+        } catch (...) {
+            ok = false;
+        }
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        Result r{ok, ms, peak_rss_mb(), components.size(), wires.size()};
+        ssize_t n = write(fds[1], &r, sizeof(r));
+        _exit(n == sizeof(r) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    Result r{false, 0, 0, 0, 0};
+    if (pid < 0 || read(fds[0], &r, sizeof(r)) != sizeof(r)) r.ok = false;
+    close(fds[0]);
+    if (pid > 0) waitpid(pid, nullptr, 0);
+    return r;
+}
+
+void generate(const std::string& filename, int count) {
+    ComponentList components;
+    WireList wires;
+    generate_design(count, components, wires);
+    save_json_design(filename, components, wires);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string filename;
+    if (argc == 4 && std::string(argv[1]) == "--generate") {
+        filename = argv[3];
+        // Generate in a child too, so its allocations don't inflate the measured RSS.
+        pid_t pid = fork();
+        if (pid == 0) {
+            generate(filename, std::atoi(argv[2]));
+            _exit(0);
+        }
+        if (pid > 0) waitpid(pid, nullptr, 0);
+    } else if (argc == 2) {
+        filename = argv[1];
+    } else {
+        std::cerr << "usage: " << argv[0] << " [--generate COUNT] design.json\n";
+        return 1;
+    }
+
+    std::printf("%-6s %12s %14s %12s %10s\n", "loader", "time (ms)", "peak RSS (MB)", "components", "wires");
+    for (bool use_dom : {true, false}) {
+        Result r = run_in_child(filename, use_dom);
+        if (!r.ok) {
+            std::printf("%-6s failed\n", use_dom ? "dom" : "sax");
+            continue;
+        }
+        std::printf("%-6s %12.1f %14.1f %12zu %10zu\n", use_dom ? "dom" : "sax",
+                    r.ms, r.rss_mb, r.components, r.wires);
+    }
+    return 0;
+}
@@ -0,0 +1,294 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "BinaryDesign.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Subcircuit.h"
+
+// Records are written and mapped in host byte order.
+static_assert(std::endian::native == std::endian::little, "binary designs assume a little-endian host");
+
+namespace {
+
+constexpr size_t WRITE_CHUNK = 4096;
+
+uint64_t align8(uint64_t v) {
+    return (v + 7) & ~uint64_t(7);
+}
+
+// Read-only mapping of a whole file, unmapped on destruction.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                data = static_cast<const unsigned char*>(p);
+                size = static_cast<size_t>(st.st_size);
+            }
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (data) ::munmap(const_cast<unsigned char*>(data), size);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+};
+
+bool section_fits(const MappedFile& file, uint64_t offset, uint64_t count, size_t record_size) {
+    if (offset > file.size) return false;
+    if (count > (file.size - offset) / record_size) return false;
+    return true;
+}
+
+template <typename T>
+T read_record(const unsigned char* base, uint64_t offset, uint64_t index) {
+    T record;
+    std::memcpy(&record, base + offset + index * sizeof(T), sizeof(T));
+    return record;
+}
+
+template <typename T>
+void write_items(std::ofstream& file, const std::vector<T>& items, uint64_t& written) {
+    file.write(reinterpret_cast<const char*>(items.data()), items.size() * sizeof(T));
+    written += items.size() * sizeof(T);
+}
+
+void pad_to(std::ofstream& file, uint64_t& written, uint64_t target) {
+    static const char zeros[8] = {};
+    file.write(zeros, target - written);
+    written = target;
+}
+
+}
+
+bool save_binary_design(const std::string& filename, const DesignStore& design) {
+    try {
+        // The top-level parts and wires, then each placed definition's.
+        const std::vector<uint32_t> numbers = design.placed_definition_numbers();
+        std::vector<const DesignStore*> stores{&design};
+        for (uint32_t d = 0; d < design.definition_count(); ++d) {
+            if (numbers[d] != DesignStore::NO_DEFINITION) stores.push_back(&design.definition(d).contents());
+        }
+        uint64_t component_total = 0, wire_total = 0;
+        for (const DesignStore* store : stores) {
+            component_total += store->component_count();
+            wire_total += store->wire_count();
+        }
+
+        // Type and string tables: one entry per kind used, in order of first use.
+        std::vector<TypeEntry> types;
+        std::string strings;
+        constexpr size_t KIND_COUNT = static_cast<size_t>(ComponentKind::Transistor) + 1;
+        uint32_t type_of_kind[KIND_COUNT];
+        std::fill(std::begin(type_of_kind), std::end(type_of_kind), UINT32_MAX);
+        for (const DesignStore* store : stores) {
+            for (ComponentKind kind : store->components().kind) {
+                uint32_t& type = type_of_kind[static_cast<size_t>(kind)];
+                if (type != UINT32_MAX) continue;
+                const std::string name = component_type_name(kind);
+                type = static_cast<uint32_t>(types.size());
+                types.push_back(TypeEntry{static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(name.size())});
+                strings += name;
+            }
+        }
+        std::vector<DefinitionRecord> definitions;
+        for (uint32_t d = 0; d < design.definition_count(); ++d) {
+            if (numbers[d] == DesignStore::NO_DEFINITION) continue;
+            const SubcircuitDefinition& definition = design.definition(d);
+            definitions.push_back(DefinitionRecord{static_cast<uint32_t>(strings.size()),
+                                                   static_cast<uint32_t>(definition.name().size()),
+                                                   definition.contents().component_count(),
+                                                   definition.contents().wire_count()});
+            strings += definition.name();
+        }
+        const DesignStore::InstanceColumns& n = design.instances();
+        std::vector<InstanceRecord> instances;
+        instances.reserve(n.size());
+        for (size_t i = 0; i < n.size(); ++i)
+            instances.push_back(InstanceRecord{numbers[n.definition[i]], 0, n.x[i], n.y[i], n.rotation[i]});
+
+        BinaryDesignHeader header{};
+        std::memcpy(header.magic, BINARY_DESIGN_MAGIC, sizeof(header.magic));
+        header.version = BINARY_DESIGN_VERSION;
+        header.header_size = sizeof(BinaryDesignHeader);
+        header.type_count = types.size();
+        header.component_count = design.component_count();
+        header.wire_count = design.wire_count();
+        header.string_bytes = strings.size();
+        header.definition_count = definitions.size();
+        header.instance_count = instances.size();
+        header.type_table_offset = align8(sizeof(BinaryDesignHeader));
+        header.component_offset = align8(header.type_table_offset + types.size() * sizeof(TypeEntry));
+        header.wire_offset = align8(header.component_offset + component_total * sizeof(ComponentRecord));
+        header.definition_offset = align8(header.wire_offset + wire_total * sizeof(WireRecord));
+        header.instance_offset = align8(header.definition_offset + definitions.size() * sizeof(DefinitionRecord));
+        header.string_offset = align8(header.instance_offset + instances.size() * sizeof(InstanceRecord));
+
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+
+        uint64_t written = 0;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        written += sizeof(header);
+
+        pad_to(file, written, header.type_table_offset);
+        write_items(file, types, written);
+
+        pad_to(file, written, header.component_offset);
+        std::vector<ComponentRecord> component_chunk;
+        component_chunk.reserve(WRITE_CHUNK);
+        for (const DesignStore* store : stores) {
+            const DesignStore::ComponentColumns& c = store->components();
+            for (size_t i = 0; i < c.size(); ++i) {
+                component_chunk.push_back(ComponentRecord{type_of_kind[static_cast<size_t>(c.kind[i])], 0, c.x[i],
+                                                          c.y[i], c.width[i], c.height[i], c.rotation[i], c.value[i]});
+                if (component_chunk.size() == WRITE_CHUNK) {
+                    write_items(file, component_chunk, written);
+                    component_chunk.clear();
+                }
+            }
+        }
+        write_items(file, component_chunk, written);
+
+        pad_to(file, written, header.wire_offset);
+        std::vector<WireRecord> wire_chunk;
+        wire_chunk.reserve(WRITE_CHUNK);
+        for (const DesignStore* store : stores) {
+            const DesignStore::WireColumns& w = store->wires();
+            for (size_t i = 0; i < w.size(); ++i) {
+                wire_chunk.push_back(WireRecord{w.x1[i], w.y1[i], w.x2[i], w.y2[i]});
+                if (wire_chunk.size() == WRITE_CHUNK) {
+                    write_items(file, wire_chunk, written);
+                    wire_chunk.clear();
+                }
+            }
+        }
+        write_items(file, wire_chunk, written);
+
+        pad_to(file, written, header.definition_offset);
+        write_items(file, definitions, written);
+        pad_to(file, written, header.instance_offset);
+        write_items(file, instances, written);
+
+        pad_to(file, written, header.string_offset);
+        file.write(strings.data(), strings.size());
+        return file.good();
+    } catch (...) {
+        return false;
+    }
+}
+
+bool load_binary_design(const std::string& filename, DesignStore& design) {
+    try {
+        MappedFile file(filename);
+        if (!file.data || file.size < BINARY_DESIGN_V2_HEADER_SIZE) return false;
+
+        // Fields past an older, shorter header read as zero.
+        BinaryDesignHeader header{};
+        std::memcpy(&header, file.data, BINARY_DESIGN_V2_HEADER_SIZE);
+        if (std::memcmp(header.magic, BINARY_DESIGN_MAGIC, sizeof(header.magic)) != 0) return false;
+        if (header.version == 0 || header.version > BINARY_DESIGN_VERSION) return false;
+        if (header.version >= 3) {
+            if (header.header_size < sizeof(BinaryDesignHeader) || file.size < sizeof(BinaryDesignHeader)) return false;
+            std::memcpy(&header, file.data, sizeof(BinaryDesignHeader));
+        }
+        const bool v1 = header.version == 1;
+        const size_t component_record_size = v1 ? sizeof(ComponentRecordV1) : sizeof(ComponentRecord);
+        if (!section_fits(file, header.definition_offset, header.definition_count, sizeof(DefinitionRecord)) ||
+            !section_fits(file, header.instance_offset, header.instance_count, sizeof(InstanceRecord)) ||
+            !section_fits(file, header.type_table_offset, header.type_count, sizeof(TypeEntry)) ||
+            !section_fits(file, header.string_offset, header.string_bytes, 1))
+            return false;
+
+        // The component and wire sections also hold each definition's.
+        const char* strings = reinterpret_cast<const char*>(file.data + header.string_offset);
+        std::vector<DefinitionRecord> definitions;
+        definitions.reserve(header.definition_count);
+        uint64_t component_total = header.component_count, wire_total = header.wire_count;
+        for (uint64_t i = 0; i < header.definition_count; ++i) {
+            DefinitionRecord d = read_record<DefinitionRecord>(file.data, header.definition_offset, i);
+            if (uint64_t(d.name_offset) + d.name_length > header.string_bytes) return false;
+            if (d.component_count > UINT64_MAX - component_total || d.wire_count > UINT64_MAX - wire_total)
+                return false;
+            component_total += d.component_count;
+            wire_total += d.wire_count;
+            definitions.push_back(d);
+        }
+        if (!section_fits(file, header.component_offset, component_total, component_record_size) ||
+            !section_fits(file, header.wire_offset, wire_total, sizeof(WireRecord)))
+            return false;
+
+        // Resolve each type name once; records then index straight into this table.
+        std::vector<ComponentKind> kinds;
+        kinds.reserve(header.type_count);
+        for (uint64_t i = 0; i < header.type_count; ++i) {
+            TypeEntry entry = read_record<TypeEntry>(file.data, header.type_table_offset, i);
+            if (uint64_t(entry.name_offset) + entry.name_length > header.string_bytes) return false;
+            kinds.push_back(CircuitComponent::kind_from_name(
+                std::string(strings + entry.name_offset, entry.name_length)));
+        }
+
+        uint64_t next_component = 0, next_wire = 0;
+        auto read_parts = [&](DesignStore& store, uint64_t components, uint64_t wires) {
+            store.reserve(components, wires);
+            for (uint64_t end = next_component + components; next_component < end; ++next_component) {
+                ComponentRecord r;
+                if (v1) {
+                    ComponentRecordV1 old =
+                        read_record<ComponentRecordV1>(file.data, header.component_offset, next_component);
+                    if (old.type >= kinds.size()) return false;
+                    r = ComponentRecord{old.type, 0, old.x, old.y, old.width, old.height, old.rotation,
+                                        default_component_value(kinds[old.type])};
+                } else {
+                    r = read_record<ComponentRecord>(file.data, header.component_offset, next_component);
+                    if (r.type >= kinds.size()) return false;
+                }
+                store.add_component(kinds[r.type], r.x, r.y, r.width, r.height, r.rotation, r.value);
+            }
+            for (uint64_t end = next_wire + wires; next_wire < end; ++next_wire) {
+                WireRecord r = read_record<WireRecord>(file.data, header.wire_offset, next_wire);
+                store.add_wire(r.x1, r.y1, r.x2, r.y2);
+            }
+            return true;
+        };
+
+        DesignStore loaded;
+        if (!read_parts(loaded, header.component_count, header.wire_count)) return false;
+        for (const DefinitionRecord& d : definitions) {
+            DesignStore contents;
+            if (!read_parts(contents, d.component_count, d.wire_count)) return false;
+            loaded.add_definition(std::make_shared<const SubcircuitDefinition>(
+                std::string(strings + d.name_offset, d.name_length), std::move(contents)));
+        }
+        for (uint64_t i = 0; i < header.instance_count; ++i) {
+            InstanceRecord r = read_record<InstanceRecord>(file.data, header.instance_offset, i);
+            if (r.definition >= definitions.size()) return false;
+            loaded.add_instance(r.definition, r.x, r.y, r.rotation);
+        }
+
+        design = std::move(loaded);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
@@ -0,0 +1,108 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include "DesignStore.h"
+
+// Compact binary design format (".acb"). The file is a header followed by
+// six 8-byte aligned sections:
+//
+//   type table   TypeEntry per component type name used in the file
+//   components   ComponentRecord per component, in stacking order, then
+//                those of each subcircuit definition in turn
+//   wires        WireRecord per wire, likewise
+//   definitions  DefinitionRecord per subcircuit definition
+//   instances    InstanceRecord per instance, in stacking order
+//   strings      UTF-8 bytes referenced by offset/length (type and
+//                definition names)
+//
+// All fields are little-endian. Records are fixed size so a reader can map
+// the file and walk the sections directly without parsing. Each definition
+// is stored once however many instances place it. Version 1 files, written
+// before components had values, and version 2 files, written before
+// subcircuits, are still read; their header is the first 80 bytes of this
+// one.
+constexpr const char* BINARY_DESIGN_EXTENSION = ".acb";
+constexpr char BINARY_DESIGN_MAGIC[8] = {'A', 'C', 'A', 'D', 'B', 'I', 'N', '\0'};
+constexpr uint32_t BINARY_DESIGN_VERSION = 3;
+
+struct BinaryDesignHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t type_count;
+    uint64_t component_count;
+    uint64_t wire_count;
+    uint64_t string_bytes;
+    uint64_t type_table_offset;
+    uint64_t component_offset;
+    uint64_t wire_offset;
+    uint64_t string_offset;
+    // Version 3.
+    uint64_t definition_count;
+    uint64_t instance_count;
+    uint64_t definition_offset;
+    uint64_t instance_offset;
+};
+
+// Header size of versions 1 and 2.
+constexpr uint32_t BINARY_DESIGN_V2_HEADER_SIZE = 80;
+
+struct TypeEntry {
+    uint32_t name_offset;
+    uint32_t name_length;
+};
+
+struct ComponentRecord {
+    uint32_t type;      // index into the type table
+    uint32_t reserved;
+    double x, y;
+    double width, height;
+    double rotation;
+    double value;
+};
+
+// Component record layout of version 1 files.
+struct ComponentRecordV1 {
+    uint32_t type;
+    uint32_t reserved;
+    double x, y;
+    double width, height;
+    double rotation;
+};
+
+struct WireRecord {
+    double x1, y1, x2, y2;
+};
+
+// A definition's parts and wires are the next component_count and
+// wire_count records after those of the definitions before it.
+struct DefinitionRecord {
+    uint32_t name_offset;
+    uint32_t name_length;
+    uint64_t component_count;
+    uint64_t wire_count;
+};
+
+struct InstanceRecord {
+    uint32_t definition;
+    uint32_t reserved;
+    double x, y;
+    double rotation;
+};
+
+static_assert(sizeof(BinaryDesignHeader) == 112, "unexpected header padding");
+static_assert(sizeof(ComponentRecord) == 56, "unexpected component record padding");
+static_assert(sizeof(ComponentRecordV1) == 48, "unexpected component record padding");
+static_assert(sizeof(WireRecord) == 32, "unexpected wire record padding");
+static_assert(sizeof(DefinitionRecord) == 24, "unexpected definition record padding");
+static_assert(sizeof(InstanceRecord) == 32, "unexpected instance record padding");
+
+bool save_binary_design(const std::string& filename, const DesignStore& design);
+
+// Memory-maps the file and fills the store's columns straight from the records.
+bool load_binary_design(const std::string& filename, DesignStore& design);
@@ -4,10 +4,13 @@
 */
 
 #pragma once
-#include <cairomm/context.h>
 #include <nlohmann/json.hpp>
 #include <memory>
 #include <stdexcept>
+#include <string>
+#include <vector>
+#include "ComponentGeometry.h"
+#include "../util/Rect.h"
 
 using json = nlohmann::json;
 
@@ -19,13 +22,14 @@ class Transistor;
 class CircuitComponent {
 public:
     CircuitComponent(double x, double y, double w = 40, double h = 20)
-        : x(x), y(y), width(w), height(h), rotation(0) {}
+        : x(x), y(y), width(w), height(h), value(0), rotation(0) {}
 
     virtual ~CircuitComponent() = default;
-    virtual void draw(const Cairo::RefPtr<Cairo::Context>& cr) = 0;
-    virtual bool contains_point(double px, double py) = 0;
-    virtual std::string get_type() const = 0;
-    virtual json serialize() const {
+    virtual ComponentKind get_kind() const = 0;
+
+    std::string get_type() const { return component_type_name(get_kind()); }
+
+    json serialize() const {
         json j;
         j["type"] = get_type();
         j["x"] = x;
@@ -33,17 +37,38 @@ public:
         j["width"] = width;
         j["height"] = height;
         j["rotation"] = rotation;
+        j["value"] = value;
         return j;
     }
 
+    ComponentGeometry geometry() const {
+        return ComponentGeometry{get_kind(), x, y, width, height, rotation};
+    }
+
+    bool contains_point(double px, double py) const { return geometry().contains_point(px, py); }
+    const char* get_value_unit() const { return component_value_unit(get_kind()); }
+    Rect get_bounds() const { return geometry().bounds(); }
+    Rect get_draw_bounds() const { return geometry().draw_bounds(); }
+
+    static constexpr size_t MAX_PINS = ComponentGeometry::MAX_PINS;
+    size_t get_pins(Pin* out) const { return geometry().pins(out); }
+
     void set_rotation(double r) { rotation = r; }
     double get_rotation() const { return rotation; }
     double x, y;
     double width, height;
+    // Electrical value in SI units: resistance, capacitance, inductance, or
+    // the forward current gain of a transistor.
+    double value;
 
 protected:
     double rotation;
 
 public:
     static std::shared_ptr<CircuitComponent> deserialize(const json& j);
+    static std::shared_ptr<CircuitComponent> create(ComponentKind kind, double x, double y,
+                                                    double w, double h);
+    static ComponentKind kind_from_name(const std::string& type);
 };
+
+using ComponentList = std::vector<std::shared_ptr<CircuitComponent>>;
@@ -0,0 +1,114 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "../util/Constants.h"
+#include "../util/Rect.h"
+
+enum class ComponentKind : uint8_t { Resistor, Capacitor, Coil, Transistor };
+
+// A connection point in world coordinates.
+struct Pin {
+    const char* name;
+    double x, y;
+};
+
+const char* component_type_name(ComponentKind kind);
+// Unit of a kind's value as written after it, e.g. "ohm" for a resistor.
+const char* component_value_unit(ComponentKind kind);
+double default_component_value(ComponentKind kind);
+// Size a part of this kind is placed with.
+void default_component_size(ComponentKind kind, double& width, double& height);
+
+// Shape of one placed part, enough to hit-test, cull and draw it. Every
+// kind is a (rotated) box; only the drawn extents and pins differ. Used by
+// both the component classes and DesignStore, so the two agree exactly.
+struct ComponentGeometry {
+    ComponentKind kind;
+    double x, y;
+    double width, height;
+    double rotation;
+
+    static constexpr size_t MAX_PINS = 3;
+
+    // Axis-aligned box around the rotated hit area tested by contains_point.
+    Rect bounds() const {
+        return rotated_bounds(x + width/2, y + height/2, width, height);
+    }
+
+    // Box of the drawn body, with the pins on its edges. Only a transistor's
+    // differs from bounds(), being drawn half a grid cell lower.
+    Rect body_bounds() const {
+        if (kind != ComponentKind::Transistor) return bounds();
+        return rotated_bounds(x + width/2, y + height/2 + GRID_SIZE / 2.0, width, height);
+    }
+
+    // Box covering everything the renderer draws for the symbol, leads and
+    // stroke width included.
+    Rect draw_bounds() const {
+        switch (kind) {
+            case ComponentKind::Resistor:
+                return rotated_bounds(x + width/2, y + height/2, width + 20, height).expanded(2.0);
+            case ComponentKind::Coil:
+                return rotated_bounds(x + width/2, y + height/2, width + 10, height).expanded(2.0);
+            case ComponentKind::Transistor:
+                // The symbol is drawn half a grid cell below the hit area.
+                return rotated_bounds(x + width/2, y + height/2 + GRID_SIZE / 2.0, width, height)
+                    .united(bounds()).expanded(2.0);
+            case ComponentKind::Capacitor:
+                break;
+        }
+        return bounds().expanded(2.0);
+    }
+
+    bool contains_point(double px, double py) const {
+        double dx = px - (x + width/2);
+        double dy = py - (y + height/2);
+        double rad = -rotation * M_PI / 180.0;
+        double rx = dx * std::cos(rad) - dy * std::sin(rad);
+        double ry = dx * std::sin(rad) + dy * std::cos(rad);
+        return rx >= -width/2 && rx <= width/2 && ry >= -height/2 && ry <= height/2;
+    }
+
+    // Writes the pins, rotated with the symbol, to out and returns how many
+    // there are. Two-terminal parts have their pins at the ends of the
+    // body's long axis; a transistor has its collector on top, base on the
+    // left and emitter at the bottom of the drawn symbol.
+    size_t pins(Pin* out) const {
+        double cx = x + width/2;
+        double cy = y + height/2;
+        if (kind == ComponentKind::Transistor) {
+            cy += GRID_SIZE / 2.0;
+            out[0] = rotated_pin("C", cx, cy, 0, -height/2);
+            out[1] = rotated_pin("B", cx, cy, -width/2, 0);
+            out[2] = rotated_pin("E", cx, cy, 0, height/2);
+            return 3;
+        }
+        out[0] = rotated_pin("1", cx, cy, -width/2, 0);
+        out[1] = rotated_pin("2", cx, cy, width/2, 0);
+        return 2;
+    }
+
+private:
+    Rect rotated_bounds(double cx, double cy, double w, double h) const {
+        double rad = rotation * M_PI / 180.0;
+        double c = std::abs(std::cos(rad));
+        double s = std::abs(std::sin(rad));
+        double hw = (w * c + h * s) / 2.0;
+        double hh = (w * s + h * c) / 2.0;
+        return Rect{cx - hw, cy - hh, cx + hw, cy + hh};
+    }
+
+    // Pin at offset (dx, dy) from (cx, cy) in the unrotated symbol.
+    Pin rotated_pin(const char* name, double cx, double cy, double dx, double dy) const {
+        double rad = rotation * M_PI / 180.0;
+        double c = std::cos(rad);
+        double s = std::sin(rad);
+        return Pin{name, cx + dx * c - dy * s, cy + dx * s + dy * c};
+    }
+};
@@ -0,0 +1,409 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "DesignIO.h"
+#include "BinaryDesign.h"
+#include "Journal.h"
+#include "Subcircuit.h"
+#include <cmath>
+#include <cstdio>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <unistd.h>
+
+bool is_binary_design_file(const std::string& filename) {
+    const std::string ext = BINARY_DESIGN_EXTENSION;
+    return filename.size() >= ext.size() &&
+           filename.compare(filename.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+bool save_design(const std::string& filename, const DesignStore& design) {
+    bool ok = is_binary_design_file(filename) ? save_binary_design(filename, design)
+                                              : save_json_design(filename, design);
+    // A full save supersedes any journal written against the previous snapshot.
+    if (ok) std::remove(journal_path(filename).c_str());
+    return ok;
+}
+
+bool save_design(const std::string& filename, const ComponentList& components, const WireList& wires) {
+    return save_design(filename, DesignStore(components, wires));
+}
+
+// Flushes a file, or a directory's entries, to disk.
+static bool sync_path(const std::string& path, bool directory) {
+    int fd = open(path.c_str(), directory ? O_RDONLY | O_DIRECTORY : O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+// The temp file's data reaches the disk before the rename, and the rename
+// before returning, so a crash leaves either the old file or the new one.
+bool save_design_atomic(const std::string& filename, const DesignStore& design) {
+    const std::string temp = filename + ".tmp";
+    bool ok = is_binary_design_file(filename) ? save_binary_design(temp, design)
+                                              : save_json_design(temp, design);
+    if (!ok || !sync_path(temp, false) || std::rename(temp.c_str(), filename.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return false;
+    }
+    // The old journal belongs to the replaced snapshot either way.
+    std::filesystem::path directory = std::filesystem::path(filename).parent_path();
+    bool synced = sync_path(directory.empty() ? "." : directory.string(), true);
+    std::remove(journal_path(filename).c_str());
+    if (!synced) std::cerr << "Failed to sync directory of " << filename << std::endl;
+    return synced;
+}
+
+bool save_design_atomic(const std::string& filename, const ComponentList& components, const WireList& wires) {
+    return save_design_atomic(filename, DesignStore(components, wires));
+}
+
+static bool load_snapshot(const std::string& filename, DesignStore& design) {
+    if (is_binary_design_file(filename))
+        return load_binary_design(filename, design);
+    return load_json_design(filename, design);
+}
+
+// Loads the snapshot and replays its journal, if any. A journal that doesn't
+// verify against the snapshot is ignored rather than applied partially.
+bool load_design(const std::string& filename, DesignStore& design, bool& journal_replayed) {
+    DesignStore loaded;
+    if (!load_snapshot(filename, loaded)) return false;
+
+    journal_replayed = std::filesystem::exists(journal_path(filename));
+    if (!replay_journal(filename, loaded)) {
+        std::cerr << "Ignoring journal that does not match " << filename << std::endl;
+        journal_replayed = false;
+        if (!load_snapshot(filename, loaded)) return false;
+    }
+
+    design = std::move(loaded);
+    return true;
+}
+
+bool load_design(const std::string& filename, DesignStore& design) {
+    bool journal_replayed;
+    return load_design(filename, design, journal_replayed);
+}
+
+bool load_design(const std::string& filename, ComponentList& components, WireList& wires) {
+    DesignStore design;
+    if (!load_design(filename, design)) return false;
+    design.to_lists(components, wires);
+    return true;
+}
+
+namespace {
+
+void write_parts(nlohmann::json& j, const DesignStore& design) {
+    const DesignStore::ComponentColumns& c = design.components();
+    const DesignStore::WireColumns& w = design.wires();
+    j["components"] = nlohmann::json::array();
+    for (size_t i = 0; i < c.size(); ++i) {
+        nlohmann::json comp;
+        comp["type"] = component_type_name(c.kind[i]);
+        comp["x"] = c.x[i];
+        comp["y"] = c.y[i];
+        comp["width"] = c.width[i];
+        comp["height"] = c.height[i];
+        comp["rotation"] = c.rotation[i];
+        comp["value"] = c.value[i];
+        j["components"].push_back(std::move(comp));
+    }
+
+    j["wires"] = nlohmann::json::array();
+    for (size_t i = 0; i < w.size(); ++i) {
+        nlohmann::json wire;
+        wire["type"] = "Wire";
+        wire["x1"] = w.x1[i];
+        wire["y1"] = w.y1[i];
+        wire["x2"] = w.x2[i];
+        wire["y2"] = w.y2[i];
+        j["wires"].push_back(std::move(wire));
+    }
+}
+
+}
+
+bool save_json_design(const std::string& filename, const DesignStore& design) {
+    try {
+        nlohmann::json j;
+        write_parts(j, design);
+
+        // Each placed definition is written once; instances refer to it by index.
+        if (design.instance_count() > 0) {
+            const std::vector<uint32_t> numbers = design.placed_definition_numbers();
+            j["subcircuits"] = nlohmann::json::array();
+            for (uint32_t d = 0; d < design.definition_count(); ++d) {
+                if (numbers[d] == DesignStore::NO_DEFINITION) continue;
+                nlohmann::json block;
+                block["name"] = design.definition(d).name();
+                write_parts(block, design.definition(d).contents());
+                j["subcircuits"].push_back(std::move(block));
+            }
+            const DesignStore::InstanceColumns& n = design.instances();
+            j["instances"] = nlohmann::json::array();
+            for (size_t i = 0; i < n.size(); ++i) {
+                nlohmann::json instance;
+                instance["subcircuit"] = numbers[n.definition[i]];
+                instance["x"] = n.x[i];
+                instance["y"] = n.y[i];
+                instance["rotation"] = n.rotation[i];
+                j["instances"].push_back(std::move(instance));
+            }
+        }
+
+        std::ofstream file(filename);
+        if (!file.is_open()) return false;
+        file << j.dump(4);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+bool save_json_design(const std::string& filename, const ComponentList& components, const WireList& wires) {
+    return save_json_design(filename, DesignStore(components, wires));
+}
+
+namespace {
+
+// Fills a store's columns directly from SAX events, so no JSON DOM is
+// ever materialized. Expects {"components": [{...}], "wires": [{...}]},
+// optionally with "subcircuits": [{"name": ..., "components": [...],
+// "wires": [...]}] and "instances": [{...}], and skips any other keys or
+// nested values it does not know. Instances are kept until finish(), since
+// they may come before the definitions they place.
+class DesignSaxHandler : public nlohmann::json_sax<nlohmann::json> {
+public:
+    explicit DesignSaxHandler(DesignStore& design)
+        : design(design) {}
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t v) override { return number(static_cast<double>(v)); }
+    bool number_unsigned(number_unsigned_t v) override { return number(static_cast<double>(v)); }
+    bool number_float(number_float_t v, const string_t&) override { return number(v); }
+    bool binary(binary_t&) override { return true; }
+
+    bool string(string_t& val) override {
+        if (in_record() && field == Field::Type) {
+            record.type = val;
+            record.seen |= bit(Field::Type);
+        } else if (in_block() && field == Field::Name) {
+            block_name = val;
+        }
+        return true;
+    }
+
+    bool start_object(std::size_t) override {
+        ++depth;
+        if (in_block()) {
+            block = DesignStore{};
+            block_name.clear();
+            field = Field::Other;
+        } else if (in_record()) {
+            record = Record{};
+            field = Field::Other;
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        switch (records()) {
+        case Section::Components: finish_component(); break;
+        case Section::Wires: finish_wire(); break;
+        case Section::Instances: finish_instance(); break;
+        default: break;
+        }
+        if (in_block()) finish_block();
+        --depth;
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        ++depth;
+        if (depth == SECTION_DEPTH) section = pending_section;
+        else if (depth == BLOCK_SECTION_DEPTH && section == Section::Subcircuits) block_section = pending_section;
+        return true;
+    }
+
+    bool end_array() override {
+        if (depth == SECTION_DEPTH) section = Section::None;
+        else if (depth == BLOCK_SECTION_DEPTH) block_section = Section::None;
+        --depth;
+        return true;
+    }
+
+    bool key(string_t& val) override {
+        if (depth == 1) {
+            pending_section = val == "components" ? Section::Components
+                            : val == "wires" ? Section::Wires
+                            : val == "subcircuits" ? Section::Subcircuits
+                            : val == "instances" ? Section::Instances
+                            : Section::None;
+        } else if (in_block()) {
+            pending_section = val == "components" ? Section::Components
+                            : val == "wires" ? Section::Wires
+                            : Section::None;
+            field = val == "name" ? Field::Name : Field::Other;
+        } else if (in_record()) {
+            field = field_from_key(val);
+        }
+        return true;
+    }
+
+    // Places the buffered instances once every definition is known.
+    void finish() {
+        for (const DesignStore::InstanceRow& row : instances) {
+            if (row.definition >= design.definition_count())
+                throw std::runtime_error("Instance of an unknown subcircuit");
+            design.add_instance(row.definition, row.x, row.y, row.rotation);
+        }
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+        return false;
+    }
+
+private:
+    enum class Section { None, Components, Wires, Subcircuits, Instances };
+    enum class Field { Type, X, Y, Width, Height, Rotation, Value, X1, Y1, X2, Y2, Subcircuit, Name, Other };
+
+    struct Record {
+        std::string type;
+        double values[static_cast<int>(Field::Other)] = {};
+        unsigned seen = 0;
+    };
+
+    static constexpr int SECTION_DEPTH = 2;
+    static constexpr int RECORD_DEPTH = 3;
+    // Records inside a definition: object, array, object below the section.
+    static constexpr int BLOCK_SECTION_DEPTH = 4;
+    static constexpr int BLOCK_RECORD_DEPTH = 5;
+
+    static unsigned bit(Field f) { return 1u << static_cast<int>(f); }
+
+    static Field field_from_key(const std::string& k) {
+        if (k == "type") return Field::Type;
+        if (k == "x") return Field::X;
+        if (k == "y") return Field::Y;
+        if (k == "width") return Field::Width;
+        if (k == "height") return Field::Height;
+        if (k == "rotation") return Field::Rotation;
+        if (k == "value") return Field::Value;
+        if (k == "x1") return Field::X1;
+        if (k == "y1") return Field::Y1;
+        if (k == "x2") return Field::X2;
+        if (k == "y2") return Field::Y2;
+        if (k == "subcircuit") return Field::Subcircuit;
+        return Field::Other;
+    }
+
+    // The section whose records are at the current depth.
+    Section records() const {
+        if (depth == RECORD_DEPTH) return section == Section::Subcircuits ? Section::None : section;
+        if (depth == BLOCK_RECORD_DEPTH && section == Section::Subcircuits) return block_section;
+        return Section::None;
+    }
+
+    bool in_record() const {
+        return records() != Section::None;
+    }
+
+    bool in_block() const {
+        return depth == RECORD_DEPTH && section == Section::Subcircuits;
+    }
+
+    // Where parts and wires being read go.
+    DesignStore& target() {
+        return depth == BLOCK_RECORD_DEPTH ? block : design;
+    }
+
+    bool number(double v) {
+        if (in_record() && field != Field::Other && field != Field::Type && field != Field::Name) {
+            record.values[static_cast<int>(field)] = v;
+            record.seen |= bit(field);
+        }
+        return true;
+    }
+
+    double require(Field f) const {
+        if (!(record.seen & bit(f)))
+            throw std::runtime_error("Missing field in design record");
+        return record.values[static_cast<int>(f)];
+    }
+
+    void finish_component() {
+        if (!(record.seen & bit(Field::Type)))
+            throw std::runtime_error("Missing field in design record");
+        ComponentKind kind = CircuitComponent::kind_from_name(record.type);
+        // Optional: older designs have no values and keep the kind's default.
+        double value = record.seen & bit(Field::Value) ? record.values[static_cast<int>(Field::Value)]
+                                                       : default_component_value(kind);
+        target().add_component(kind, require(Field::X), require(Field::Y), require(Field::Width),
+                               require(Field::Height), require(Field::Rotation), value);
+    }
+
+    void finish_wire() {
+        target().add_wire(require(Field::X1), require(Field::Y1), require(Field::X2), require(Field::Y2));
+    }
+
+    void finish_instance() {
+        const double id = require(Field::Subcircuit);
+        if (!(id >= 0 && id < UINT32_MAX) || id != std::floor(id))
+            throw std::runtime_error("Bad subcircuit index in design record");
+        instances.push_back(DesignStore::InstanceRow{static_cast<uint32_t>(id), require(Field::X),
+                                                     require(Field::Y), require(Field::Rotation)});
+    }
+
+    void finish_block() {
+        design.add_definition(std::make_shared<const SubcircuitDefinition>(std::move(block_name), std::move(block)));
+        block = DesignStore{};
+        block_name.clear();
+    }
+
+    DesignStore& design;
+    int depth = 0;
+    Section section = Section::None;
+    Section block_section = Section::None;
+    Section pending_section = Section::None;
+    Field field = Field::Other;
+    Record record;
+    DesignStore block;
+    std::string block_name;
+    std::vector<DesignStore::InstanceRow> instances;
+};
+
+}
+
+bool load_json_design(const std::string& filename, DesignStore& design) {
+    try {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) return false;
+
+        DesignStore loaded;
+        DesignSaxHandler handler(loaded);
+        if (!nlohmann::json::sax_parse(file, &handler)) return false;
+        handler.finish();
+
+        design = std::move(loaded);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+bool load_json_design(const std::string& filename, ComponentList& components, WireList& wires) {
+    DesignStore design;
+    if (!load_json_design(filename, design)) return false;
+    design.to_lists(components, wires);
+    return true;
+}
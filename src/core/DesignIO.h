@@ -0,0 +1,35 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "CircuitComponent.h"
+#include "DesignStore.h"
+#include "Wire.h"
+
+// Saves and loads designs, picking the format from the file extension:
+// ".acb" is the compact binary format, anything else is JSON. Both formats
+// read and write a DesignStore's columns directly; the list overloads
+// convert for callers working with component objects.
+bool save_design(const std::string& filename, const DesignStore& design);
+bool load_design(const std::string& filename, DesignStore& design);
+// As above; journal_replayed says whether the design includes a journal.
+bool load_design(const std::string& filename, DesignStore& design, bool& journal_replayed);
+bool save_design(const std::string& filename, const ComponentList& components, const WireList& wires);
+bool load_design(const std::string& filename, ComponentList& components, WireList& wires);
+
+// Writes to a temporary file next to filename and renames it into place, so
+// readers never see a partially written design.
+bool save_design_atomic(const std::string& filename, const DesignStore& design);
+bool save_design_atomic(const std::string& filename, const ComponentList& components, const WireList& wires);
+
+bool is_binary_design_file(const std::string& filename);
+
+bool save_json_design(const std::string& filename, const DesignStore& design);
+bool load_json_design(const std::string& filename, DesignStore& design);
+bool save_json_design(const std::string& filename, const ComponentList& components, const WireList& wires);
+bool load_json_design(const std::string& filename, ComponentList& components, WireList& wires);
@@ -0,0 +1,442 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "DesignRules.h"
+#include <algorithm>
+#include <cmath>
+#include "Netlist.h"
+#include "Subcircuit.h"
+
+namespace {
+
+constexpr double TOLERANCE = Netlist::CONNECT_TOLERANCE;
+constexpr double EPS = 1e-6;
+
+// Whether the netlist would join the two points.
+bool same_point(double ax, double ay, double bx, double by) {
+    return std::llround(ax / TOLERANCE) == std::llround(bx / TOLERANCE) &&
+           std::llround(ay / TOLERANCE) == std::llround(by / TOLERANCE);
+}
+
+using WireRow = DesignStore::WireRow;
+
+Rect segment_box(const WireRow& w) {
+    return Rect::from_points(w.x1, w.y1, w.x2, w.y2);
+}
+
+bool zero_length(const WireRow& w) {
+    return same_point(w.x1, w.y1, w.x2, w.y2);
+}
+
+// Whether either end of w is at (x, y).
+bool ends_at(const WireRow& w, double x, double y) {
+    return same_point(w.x1, w.y1, x, y) || same_point(w.x2, w.y2, x, y);
+}
+
+// Clips the segment to the box (Liang-Barsky). On a crossing of positive
+// length, sets (mx, my) to the middle of the part inside.
+bool segment_crosses(double x1, double y1, double x2, double y2, const Rect& box, double& mx, double& my) {
+    if (box.empty()) return false;
+    const double dx = x2 - x1, dy = y2 - y1;
+    double t0 = 0, t1 = 1;
+    const double p[4] = {-dx, dx, -dy, dy};
+    const double q[4] = {x1 - box.x0, box.x1 - x1, y1 - box.y0, box.y1 - y1};
+    for (int k = 0; k < 4; ++k) {
+        if (p[k] == 0) {
+            if (q[k] <= 0) return false;
+            continue;
+        }
+        const double t = q[k] / p[k];
+        if (p[k] < 0) t0 = std::max(t0, t);
+        else t1 = std::min(t1, t);
+    }
+    if ((t1 - t0) * std::hypot(dx, dy) <= EPS) return false;
+    const double t = (t0 + t1) / 2;
+    mx = x1 + dx * t;
+    my = y1 + dy * t;
+    return true;
+}
+
+// Whether wire b lies along wire a for more than the tolerance; if so, sets
+// (mx, my) to the middle of the shared stretch.
+bool segments_overlap(const WireRow& a, const WireRow& b, double& mx, double& my) {
+    const double dx = a.x2 - a.x1, dy = a.y2 - a.y1;
+    const double length = std::hypot(dx, dy);
+    const double ux = dx / length, uy = dy / length;
+    auto along = [&](double x, double y) { return (x - a.x1) * ux + (y - a.y1) * uy; };
+    auto off = [&](double x, double y) { return std::abs((x - a.x1) * uy - (y - a.y1) * ux); };
+    if (off(b.x1, b.y1) > TOLERANCE || off(b.x2, b.y2) > TOLERANCE) return false;
+    const double s1 = along(b.x1, b.y1), s2 = along(b.x2, b.y2);
+    const double lo = std::max(0.0, std::min(s1, s2));
+    const double hi = std::min(length, std::max(s1, s2));
+    if (hi - lo <= TOLERANCE) return false;
+    const double s = (lo + hi) / 2;
+    mx = a.x1 + ux * s;
+    my = a.y1 + uy * s;
+    return true;
+}
+
+// Which of a record's links threads the list of the part (or wire) in slot.
+int link_of(const DrcViolation& v, bool wire, uint32_t slot) {
+    if (wire) return v.rule == DrcViolation::DuplicateWire && v.other_wire.slot == slot ? 1 : 0;
+    return v.rule == DrcViolation::ComponentOverlap && v.component.slot == slot ? 0 : 1;
+}
+
+}
+
+const char* drc_rule_name(DrcViolation::Rule rule) {
+    switch (rule) {
+        case DrcViolation::ComponentOverlap: return "component-overlap";
+        case DrcViolation::ZeroLengthWire: return "zero-length-wire";
+        case DrcViolation::DanglingWire: return "dangling-wire";
+        case DrcViolation::WireThroughComponent: return "wire-through-component";
+        case DrcViolation::DuplicateWire: return "duplicate-wire";
+    }
+    return "unknown";
+}
+
+void DesignRuleChecker::clear() {
+    component_index.clear();
+    wire_index.clear();
+    instance_index.clear();
+    bodies.clear();
+    segments.clear();
+    records.clear();
+    free_records.clear();
+    component_heads.clear();
+    wire_heads.clear();
+    count = 0;
+}
+
+void DesignRuleChecker::check_all(const DesignStore& design) {
+    clear();
+    component_index.reserve(design.component_count());
+    wire_index.reserve(design.wire_count());
+    instance_index.reserve(design.instance_count());
+    records.reserve(design.component_count() + design.wire_count());
+    for (size_t i = 0; i < design.component_count(); ++i) {
+        const Rect body = design.geometry(i).body_bounds();
+        set_body(design.component_handle(i), body);
+        component_index.insert(design.component_handle(i), body.expanded(TOLERANCE));
+    }
+    for (size_t i = 0; i < design.wire_count(); ++i) {
+        const WireRow ends = design.wire_row(i);
+        set_segment(design.wire_handle(i), ends);
+        wire_index.insert(design.wire_handle(i), segment_box(ends).expanded(TOLERANCE));
+    }
+    for (size_t i = 0; i < design.instance_count(); ++i)
+        instance_index.insert(design.instance_handle(i), design.instance_bounds(i).expanded(TOLERANCE));
+
+    for (size_t i = 0; i < design.component_count(); ++i) mark(design.component_handle(i));
+    for (size_t i = 0; i < design.wire_count(); ++i) mark(design.wire_handle(i));
+    // Every wire is checked too, and finds its own crossings.
+    for (size_t i = 0; i < design.component_count(); ++i) check_component(design, i, false);
+    for (size_t i = 0; i < design.wire_count(); ++i) check_wire(design, i);
+
+    for (ComponentHandle h : affected_components) component_flags[h.slot] = 0;
+    for (WireHandle h : affected_wires) wire_flags[h.slot] = 0;
+    affected_components.clear();
+    affected_wires.clear();
+}
+
+void DesignRuleChecker::update(const DesignStore& design, const std::vector<ComponentHandle>& components,
+                               const std::vector<WireHandle>& wires, const std::vector<InstanceHandle>& instances) {
+    for (ComponentHandle h : components) mark(h);
+    for (WireHandle h : wires) mark(h);
+
+    // Pair rules are re-checked from the changed object's side, but whether
+    // a wire end dangles depends on what lies around it, so the wires near
+    // the old and new place of every change are re-checked too.
+    Rect old_bounds;
+    for (ComponentHandle h : components) {
+        if (component_index.get_bounds(h, old_bounds)) add_neighbours(old_bounds);
+        const size_t i = design.index_of(h);
+        if (i == DesignStore::NPOS) {
+            component_index.remove(h);
+            continue;
+        }
+        const Rect body = design.geometry(i).body_bounds();
+        set_body(h, body);
+        const Rect bounds = body.expanded(TOLERANCE);
+        add_neighbours(bounds);
+        if (component_index.contains(h)) component_index.update(h, bounds);
+        else component_index.insert(h, bounds);
+    }
+    for (WireHandle h : wires) {
+        if (wire_index.get_bounds(h, old_bounds)) add_neighbours(old_bounds);
+        const size_t i = design.index_of(h);
+        if (i == DesignStore::NPOS) {
+            wire_index.remove(h);
+            continue;
+        }
+        const WireRow ends = design.wire_row(i);
+        set_segment(h, ends);
+        const Rect bounds = segment_box(ends).expanded(TOLERANCE);
+        add_neighbours(bounds);
+        if (wire_index.contains(h)) wire_index.update(h, bounds);
+        else wire_index.insert(h, bounds);
+    }
+    for (InstanceHandle h : instances) {
+        if (instance_index.get_bounds(h, old_bounds)) add_neighbours(old_bounds);
+        const size_t i = design.index_of(h);
+        if (i == DesignStore::NPOS) {
+            instance_index.remove(h);
+            continue;
+        }
+        const Rect bounds = design.instance_bounds(i).expanded(TOLERANCE);
+        add_neighbours(bounds);
+        if (instance_index.contains(h)) instance_index.update(h, bounds);
+        else instance_index.insert(h, bounds);
+    }
+
+    for (ComponentHandle h : affected_components) forget(h);
+    for (WireHandle h : affected_wires) forget(h);
+    for (ComponentHandle h : affected_components) {
+        const size_t i = design.index_of(h);
+        if (i != DesignStore::NPOS) check_component(design, i, true);
+    }
+    for (WireHandle h : affected_wires) {
+        const size_t i = design.index_of(h);
+        if (i != DesignStore::NPOS) check_wire(design, i);
+    }
+
+    for (ComponentHandle h : affected_components) component_flags[h.slot] = 0;
+    for (WireHandle h : affected_wires) wire_flags[h.slot] = 0;
+    affected_components.clear();
+    affected_wires.clear();
+}
+
+void DesignRuleChecker::collect(std::vector<DrcViolation>& out) const {
+    out.clear();
+    out.reserve(count);
+    for (const Record& r : records)
+        if (r.live) out.push_back(r.violation);
+}
+
+bool DesignRuleChecker::is_affected(ComponentHandle h) const {
+    return h.slot < component_flags.size() && component_flags[h.slot];
+}
+
+bool DesignRuleChecker::is_affected(WireHandle h) const {
+    return h.slot < wire_flags.size() && wire_flags[h.slot];
+}
+
+void DesignRuleChecker::mark(ComponentHandle h) {
+    if (h.slot >= component_flags.size()) component_flags.resize(h.slot + 1, 0);
+    if (const uint32_t at = component_flags[h.slot]) {
+        ComponentHandle& marked = affected_components[at - 1];
+        if (h.generation > marked.generation) marked = h;
+        return;
+    }
+    affected_components.push_back(h);
+    component_flags[h.slot] = static_cast<uint32_t>(affected_components.size());
+}
+
+void DesignRuleChecker::mark(WireHandle h) {
+    if (h.slot >= wire_flags.size()) wire_flags.resize(h.slot + 1, 0);
+    if (const uint32_t at = wire_flags[h.slot]) {
+        WireHandle& marked = affected_wires[at - 1];
+        if (h.generation > marked.generation) marked = h;
+        return;
+    }
+    affected_wires.push_back(h);
+    wire_flags[h.slot] = static_cast<uint32_t>(affected_wires.size());
+}
+
+void DesignRuleChecker::add_neighbours(const Rect& r) {
+    wire_index.visit(r, [&](WireHandle h) { mark(h); });
+}
+
+void DesignRuleChecker::set_body(ComponentHandle h, const Rect& body) {
+    if (h.slot >= bodies.size()) bodies.resize(h.slot + 1);
+    bodies[h.slot] = body;
+}
+
+void DesignRuleChecker::set_segment(WireHandle h, const WireRow& ends) {
+    if (h.slot >= segments.size()) segments.resize(h.slot + 1);
+    segments[h.slot] = ends;
+}
+
+// Drops the violations involving h, unlinking each from the other object
+// it names.
+void DesignRuleChecker::forget(ComponentHandle h) {
+    if (h.slot >= component_heads.size()) return;
+    uint32_t r = component_heads[h.slot];
+    while (r != NONE) {
+        const DrcViolation& v = records[r].violation;
+        const uint32_t next = records[r].next[link_of(v, false, h.slot)];
+        if (v.rule == DrcViolation::ComponentOverlap)
+            unlink(component_heads, false, (v.component.slot == h.slot ? v.other_component : v.component).slot, r);
+        else
+            unlink(wire_heads, true, v.wire.slot, r);
+        release(r);
+        r = next;
+    }
+    component_heads[h.slot] = NONE;
+}
+
+void DesignRuleChecker::forget(WireHandle h) {
+    if (h.slot >= wire_heads.size()) return;
+    uint32_t r = wire_heads[h.slot];
+    while (r != NONE) {
+        const DrcViolation& v = records[r].violation;
+        const uint32_t next = records[r].next[link_of(v, true, h.slot)];
+        if (v.rule == DrcViolation::DuplicateWire)
+            unlink(wire_heads, true, (v.wire.slot == h.slot ? v.other_wire : v.wire).slot, r);
+        else if (v.rule == DrcViolation::WireThroughComponent)
+            unlink(component_heads, false, v.component.slot, r);
+        release(r);
+        r = next;
+    }
+    wire_heads[h.slot] = NONE;
+}
+
+// Links v into the list of every object it names.
+void DesignRuleChecker::add(const DrcViolation& v) {
+    uint32_t r;
+    if (!free_records.empty()) {
+        r = free_records.back();
+        free_records.pop_back();
+    } else {
+        r = static_cast<uint32_t>(records.size());
+        records.emplace_back();
+    }
+    records[r] = Record{v, {NONE, NONE}, true};
+    switch (v.rule) {
+        case DrcViolation::ComponentOverlap:
+            push(component_heads, v.component.slot, r, 0);
+            push(component_heads, v.other_component.slot, r, 1);
+            break;
+        case DrcViolation::WireThroughComponent:
+            push(wire_heads, v.wire.slot, r, 0);
+            push(component_heads, v.component.slot, r, 1);
+            break;
+        case DrcViolation::DuplicateWire:
+            push(wire_heads, v.wire.slot, r, 0);
+            push(wire_heads, v.other_wire.slot, r, 1);
+            break;
+        case DrcViolation::ZeroLengthWire:
+        case DrcViolation::DanglingWire:
+            push(wire_heads, v.wire.slot, r, 0);
+            break;
+    }
+    ++count;
+}
+
+void DesignRuleChecker::push(std::vector<uint32_t>& heads, uint32_t slot, uint32_t record, int link) {
+    if (slot >= heads.size()) heads.resize(slot + 1, NONE);
+    records[record].next[link] = heads[slot];
+    heads[slot] = record;
+}
+
+void DesignRuleChecker::unlink(std::vector<uint32_t>& heads, bool wires, uint32_t slot, uint32_t record) {
+    if (slot >= heads.size()) return;
+    uint32_t* at = &heads[slot];
+    while (*at != NONE && *at != record)
+        at = &records[*at].next[link_of(records[*at].violation, wires, slot)];
+    if (*at == record) *at = records[record].next[link_of(records[record].violation, wires, slot)];
+}
+
+void DesignRuleChecker::release(uint32_t record) {
+    records[record].live = false;
+    free_records.push_back(record);
+    --count;
+}
+
+// Overlaps with other parts, and, if `crossings`, wires through this one
+// that are not being re-checked themselves. Of two parts being re-checked,
+// the one in the lower slot checks the pair.
+void DesignRuleChecker::check_component(const DesignStore& design, size_t i, bool crossings) {
+    const ComponentHandle h = design.component_handle(i);
+    const Rect body = bodies[h.slot];
+    component_index.visit(body, [&](ComponentHandle other) {
+        if (other == h || (is_affected(other) && other.slot < h.slot)) return;
+        const Rect& b = bodies[other.slot];
+        const Rect overlap{std::max(body.x0, b.x0), std::max(body.y0, b.y0),
+                           std::min(body.x1, b.x1), std::min(body.y1, b.y1)};
+        if (overlap.width() <= EPS || overlap.height() <= EPS) return;
+        add(DrcViolation{DrcViolation::ComponentOverlap, h, other, {}, {},
+                         (overlap.x0 + overlap.x1) / 2, (overlap.y0 + overlap.y1) / 2});
+    });
+
+    if (!crossings) return;
+    const Rect inner{body.x0 + TOLERANCE, body.y0 + TOLERANCE, body.x1 - TOLERANCE, body.y1 - TOLERANCE};
+    wire_index.visit(inner, [&](WireHandle wire) {
+        if (is_affected(wire)) return;
+        const WireRow& w = segments[wire.slot];
+        double mx, my;
+        if (zero_length(w) || !segment_crosses(w.x1, w.y1, w.x2, w.y2, inner, mx, my)) return;
+        add(DrcViolation{DrcViolation::WireThroughComponent, h, {}, wire, {}, mx, my});
+    });
+}
+
+// One visit per index over the wire and the space around both its ends
+// serves every wire rule; each test still only counts the objects its own
+// query would have found.
+void DesignRuleChecker::check_wire(const DesignStore& design, size_t i) {
+    const WireHandle h = design.wire_handle(i);
+    const WireRow& w = segments[h.slot];
+    const double x1 = w.x1, y1 = w.y1, x2 = w.x2, y2 = w.y2;
+    if (zero_length(w)) {
+        add(DrcViolation{DrcViolation::ZeroLengthWire, {}, {}, h, {}, x1, y1});
+        return;
+    }
+    const Rect box = segment_box(w);
+    const Rect around1{x1 - TOLERANCE, y1 - TOLERANCE, x1 + TOLERANCE, y1 + TOLERANCE};
+    const Rect around2{x2 - TOLERANCE, y2 - TOLERANCE, x2 + TOLERANCE, y2 + TOLERANCE};
+    bool connected1 = false, connected2 = false;
+    Pin pins[ComponentGeometry::MAX_PINS];
+
+    component_index.visit(box.expanded(TOLERANCE), [&](ComponentHandle comp) {
+        const Rect& body = bodies[comp.slot];
+        const Rect bounds = body.expanded(TOLERANCE);
+        const bool near1 = !connected1 && bounds.intersects(around1);
+        const bool near2 = !connected2 && bounds.intersects(around2);
+        if (near1 || near2) {
+            const size_t count = design.geometry(design.index_of(comp)).pins(pins);
+            for (size_t k = 0; k < count; ++k) {
+                if (near1 && same_point(pins[k].x, pins[k].y, x1, y1)) connected1 = true;
+                if (near2 && same_point(pins[k].x, pins[k].y, x2, y2)) connected2 = true;
+            }
+        }
+        if (!bounds.intersects(box)) return;
+        const Rect inner{body.x0 + TOLERANCE, body.y0 + TOLERANCE, body.x1 - TOLERANCE, body.y1 - TOLERANCE};
+        double mx, my;
+        if (segment_crosses(x1, y1, x2, y2, inner, mx, my))
+            add(DrcViolation{DrcViolation::WireThroughComponent, comp, {}, h, {}, mx, my});
+    });
+
+    if (!connected1 || !connected2) {
+        instance_index.visit(box.expanded(TOLERANCE), [&](InstanceHandle instance) {
+            const size_t n = design.index_of(instance);
+            const Rect bounds = design.instance_bounds(n).expanded(TOLERANCE);
+            const bool near1 = !connected1 && bounds.intersects(around1);
+            const bool near2 = !connected2 && bounds.intersects(around2);
+            if (!near1 && !near2) return;
+            const Placement at = design.placement(n);
+            for (const Pin& pin : design.instance_definition(n).connection_points()) {
+                double px, py;
+                at.to_world(pin.x, pin.y, px, py);
+                if (near1 && same_point(px, py, x1, y1)) connected1 = true;
+                if (near2 && same_point(px, py, x2, y2)) connected2 = true;
+            }
+        });
+    }
+
+    wire_index.visit(box.expanded(TOLERANCE), [&](WireHandle other) {
+        if (other == h) return;
+        const WireRow& o = segments[other.slot];
+        const Rect bounds = segment_box(o).expanded(TOLERANCE);
+        if (!connected1 && bounds.intersects(around1) && ends_at(o, x1, y1)) connected1 = true;
+        if (!connected2 && bounds.intersects(around2) && ends_at(o, x2, y2)) connected2 = true;
+        if (!bounds.intersects(box) || (is_affected(other) && other.slot < h.slot)) return;
+        double mx, my;
+        if (zero_length(o) || !segments_overlap(w, o, mx, my)) return;
+        add(DrcViolation{DrcViolation::DuplicateWire, {}, {}, h, other, mx, my});
+    });
+
+    if (!connected1) add(DrcViolation{DrcViolation::DanglingWire, {}, {}, h, {}, x1, y1});
+    if (!connected2) add(DrcViolation{DrcViolation::DanglingWire, {}, {}, h, {}, x2, y2});
+}
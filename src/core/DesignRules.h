@@ -0,0 +1,107 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "DesignStore.h"
+#include "SpatialIndex.h"
+
+// One broken design rule. Which handles are set depends on the rule:
+//   ComponentOverlap       component, other_component
+//   ZeroLengthWire         wire
+//   DanglingWire           wire; (x, y) is the end touching nothing
+//   WireThroughComponent   wire, component
+//   DuplicateWire          wire, other_wire
+// (x, y) is where to show it.
+struct DrcViolation {
+    enum Rule : uint8_t { ComponentOverlap, ZeroLengthWire, DanglingWire, WireThroughComponent, DuplicateWire };
+
+    Rule rule;
+    ComponentHandle component, other_component;
+    WireHandle wire, other_wire;
+    double x, y;
+};
+
+const char* drc_rule_name(DrcViolation::Rule rule);
+
+// Design rule checks that keep their results between edits. check_all
+// checks everything; after that, update re-checks only the objects an
+// edit touched and their neighbours, and leaves the other results alone.
+//
+// Bodies are ComponentGeometry::body_bounds. Parts overlap when their
+// bodies share area, and a wire crosses a part when it passes through its
+// body rather than ending on its edge. Wire ends connect to pins and to
+// other wire ends within Netlist::CONNECT_TOLERANCE, as in the netlist.
+// Subcircuit instances only count as somewhere for wires to connect: the
+// parts inside a block are checked once, where the block is built, not at
+// every instance.
+class DesignRuleChecker {
+public:
+    void check_all(const DesignStore& design);
+
+    // Handles of the objects added, moved, rotated or removed since the
+    // last check. Removed ones may already be stale in the store.
+    void update(const DesignStore& design, const std::vector<ComponentHandle>& components,
+                const std::vector<WireHandle>& wires, const std::vector<InstanceHandle>& instances = {});
+
+    void clear();
+
+    size_t violation_count() const { return count; }
+    // Every violation once, in no particular order.
+    void collect(std::vector<DrcViolation>& out) const;
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // One violation, threaded through the list of each object it names:
+    // next[0] for the wire, or the first part of an overlap, and next[1]
+    // for the other object, if any.
+    struct Record {
+        DrcViolation violation;
+        uint32_t next[2];
+        bool live;
+    };
+
+    bool is_affected(ComponentHandle h) const;
+    bool is_affected(WireHandle h) const;
+    void mark(ComponentHandle h);
+    void mark(WireHandle h);
+    void add_neighbours(const Rect& r);
+    void set_body(ComponentHandle h, const Rect& body);
+    void set_segment(WireHandle h, const DesignStore::WireRow& ends);
+    void forget(ComponentHandle h);
+    void forget(WireHandle h);
+    void add(const DrcViolation& v);
+    void push(std::vector<uint32_t>& heads, uint32_t slot, uint32_t record, int link);
+    void unlink(std::vector<uint32_t>& heads, bool wires, uint32_t slot, uint32_t record);
+    void release(uint32_t record);
+    void check_component(const DesignStore& design, size_t i, bool crossings);
+    void check_wire(const DesignStore& design, size_t i);
+
+    SpatialIndex<ComponentHandle> component_index;
+    SpatialIndex<WireHandle> wire_index;
+    SpatialIndex<InstanceHandle> instance_index;
+    // Body of each indexed part and ends of each indexed wire, by handle
+    // slot, so a neighbour costs the checks one read rather than a rotation
+    // or a gather across the store's columns.
+    std::vector<Rect> bodies;
+    std::vector<DesignStore::WireRow> segments;
+    std::vector<Record> records;
+    std::vector<uint32_t> free_records;
+    // First record naming each object, indexed by handle slot.
+    std::vector<uint32_t> component_heads;
+    std::vector<uint32_t> wire_heads;
+    size_t count = 0;
+
+    // Objects being re-checked by the current update. The flags, by slot,
+    // hold one past each object's place in its list, so that when an edit
+    // frees a slot and reuses it, the newer handle replaces the stale one.
+    std::vector<ComponentHandle> affected_components;
+    std::vector<WireHandle> affected_wires;
+    std::vector<uint32_t> component_flags;
+    std::vector<uint32_t> wire_flags;
+};
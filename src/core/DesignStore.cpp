@@ -0,0 +1,450 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "DesignStore.h"
+#include <cmath>
+#include "Subcircuit.h"
+
+namespace {
+
+template <typename T>
+void erase_at(std::vector<T>& v, size_t index) {
+    v.erase(v.begin() + index);
+}
+
+template <typename T>
+void insert_at(std::vector<T>& v, size_t index, const T& value) {
+    v.insert(v.begin() + index, value);
+}
+
+// Drops the elements at the sorted positions, shifting the rest down once.
+template <typename T>
+void erase_sorted(std::vector<T>& v, const std::vector<size_t>& indices) {
+    size_t out = indices.front();
+    size_t next = 0;
+    for (size_t i = indices.front(); i < v.size(); ++i) {
+        if (next < indices.size() && indices[next] == i) {
+            ++next;
+            continue;
+        }
+        v[out++] = std::move(v[i]);
+    }
+    v.resize(out);
+}
+
+// Grows v by positions.size() and puts value_at(k) at positions[k]
+// (ascending final positions), moving everything else up in one pass.
+template <typename T, typename ValueAt>
+void insert_sorted(std::vector<T>& v, const std::vector<size_t>& positions, ValueAt value_at) {
+    size_t src = v.size();
+    size_t k = positions.size();
+    v.resize(v.size() + positions.size());
+    for (size_t dst = v.size(); k > 0 && dst-- > 0;) {
+        if (positions[k - 1] == dst) v[dst] = value_at(--k);
+        else v[dst] = std::move(v[--src]);
+    }
+}
+
+template <typename T>
+size_t capacity_bytes(const std::vector<T>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+template <typename T>
+size_t capacity_bytes(const SharedVector<T>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+}
+
+uint32_t DesignStore::SlotTable::acquire(size_t position) {
+    uint32_t slot;
+    if (!free_slots.empty()) {
+        slot = free_slots.back();
+        free_slots.edit().pop_back();
+    } else {
+        slot = static_cast<uint32_t>(positions.size());
+        positions.push_back(FREE);
+        generations.push_back(0);
+    }
+    positions.edit()[slot] = static_cast<uint32_t>(position);
+    return slot;
+}
+
+void DesignStore::SlotTable::release(uint32_t slot) {
+    positions.edit()[slot] = FREE;
+    ++generations.edit()[slot];
+    free_slots.push_back(slot);
+}
+
+// Every slot is freed rather than dropped, so the generations survive and
+// handles into the old design can't resolve into the next one.
+void DesignStore::SlotTable::clear() {
+    std::vector<uint32_t>& p = positions.edit();
+    std::vector<uint32_t>& g = generations.edit();
+    std::vector<uint32_t>& f = free_slots.edit();
+    f.clear();
+    for (uint32_t slot = static_cast<uint32_t>(p.size()); slot-- > 0;) {
+        if (p[slot] != FREE) ++g[slot];
+        p[slot] = FREE;
+        f.push_back(slot);
+    }
+}
+
+void DesignStore::SlotTable::set_positions(const SharedVector<uint32_t>& slots, size_t first) {
+    std::vector<uint32_t>& p = positions.edit();
+    for (size_t i = first; i < slots.size(); ++i)
+        p[slots[i]] = static_cast<uint32_t>(i);
+}
+
+void DesignStore::SlotTable::reserve(size_t n) {
+    positions.reserve(n);
+    generations.reserve(n);
+}
+
+size_t DesignStore::SlotTable::memory_usage() const {
+    return capacity_bytes(positions) + capacity_bytes(generations) + capacity_bytes(free_slots);
+}
+
+DesignStore::DesignStore(const ComponentList& components, const WireList& wires) {
+    reserve(components.size(), wires.size());
+    for (const auto& comp : components) {
+        add_component(comp->get_kind(), comp->x, comp->y, comp->width, comp->height, comp->get_rotation(),
+                      comp->value);
+    }
+    for (const auto& wire : wires)
+        add_wire(wire->get_x1(), wire->get_y1(), wire->get_x2(), wire->get_y2());
+}
+
+void DesignStore::to_lists(ComponentList& out_components, WireList& out_wires) const {
+    if (instance_count() > 0) {
+        flattened().to_lists(out_components, out_wires);
+        return;
+    }
+    const ComponentColumns& c = component_columns;
+    out_components.clear();
+    out_components.reserve(c.size());
+    for (size_t i = 0; i < c.size(); ++i) {
+        auto comp = CircuitComponent::create(c.kind[i], c.x[i], c.y[i], c.width[i], c.height[i]);
+        comp->set_rotation(c.rotation[i]);
+        comp->value = c.value[i];
+        out_components.push_back(std::move(comp));
+    }
+
+    const WireColumns& w = wire_columns;
+    out_wires.clear();
+    out_wires.reserve(w.size());
+    for (size_t i = 0; i < w.size(); ++i)
+        out_wires.push_back(std::make_shared<Wire>(w.x1[i], w.y1[i], w.x2[i], w.y2[i]));
+}
+
+void DesignStore::clear() {
+    component_columns = ComponentColumns{};
+    wire_columns = WireColumns{};
+    instance_columns = InstanceColumns{};
+    component_slots.clear();
+    wire_slots.clear();
+    instance_slots.clear();
+    definitions.clear();
+}
+
+void DesignStore::reserve(size_t components, size_t wires) {
+    ComponentColumns& c = component_columns;
+    c.kind.reserve(components);
+    for (auto* column : {&c.x, &c.y, &c.width, &c.height, &c.rotation, &c.value})
+        column->reserve(components);
+    for (auto* column : {&c.hit_x0, &c.hit_y0, &c.hit_x1, &c.hit_y1})
+        column->reserve(components);
+    c.slot.reserve(components);
+    component_slots.reserve(components);
+
+    WireColumns& w = wire_columns;
+    for (auto* column : {&w.x1, &w.y1, &w.x2, &w.y2})
+        column->reserve(wires);
+    w.slot.reserve(wires);
+    wire_slots.reserve(wires);
+}
+
+ComponentHandle DesignStore::add_component(ComponentKind kind, double x, double y, double width, double height,
+                                           double rotation, double value) {
+    ComponentColumns& c = component_columns;
+    uint32_t slot = component_slots.acquire(c.size());
+    c.kind.push_back(kind);
+    c.x.push_back(x);
+    c.y.push_back(y);
+    c.width.push_back(width);
+    c.height.push_back(height);
+    c.rotation.push_back(rotation);
+    c.value.push_back(value);
+    c.slot.push_back(slot);
+    for (auto* column : {&c.hit_x0, &c.hit_y0, &c.hit_x1, &c.hit_y1})
+        column->push_back(0);
+    update_hit_box(c.size() - 1);
+    return component_slots.handle<ComponentHandle>(slot);
+}
+
+// Keeps the stacking order, so everything above moves down one position.
+void DesignStore::remove_component(size_t index) {
+    ComponentColumns& c = component_columns;
+    component_slots.release(c.slot[index]);
+    erase_at(c.kind.edit(), index);
+    for (auto* column : {&c.x, &c.y, &c.width, &c.height, &c.rotation, &c.value})
+        erase_at(column->edit(), index);
+    for (auto* column : {&c.hit_x0, &c.hit_y0, &c.hit_x1, &c.hit_y1})
+        erase_at(column->edit(), index);
+    erase_at(c.slot.edit(), index);
+    component_slots.set_positions(c.slot, index);
+}
+
+void DesignStore::remove_components(const std::vector<size_t>& indices) {
+    if (indices.empty()) return;
+    ComponentColumns& c = component_columns;
+    for (size_t index : indices)
+        component_slots.release(c.slot[index]);
+    erase_sorted(c.kind.edit(), indices);
+    for (auto* column : {&c.x, &c.y, &c.width, &c.height, &c.rotation, &c.value})
+        erase_sorted(column->edit(), indices);
+    for (auto* column : {&c.hit_x0, &c.hit_y0, &c.hit_x1, &c.hit_y1})
+        erase_sorted(column->edit(), indices);
+    erase_sorted(c.slot.edit(), indices);
+    component_slots.set_positions(c.slot, indices.front());
+}
+
+void DesignStore::insert_components(const std::vector<size_t>& positions, const std::vector<ComponentRow>& rows) {
+    if (positions.empty()) return;
+    ComponentColumns& c = component_columns;
+    insert_sorted(c.kind.edit(), positions, [&](size_t k) { return rows[k].geometry.kind; });
+    insert_sorted(c.x.edit(), positions, [&](size_t k) { return rows[k].geometry.x; });
+    insert_sorted(c.y.edit(), positions, [&](size_t k) { return rows[k].geometry.y; });
+    insert_sorted(c.width.edit(), positions, [&](size_t k) { return rows[k].geometry.width; });
+    insert_sorted(c.height.edit(), positions, [&](size_t k) { return rows[k].geometry.height; });
+    insert_sorted(c.rotation.edit(), positions, [&](size_t k) { return rows[k].geometry.rotation; });
+    insert_sorted(c.value.edit(), positions, [&](size_t k) { return rows[k].value; });
+    insert_sorted(c.slot.edit(), positions, [&](size_t k) { return component_slots.acquire(positions[k]); });
+    for (auto* column : {&c.hit_x0, &c.hit_y0, &c.hit_x1, &c.hit_y1})
+        insert_sorted(column->edit(), positions, [](size_t) { return 0.0f; });
+    component_slots.set_positions(c.slot, positions.front());
+    for (size_t i : positions)
+        update_hit_box(i);
+}
+
+void DesignStore::move_component(size_t index, double x, double y) {
+    component_columns.x.edit()[index] = x;
+    component_columns.y.edit()[index] = y;
+    update_hit_box(index);
+}
+
+void DesignStore::set_rotation(size_t index, double rotation) {
+    component_columns.rotation.edit()[index] = rotation;
+    update_hit_box(index);
+}
+
+void DesignStore::set_value(size_t index, double value) {
+    component_columns.value.edit()[index] = value;
+}
+
+WireHandle DesignStore::add_wire(double x1, double y1, double x2, double y2) {
+    WireColumns& w = wire_columns;
+    uint32_t slot = wire_slots.acquire(w.size());
+    w.x1.push_back(x1);
+    w.y1.push_back(y1);
+    w.x2.push_back(x2);
+    w.y2.push_back(y2);
+    w.slot.push_back(slot);
+    return wire_slots.handle<WireHandle>(slot);
+}
+
+void DesignStore::remove_wire(size_t index) {
+    WireColumns& w = wire_columns;
+    wire_slots.release(w.slot[index]);
+    for (auto* column : {&w.x1, &w.y1, &w.x2, &w.y2})
+        erase_at(column->edit(), index);
+    erase_at(w.slot.edit(), index);
+    wire_slots.set_positions(w.slot, index);
+}
+
+void DesignStore::remove_wires(const std::vector<size_t>& indices) {
+    if (indices.empty()) return;
+    WireColumns& w = wire_columns;
+    for (size_t index : indices)
+        wire_slots.release(w.slot[index]);
+    for (auto* column : {&w.x1, &w.y1, &w.x2, &w.y2})
+        erase_sorted(column->edit(), indices);
+    erase_sorted(w.slot.edit(), indices);
+    wire_slots.set_positions(w.slot, indices.front());
+}
+
+void DesignStore::insert_wires(const std::vector<size_t>& positions, const std::vector<WireRow>& rows) {
+    if (positions.empty()) return;
+    WireColumns& w = wire_columns;
+    insert_sorted(w.x1.edit(), positions, [&](size_t k) { return rows[k].x1; });
+    insert_sorted(w.y1.edit(), positions, [&](size_t k) { return rows[k].y1; });
+    insert_sorted(w.x2.edit(), positions, [&](size_t k) { return rows[k].x2; });
+    insert_sorted(w.y2.edit(), positions, [&](size_t k) { return rows[k].y2; });
+    insert_sorted(w.slot.edit(), positions, [&](size_t k) { return wire_slots.acquire(positions[k]); });
+    wire_slots.set_positions(w.slot, positions.front());
+}
+
+void DesignStore::set_wire_end(size_t index, double x2, double y2) {
+    wire_columns.x2.edit()[index] = x2;
+    wire_columns.y2.edit()[index] = y2;
+}
+
+void DesignStore::move_wire(size_t index, double x1, double y1, double x2, double y2) {
+    wire_columns.x1.edit()[index] = x1;
+    wire_columns.y1.edit()[index] = y1;
+    set_wire_end(index, x2, y2);
+}
+
+uint32_t DesignStore::add_definition(std::shared_ptr<const SubcircuitDefinition> definition) {
+    definitions.push_back(std::move(definition));
+    return static_cast<uint32_t>(definitions.size() - 1);
+}
+
+std::vector<uint32_t> DesignStore::placed_definition_numbers() const {
+    std::vector<uint32_t> numbers(definitions.size(), NO_DEFINITION);
+    for (uint32_t d : instance_columns.definition) numbers[d] = 0;
+    uint32_t next = 0;
+    for (uint32_t& n : numbers) {
+        if (n != NO_DEFINITION) n = next++;
+    }
+    return numbers;
+}
+
+InstanceHandle DesignStore::add_instance(uint32_t definition, double x, double y, double rotation) {
+    return insert_instance(instance_count(), InstanceRow{definition, x, y, rotation});
+}
+
+void DesignStore::remove_instance(size_t index) {
+    InstanceColumns& n = instance_columns;
+    instance_slots.release(n.slot[index]);
+    erase_at(n.definition.edit(), index);
+    for (auto* column : {&n.x, &n.y, &n.rotation})
+        erase_at(column->edit(), index);
+    erase_at(n.slot.edit(), index);
+    instance_slots.set_positions(n.slot, index);
+}
+
+InstanceHandle DesignStore::insert_instance(size_t position, const InstanceRow& row) {
+    InstanceColumns& n = instance_columns;
+    const uint32_t slot = instance_slots.acquire(position);
+    insert_at(n.definition.edit(), position, row.definition);
+    insert_at(n.x.edit(), position, row.x);
+    insert_at(n.y.edit(), position, row.y);
+    insert_at(n.rotation.edit(), position, row.rotation);
+    insert_at(n.slot.edit(), position, slot);
+    instance_slots.set_positions(n.slot, position + 1);
+    return instance_slots.handle<InstanceHandle>(slot);
+}
+
+void DesignStore::move_instance(size_t index, double x, double y) {
+    instance_columns.x.edit()[index] = x;
+    instance_columns.y.edit()[index] = y;
+}
+
+void DesignStore::set_instance_rotation(size_t index, double rotation) {
+    instance_columns.rotation.edit()[index] = rotation;
+}
+
+void DesignStore::set_instance_definition(size_t index, uint32_t definition) {
+    instance_columns.definition.edit()[index] = definition;
+}
+
+Placement DesignStore::placement(size_t index) const {
+    const InstanceColumns& n = instance_columns;
+    return Placement{n.x[index], n.y[index], n.rotation[index]};
+}
+
+Rect DesignStore::instance_draw_bounds(size_t index) const {
+    return placement(index).to_world(instance_definition(index).draw_bounds());
+}
+
+Rect DesignStore::instance_bounds(size_t index) const {
+    return placement(index).to_world(instance_definition(index).bounds());
+}
+
+bool DesignStore::instance_contains_point(size_t index, double px, double py) const {
+    double lx, ly;
+    placement(index).to_local(px, py, lx, ly);
+    return instance_definition(index).contains_point(lx, ly);
+}
+
+void DesignStore::expand_instance(size_t index) {
+    const Placement at = placement(index);
+    // Held by pointer: the definition may belong to this store's last copy.
+    const std::shared_ptr<const SubcircuitDefinition> block = definitions[instance_columns.definition[index]];
+    const DesignStore& parts = block->contents();
+    for (size_t i = 0; i < parts.component_count(); ++i) {
+        const ComponentGeometry g = at.to_world(parts.geometry(i));
+        add_component(g.kind, g.x, g.y, g.width, g.height, g.rotation, parts.components().value[i]);
+    }
+    const WireColumns& w = parts.wires();
+    for (size_t i = 0; i < parts.wire_count(); ++i) {
+        double x1, y1, x2, y2;
+        at.to_world(w.x1[i], w.y1[i], x1, y1);
+        at.to_world(w.x2[i], w.y2[i], x2, y2);
+        add_wire(x1, y1, x2, y2);
+    }
+}
+
+DesignStore DesignStore::flattened() const {
+    DesignStore flat = *this;
+    for (size_t i = 0; i < instance_count(); ++i) flat.expand_instance(i);
+    flat.instance_columns = InstanceColumns{};
+    flat.instance_slots.clear();
+    flat.definitions.clear();
+    return flat;
+}
+
+size_t DesignStore::memory_usage() const {
+    const ComponentColumns& c = component_columns;
+    const WireColumns& w = wire_columns;
+    size_t bytes = capacity_bytes(c.kind) + capacity_bytes(c.slot);
+    for (const auto* column : {&c.x, &c.y, &c.width, &c.height, &c.rotation, &c.value})
+        bytes += capacity_bytes(*column);
+    for (const auto* column : {&c.hit_x0, &c.hit_y0, &c.hit_x1, &c.hit_y1})
+        bytes += capacity_bytes(*column);
+    for (const auto* column : {&w.x1, &w.y1, &w.x2, &w.y2})
+        bytes += capacity_bytes(*column);
+    bytes += capacity_bytes(w.slot);
+    const InstanceColumns& n = instance_columns;
+    for (const auto* column : {&n.x, &n.y, &n.rotation})
+        bytes += capacity_bytes(*column);
+    bytes += capacity_bytes(n.definition) + capacity_bytes(n.slot) + capacity_bytes(definitions);
+    for (const auto& definition : definitions)
+        bytes += definition->memory_usage();
+    return bytes + component_slots.memory_usage() + wire_slots.memory_usage() + instance_slots.memory_usage();
+}
+
+// Quarter turns get their box without trig, so it matches contains_point
+// exactly; anything else gets the enclosing box and is refined on a hit.
+Rect DesignStore::hit_box(size_t index) const {
+    const ComponentColumns& c = component_columns;
+    if (!is_axis_aligned(index)) return geometry(index).bounds();
+    const bool turned = static_cast<long long>(c.rotation[index] / 90.0) % 2 != 0;
+    const double hw = (turned ? c.height[index] : c.width[index]) / 2;
+    const double hh = (turned ? c.width[index] : c.height[index]) / 2;
+    const double cx = c.x[index] + c.width[index] / 2;
+    const double cy = c.y[index] + c.height[index] / 2;
+    return Rect{cx - hw, cy - hh, cx + hw, cy + hh};
+}
+
+// Rounded outward, so the float box always covers the exact one.
+void DesignStore::update_hit_box(size_t index) {
+    ComponentColumns& c = component_columns;
+    const Rect box = hit_box(index);
+    const auto down = [](double v) {
+        float f = static_cast<float>(v);
+        return f > v ? std::nextafter(f, -HUGE_VALF) : f;
+    };
+    const auto up = [](double v) {
+        float f = static_cast<float>(v);
+        return f < v ? std::nextafter(f, HUGE_VALF) : f;
+    };
+    c.hit_x0.edit()[index] = down(box.x0);
+    c.hit_y0.edit()[index] = down(box.y0);
+    c.hit_x1.edit()[index] = up(box.x1);
+    c.hit_y1.edit()[index] = up(box.y1);
+}
@@ -0,0 +1,259 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "CircuitComponent.h"
+#include "ComponentGeometry.h"
+#include "HitTest.h"
+#include "Wire.h"
+#include "../util/SharedVector.h"
+
+// Names one component or wire of a DesignStore for as long as it exists.
+// Stacking positions shift when something below is deleted; handles don't,
+// and a handle to a deleted object never matches a later one in its slot.
+template <typename Tag>
+struct StoreHandle {
+    static constexpr uint32_t NONE = UINT32_MAX;
+    uint32_t slot = NONE;
+    uint32_t generation = 0;
+
+    explicit operator bool() const { return slot != NONE; }
+    bool operator==(const StoreHandle&) const = default;
+};
+
+using ComponentHandle = StoreHandle<struct ComponentTag>;
+using WireHandle = StoreHandle<struct WireTag>;
+using InstanceHandle = StoreHandle<struct InstanceTag>;
+
+class SubcircuitDefinition;
+struct Placement;
+
+// The editor's design: components and wires as parallel arrays in stacking
+// order (bottom first), so a pass over one field only touches that field.
+// The arrays are shared between copies until one side changes them, so a
+// copy costs one reference count per array whatever the size of the design,
+// and the UI thread can hand a background save its own snapshot. The first
+// edit of an array a running save still holds copies that array.
+//
+// Instances place subcircuit definitions (see Subcircuit.h). They have
+// their own columns and stacking order, and are drawn above the parts
+// and wires. Definitions are numbered in the order they were added, are
+// shared rather than copied, and stay for the life of the store; files
+// keep only the ones still placed.
+class DesignStore {
+public:
+    struct ComponentColumns {
+        SharedVector<ComponentKind> kind;
+        SharedVector<double> x, y;
+        SharedVector<double> width, height;
+        SharedVector<double> rotation;
+        SharedVector<double> value;
+        SharedVector<uint32_t> slot;
+        // Derived from the fields above: hit_box() rounded outward to float,
+        // for the batched hit tests to narrow down before exact tests.
+        SharedVector<float> hit_x0, hit_y0, hit_x1, hit_y1;
+
+        size_t size() const { return kind.size(); }
+    };
+
+    struct WireColumns {
+        SharedVector<double> x1, y1, x2, y2;
+        SharedVector<uint32_t> slot;
+
+        size_t size() const { return x1.size(); }
+    };
+
+    struct InstanceColumns {
+        SharedVector<uint32_t> definition;
+        SharedVector<double> x, y;
+        SharedVector<double> rotation;
+        SharedVector<uint32_t> slot;
+
+        size_t size() const { return definition.size(); }
+    };
+
+    // One component or wire, for moving objects in and out of the columns.
+    struct ComponentRow {
+        ComponentGeometry geometry;
+        double value;
+    };
+    struct WireRow {
+        double x1, y1, x2, y2;
+    };
+    struct InstanceRow {
+        uint32_t definition;
+        double x, y;
+        double rotation;
+    };
+
+    static constexpr size_t NPOS = SIZE_MAX;
+    static constexpr uint32_t NO_DEFINITION = UINT32_MAX;
+
+    DesignStore() = default;
+    DesignStore(const ComponentList& components, const WireList& wires);
+
+    // Builds independent component and wire objects in the same order,
+    // followed by the parts and wires of each instance, expanded.
+    void to_lists(ComponentList& out_components, WireList& out_wires) const;
+
+    const ComponentColumns& components() const { return component_columns; }
+    const WireColumns& wires() const { return wire_columns; }
+    size_t component_count() const { return component_columns.size(); }
+    size_t wire_count() const { return wire_columns.size(); }
+    const InstanceColumns& instances() const { return instance_columns; }
+    size_t instance_count() const { return instance_columns.size(); }
+
+    // Drops everything; handles from before stay invalid.
+    void clear();
+    void reserve(size_t components, size_t wires);
+
+    ComponentHandle add_component(ComponentKind kind, double x, double y, double width, double height,
+                                  double rotation, double value);
+    void remove_component(size_t index);
+    // Removes every listed position (ascending, no repeats) in one pass.
+    void remove_components(const std::vector<size_t>& indices);
+    // Inserts rows[k] so it ends up at positions[k] (ascending, no repeats)
+    // in one pass; the rows get new handles.
+    void insert_components(const std::vector<size_t>& positions, const std::vector<ComponentRow>& rows);
+    ComponentRow component_row(size_t index) const { return ComponentRow{geometry(index), component_columns.value[index]}; }
+    void move_component(size_t index, double x, double y);
+    void set_rotation(size_t index, double rotation);
+    void set_value(size_t index, double value);
+    // Box around the hit area. Exact for quarter turns, which is worked out
+    // without trig; other rotations get the enclosing box.
+    Rect hit_box(size_t index) const;
+    bool is_axis_aligned(size_t index) const {
+        const double quarters = component_columns.rotation[index] / 90.0;
+        return quarters == std::floor(quarters);
+    }
+    ComponentGeometry geometry(size_t index) const {
+        const ComponentColumns& c = component_columns;
+        return ComponentGeometry{c.kind[index], c.x[index], c.y[index], c.width[index], c.height[index],
+                                 c.rotation[index]};
+    }
+
+    WireHandle add_wire(double x1, double y1, double x2, double y2);
+    void remove_wire(size_t index);
+    void remove_wires(const std::vector<size_t>& indices);
+    void insert_wires(const std::vector<size_t>& positions, const std::vector<WireRow>& rows);
+    WireRow wire_row(size_t index) const {
+        const WireColumns& w = wire_columns;
+        return WireRow{w.x1[index], w.y1[index], w.x2[index], w.y2[index]};
+    }
+    void set_wire_end(size_t index, double x2, double y2);
+    void move_wire(size_t index, double x1, double y1, double x2, double y2);
+    Rect wire_bounds(size_t index) const {
+        const WireColumns& w = wire_columns;
+        return Wire::segment_bounds(w.x1[index], w.y1[index], w.x2[index], w.y2[index]);
+    }
+    bool wire_contains_point(size_t index, double px, double py) const {
+        const WireColumns& w = wire_columns;
+        return Wire::segment_contains_point(w.x1[index], w.y1[index], w.x2[index], w.y2[index], px, py);
+    }
+
+    uint32_t add_definition(std::shared_ptr<const SubcircuitDefinition> definition);
+    const SubcircuitDefinition& definition(uint32_t id) const { return *definitions[id]; }
+    size_t definition_count() const { return definitions.size(); }
+    // The number of each definition among those some instance places, in
+    // order, or NO_DEFINITION if none does. Files hold only the placed ones,
+    // numbered this way, so blocks left behind by edits aren't saved.
+    std::vector<uint32_t> placed_definition_numbers() const;
+
+    InstanceHandle add_instance(uint32_t definition, double x, double y, double rotation);
+    void remove_instance(size_t index);
+    // Puts an instance back at a stacking position; it gets a new handle.
+    InstanceHandle insert_instance(size_t position, const InstanceRow& row);
+    InstanceRow instance_row(size_t index) const {
+        const InstanceColumns& n = instance_columns;
+        return InstanceRow{n.definition[index], n.x[index], n.y[index], n.rotation[index]};
+    }
+    void move_instance(size_t index, double x, double y);
+    void set_instance_rotation(size_t index, double rotation);
+    void set_instance_definition(size_t index, uint32_t definition);
+    Placement placement(size_t index) const;
+    const SubcircuitDefinition& instance_definition(size_t index) const {
+        return definition(instance_columns.definition[index]);
+    }
+    // World extents of what the instance draws, and of its hit areas.
+    Rect instance_draw_bounds(size_t index) const;
+    Rect instance_bounds(size_t index) const;
+    bool instance_contains_point(size_t index, double px, double py) const;
+
+    // Adds the instance's parts and wires on top of the stacks, placed as
+    // the instance places them. The instance itself stays.
+    void expand_instance(size_t index);
+    // A copy with every instance expanded and removed, for code that only
+    // knows parts and wires.
+    DesignStore flattened() const;
+
+    BoxArrays hit_boxes() const {
+        const ComponentColumns& c = component_columns;
+        return BoxArrays{c.hit_x0.data(), c.hit_y0.data(), c.hit_x1.data(), c.hit_y1.data()};
+    }
+    SegmentArrays segments() const {
+        const WireColumns& w = wire_columns;
+        return SegmentArrays{w.x1.data(), w.y1.data(), w.x2.data(), w.y2.data()};
+    }
+
+    ComponentHandle component_handle(size_t index) const {
+        return component_slots.handle<ComponentHandle>(component_columns.slot[index]);
+    }
+    WireHandle wire_handle(size_t index) const {
+        return wire_slots.handle<WireHandle>(wire_columns.slot[index]);
+    }
+    InstanceHandle instance_handle(size_t index) const {
+        return instance_slots.handle<InstanceHandle>(instance_columns.slot[index]);
+    }
+
+    // Stacking position of a live handle, or NPOS for a stale or empty one.
+    size_t index_of(ComponentHandle h) const { return component_slots.position(h.slot, h.generation); }
+    size_t index_of(WireHandle h) const { return wire_slots.position(h.slot, h.generation); }
+    size_t index_of(InstanceHandle h) const { return instance_slots.position(h.slot, h.generation); }
+
+    // Bytes reserved by the columns and slot tables, and by the definitions.
+    size_t memory_usage() const;
+
+private:
+    // Maps handle slots to stacking positions. Freed slots are reused with
+    // a bumped generation so old handles to them stop resolving.
+    class SlotTable {
+    public:
+        uint32_t acquire(size_t position);
+        void release(uint32_t slot);
+        void clear();
+        void reserve(size_t n);
+
+        // Points the slots of stacking positions first and up at those positions.
+        void set_positions(const SharedVector<uint32_t>& slots, size_t first);
+        size_t position(uint32_t slot, uint32_t generation) const {
+            if (slot >= positions.size() || generations[slot] != generation || positions[slot] == FREE)
+                return NPOS;
+            return positions[slot];
+        }
+        template <typename H>
+        H handle(uint32_t slot) const { return H{slot, generations[slot]}; }
+        size_t memory_usage() const;
+
+    private:
+        static constexpr uint32_t FREE = UINT32_MAX;
+        SharedVector<uint32_t> positions;
+        SharedVector<uint32_t> generations;
+        SharedVector<uint32_t> free_slots;
+    };
+
+    void update_hit_box(size_t index);
+
+    ComponentColumns component_columns;
+    WireColumns wire_columns;
+    InstanceColumns instance_columns;
+    SlotTable component_slots;
+    SlotTable wire_slots;
+    SlotTable instance_slots;
+    std::vector<std::shared_ptr<const SubcircuitDefinition>> definitions;
+};
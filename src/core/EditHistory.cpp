@@ -0,0 +1,388 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "EditHistory.h"
+#include <algorithm>
+
+namespace {
+
+EditRecord make_record(EditRecord::Op op, size_t index) {
+    EditRecord r{};
+    r.op = op;
+    r.index = static_cast<uint32_t>(index);
+    return r;
+}
+
+bool is_component(uint8_t op) {
+    return op == EditRecord::AddComponent || op == EditRecord::RemoveComponent;
+}
+
+bool is_structural(uint8_t op) {
+    return op == EditRecord::AddComponent || op == EditRecord::RemoveComponent ||
+           op == EditRecord::AddWire || op == EditRecord::RemoveWire;
+}
+
+// Whether applying the record in this direction takes its object out of the
+// store (undoing an add, redoing a remove) rather than putting it back.
+bool removes(uint8_t op, bool forward) {
+    const bool add = op == EditRecord::AddComponent || op == EditRecord::AddWire;
+    return add != forward;
+}
+
+}
+
+void HistoryChanges::clear() {
+    changed_components.clear();
+    changed_wires.clear();
+    removed_components.clear();
+    removed_wires.clear();
+    changed_instances.clear();
+    removed_instances.clear();
+    reordered = false;
+}
+
+void EditHistory::set_memory_limit(size_t bytes) {
+    memory_limit = bytes;
+    if (depth == 0) trim();
+}
+
+void EditHistory::begin_group() {
+    ++depth;
+}
+
+void EditHistory::end_group() {
+    if (depth > 0 && --depth == 0) close_step();
+}
+
+void EditHistory::clear() {
+    records.clear();
+    steps.clear();
+    applied_steps = 0;
+    applied_records = 0;
+    open_records = 0;
+}
+
+void EditHistory::add(const EditRecord& record) {
+    // A new edit makes the undone steps unreachable.
+    if (applied_steps < steps.size()) {
+        records.resize(applied_records);
+        steps.resize(applied_steps);
+    }
+    records.push_back(record);
+    ++open_records;
+    if (depth == 0) close_step();
+}
+
+void EditHistory::close_step() {
+    if (open_records == 0) return;
+    steps.push_back(open_records);
+    applied_steps = steps.size();
+    applied_records = records.size();
+    open_records = 0;
+    trim();
+}
+
+// Drops whole steps from the oldest end. A single step over the limit
+// empties the history rather than leaving it half undoable.
+void EditHistory::trim() {
+    while (!steps.empty() && memory_usage() > memory_limit) {
+        const size_t n = steps.front();
+        records.erase(records.begin(), records.begin() + n);
+        steps.pop_front();
+        if (applied_steps > 0) {
+            --applied_steps;
+            applied_records -= n;
+        }
+    }
+}
+
+void EditHistory::record_add_component(size_t index) {
+    add(make_record(EditRecord::AddComponent, index));
+}
+
+void EditHistory::record_remove_component(const DesignStore& design, size_t index) {
+    EditRecord r = make_record(EditRecord::RemoveComponent, index);
+    const DesignStore::ComponentRow row = design.component_row(index);
+    r.kind = static_cast<uint8_t>(row.geometry.kind);
+    r.values[0] = row.geometry.x;
+    r.values[1] = row.geometry.y;
+    r.values[2] = row.geometry.width;
+    r.values[3] = row.geometry.height;
+    r.values[4] = row.geometry.rotation;
+    r.values[5] = row.value;
+    add(r);
+}
+
+void EditHistory::record_move_component(const DesignStore& design, size_t index) {
+    EditRecord r = make_record(EditRecord::MoveComponent, index);
+    r.values[0] = design.components().x[index];
+    r.values[1] = design.components().y[index];
+    add(r);
+}
+
+void EditHistory::record_rotate_component(const DesignStore& design, size_t index) {
+    EditRecord r = make_record(EditRecord::RotateComponent, index);
+    r.values[0] = design.components().rotation[index];
+    add(r);
+}
+
+void EditHistory::record_set_value(const DesignStore& design, size_t index) {
+    EditRecord r = make_record(EditRecord::SetValue, index);
+    r.values[0] = design.components().value[index];
+    add(r);
+}
+
+void EditHistory::record_add_wire(size_t index) {
+    add(make_record(EditRecord::AddWire, index));
+}
+
+void EditHistory::record_remove_wire(const DesignStore& design, size_t index) {
+    EditRecord r = make_record(EditRecord::RemoveWire, index);
+    const DesignStore::WireRow row = design.wire_row(index);
+    r.values[0] = row.x1;
+    r.values[1] = row.y1;
+    r.values[2] = row.x2;
+    r.values[3] = row.y2;
+    add(r);
+}
+
+void EditHistory::record_move_wire(const DesignStore& design, size_t index) {
+    EditRecord r = make_record(EditRecord::MoveWire, index);
+    const DesignStore::WireRow row = design.wire_row(index);
+    r.values[0] = row.x1;
+    r.values[1] = row.y1;
+    r.values[2] = row.x2;
+    r.values[3] = row.y2;
+    add(r);
+}
+
+void EditHistory::record_add_instance(size_t index) {
+    add(make_record(EditRecord::AddInstance, index));
+}
+
+void EditHistory::record_remove_instance(const DesignStore& design, size_t index) {
+    EditRecord r = make_record(EditRecord::RemoveInstance, index);
+    const DesignStore::InstanceRow row = design.instance_row(index);
+    r.values[0] = row.x;
+    r.values[1] = row.y;
+    r.values[2] = row.rotation;
+    r.values[3] = row.definition;
+    add(r);
+}
+
+void EditHistory::record_move_instance(const DesignStore& design, size_t index) {
+    EditRecord r = make_record(EditRecord::MoveInstance, index);
+    const DesignStore::InstanceRow row = design.instance_row(index);
+    r.values[0] = row.x;
+    r.values[1] = row.y;
+    r.values[2] = row.rotation;
+    add(r);
+}
+
+void EditHistory::record_set_instance_definition(const DesignStore& design, size_t index) {
+    EditRecord r = make_record(EditRecord::SetInstanceDefinition, index);
+    r.values[0] = design.instances().definition[index];
+    add(r);
+}
+
+bool EditHistory::undo(DesignStore& design, Journal& journal, HistoryChanges& changes) {
+    changes.clear();
+    if (!can_undo()) return false;
+    const size_t n = steps[applied_steps - 1];
+    apply(applied_records - n, applied_records, false, design, journal, changes);
+    --applied_steps;
+    applied_records -= n;
+    return true;
+}
+
+bool EditHistory::redo(DesignStore& design, Journal& journal, HistoryChanges& changes) {
+    changes.clear();
+    if (!can_redo()) return false;
+    const size_t n = steps[applied_steps];
+    apply(applied_records, applied_records + n, true, design, journal, changes);
+    ++applied_steps;
+    applied_records += n;
+    return true;
+}
+
+// Undo walks the step's records backwards, redo forwards. Each record
+// swaps its values with the store's, so it ends up holding the state the
+// next call in the other direction has to restore.
+void EditHistory::apply(size_t first, size_t last, bool forward, DesignStore& design, Journal& journal,
+                        HistoryChanges& changes) {
+    const size_t n = last - first;
+    for (size_t k = 0; k < n;) {
+        EditRecord& r = records[forward ? first + k : last - 1 - k];
+        if (is_structural(r.op)) {
+            k = apply_run(first, k, n, forward, design, journal, changes);
+            continue;
+        }
+        const size_t i = r.index;
+        const DesignStore::ComponentColumns& c = design.components();
+        switch (r.op) {
+            case EditRecord::MoveComponent: {
+                double x = c.x[i], y = c.y[i];
+                design.move_component(i, r.values[0], r.values[1]);
+                journal.record_move_component(i, r.values[0], r.values[1]);
+                r.values[0] = x;
+                r.values[1] = y;
+                changes.changed_components.push_back(design.component_handle(i));
+                break;
+            }
+            case EditRecord::RotateComponent: {
+                double rotation = c.rotation[i];
+                design.set_rotation(i, r.values[0]);
+                journal.record_rotate_component(i, r.values[0]);
+                r.values[0] = rotation;
+                changes.changed_components.push_back(design.component_handle(i));
+                break;
+            }
+            case EditRecord::SetValue: {
+                double value = c.value[i];
+                design.set_value(i, r.values[0]);
+                journal.record_set_value(i, r.values[0]);
+                r.values[0] = value;
+                break;
+            }
+            case EditRecord::MoveWire: {
+                DesignStore::WireRow row = design.wire_row(i);
+                design.move_wire(i, r.values[0], r.values[1], r.values[2], r.values[3]);
+                journal.record_move_wire(i, r.values[0], r.values[1], r.values[2], r.values[3]);
+                r.values[0] = row.x1;
+                r.values[1] = row.y1;
+                r.values[2] = row.x2;
+                r.values[3] = row.y2;
+                changes.changed_wires.push_back(design.wire_handle(i));
+                break;
+            }
+            // Instances are few, so their adds and removes go one at a time.
+            case EditRecord::AddInstance:
+            case EditRecord::RemoveInstance: {
+                if ((r.op == EditRecord::AddInstance) != forward) {
+                    const DesignStore::InstanceRow row = design.instance_row(i);
+                    r.values[0] = row.x;
+                    r.values[1] = row.y;
+                    r.values[2] = row.rotation;
+                    r.values[3] = row.definition;
+                    changes.removed_instances.push_back(design.instance_handle(i));
+                    design.remove_instance(i);
+                    journal.record_delete_instance(i);
+                } else {
+                    const DesignStore::InstanceRow row{static_cast<uint32_t>(r.values[3]), r.values[0], r.values[1],
+                                                       r.values[2]};
+                    // Anything not landing on top of the stack is out of insertion order.
+                    if (i < design.instance_count()) changes.reordered = true;
+                    changes.changed_instances.push_back(design.insert_instance(i, row));
+                    journal.record_insert_instance(i, row);
+                }
+                break;
+            }
+            case EditRecord::MoveInstance: {
+                const DesignStore::InstanceRow row = design.instance_row(i);
+                design.move_instance(i, r.values[0], r.values[1]);
+                design.set_instance_rotation(i, r.values[2]);
+                journal.record_move_instance(i, r.values[0], r.values[1], r.values[2]);
+                r.values[0] = row.x;
+                r.values[1] = row.y;
+                r.values[2] = row.rotation;
+                changes.changed_instances.push_back(design.instance_handle(i));
+                break;
+            }
+            case EditRecord::SetInstanceDefinition: {
+                const uint32_t definition = design.instances().definition[i];
+                design.set_instance_definition(i, static_cast<uint32_t>(r.values[0]));
+                journal.record_set_instance_definition(i, static_cast<uint32_t>(r.values[0]));
+                r.values[0] = definition;
+                changes.changed_instances.push_back(design.instance_handle(i));
+                break;
+            }
+        }
+        ++k;
+    }
+}
+
+// Applies the run of adds and removes of one kind of object that starts at
+// the k-th record to process, and returns where the run ends. Removals at
+// descending positions and insertions at ascending ones are each one pass
+// over the columns, however many records the run has.
+size_t EditHistory::apply_run(size_t first, size_t k, size_t n, bool forward, DesignStore& design,
+                              Journal& journal, HistoryChanges& changes) {
+    auto at = [&](size_t p) -> EditRecord& { return records[forward ? first + p : first + n - 1 - p]; };
+
+    const bool components = is_component(at(k).op);
+    const bool removing = removes(at(k).op, forward);
+    const size_t count = components ? design.component_count() : design.wire_count();
+    size_t end = k;
+    run.clear();
+    for (; end < n; ++end) {
+        const EditRecord& r = at(end);
+        if (!is_structural(r.op) || is_component(r.op) != components || removes(r.op, forward) != removing)
+            break;
+        if (!run.empty() && (removing ? r.index >= run.back() : r.index <= run.back()))
+            break;
+        run.push_back(r.index);
+    }
+
+    if (removing) {
+        for (size_t p = k; p < end; ++p) {
+            EditRecord& r = at(p);
+            if (components) {
+                const DesignStore::ComponentRow row = design.component_row(r.index);
+                r.kind = static_cast<uint8_t>(row.geometry.kind);
+                r.values[0] = row.geometry.x;
+                r.values[1] = row.geometry.y;
+                r.values[2] = row.geometry.width;
+                r.values[3] = row.geometry.height;
+                r.values[4] = row.geometry.rotation;
+                r.values[5] = row.value;
+                changes.removed_components.push_back(design.component_handle(r.index));
+                journal.record_delete_component(r.index);
+            } else {
+                const DesignStore::WireRow row = design.wire_row(r.index);
+                r.values[0] = row.x1;
+                r.values[1] = row.y1;
+                r.values[2] = row.x2;
+                r.values[3] = row.y2;
+                changes.removed_wires.push_back(design.wire_handle(r.index));
+                journal.record_delete_wire(r.index);
+            }
+        }
+        std::reverse(run.begin(), run.end());
+        if (components) design.remove_components(run);
+        else design.remove_wires(run);
+        return end;
+    }
+
+    if (components) {
+        std::vector<DesignStore::ComponentRow> rows;
+        rows.reserve(end - k);
+        for (size_t p = k; p < end; ++p) {
+            const EditRecord& r = at(p);
+            rows.push_back({ComponentGeometry{static_cast<ComponentKind>(r.kind), r.values[0], r.values[1],
+                                              r.values[2], r.values[3], r.values[4]},
+                            r.values[5]});
+        }
+        design.insert_components(run, rows);
+        for (size_t j = 0; j < run.size(); ++j) {
+            changes.changed_components.push_back(design.component_handle(run[j]));
+            journal.record_insert_component(run[j], rows[j].geometry, rows[j].value);
+        }
+    } else {
+        std::vector<DesignStore::WireRow> rows;
+        rows.reserve(end - k);
+        for (size_t p = k; p < end; ++p) {
+            const EditRecord& r = at(p);
+            rows.push_back({r.values[0], r.values[1], r.values[2], r.values[3]});
+        }
+        design.insert_wires(run, rows);
+        for (size_t j = 0; j < run.size(); ++j) {
+            changes.changed_wires.push_back(design.wire_handle(run[j]));
+            journal.record_insert_wire(run[j], rows[j].x1, rows[j].y1, rows[j].x2, rows[j].y2);
+        }
+    }
+    // Anything not landing on top of the stack is out of insertion order.
+    if (run.front() < count) changes.reordered = true;
+    return end;
+}
@@ -0,0 +1,123 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "DesignStore.h"
+#include "Journal.h"
+
+// One undoable change. A record holds the state its object is not in right
+// now: the old position of a move, or every field of a deleted object.
+// Undoing or redoing swaps that with the store, so each edit is stored once
+// and serves both directions.
+struct EditRecord {
+    enum Op : uint8_t {
+        AddComponent,      // index
+        RemoveComponent,   // index, kind, values = x, y, width, height, rotation, value
+        MoveComponent,     // index, values = x, y
+        RotateComponent,   // index, values = rotation
+        SetValue,          // index, values = value
+        AddWire,           // index
+        RemoveWire,        // index, values = x1, y1, x2, y2
+        MoveWire,          // index, values = x1, y1, x2, y2
+        AddInstance,       // index
+        RemoveInstance,    // index, values = x, y, rotation, definition
+        MoveInstance,      // index, values = x, y, rotation
+        SetInstanceDefinition  // index, values = definition
+    };
+
+    uint8_t op;
+    uint8_t kind;
+    uint8_t reserved[2];
+    uint32_t index;
+    double values[6];
+};
+
+static_assert(sizeof(EditRecord) == 56, "unexpected edit record padding");
+
+// What an undo or redo changed, so the caller can update its indexes.
+// Handles of removed objects are the ones they had before the step.
+struct HistoryChanges {
+    std::vector<ComponentHandle> changed_components;
+    std::vector<WireHandle> changed_wires;
+    std::vector<ComponentHandle> removed_components;
+    std::vector<WireHandle> removed_wires;
+    std::vector<InstanceHandle> changed_instances;
+    std::vector<InstanceHandle> removed_instances;
+    // Something was put back below existing objects, so an index that
+    // stacks by insertion order needs rebuilding.
+    bool reordered = false;
+
+    void clear();
+};
+
+// Undo and redo of DesignStore edits. Edits are recorded before they are
+// made, in O(1) each. Everything recorded between begin_group and the
+// matching end_group is one step; edits outside a group are a step each.
+// Once the records pass the memory limit the oldest steps are dropped.
+class EditHistory {
+public:
+    static constexpr size_t DEFAULT_MEMORY_LIMIT = 64 << 20;
+
+    explicit EditHistory(size_t memory_limit = DEFAULT_MEMORY_LIMIT) : memory_limit(memory_limit) {}
+
+    void set_memory_limit(size_t bytes);
+    size_t get_memory_limit() const { return memory_limit; }
+    size_t memory_usage() const { return records.size() * sizeof(EditRecord); }
+
+    void begin_group();
+    void end_group();
+
+    // `index` is the stacking position the edit applies to. Adds are
+    // recorded with the position the new object got; the rest with the
+    // store as it is just before the edit.
+    void record_add_component(size_t index);
+    void record_remove_component(const DesignStore& design, size_t index);
+    void record_move_component(const DesignStore& design, size_t index);
+    void record_rotate_component(const DesignStore& design, size_t index);
+    void record_set_value(const DesignStore& design, size_t index);
+    void record_add_wire(size_t index);
+    void record_remove_wire(const DesignStore& design, size_t index);
+    void record_move_wire(const DesignStore& design, size_t index);
+    void record_add_instance(size_t index);
+    void record_remove_instance(const DesignStore& design, size_t index);
+    void record_move_instance(const DesignStore& design, size_t index);
+    void record_set_instance_definition(const DesignStore& design, size_t index);
+
+    bool can_undo() const { return applied_steps > 0 && depth == 0; }
+    bool can_redo() const { return applied_steps < steps.size() && depth == 0; }
+
+    // Reverts or reapplies one step on the design, writes the changes it
+    // makes to the journal as ordinary edits, and reports them in changes.
+    bool undo(DesignStore& design, Journal& journal, HistoryChanges& changes);
+    bool redo(DesignStore& design, Journal& journal, HistoryChanges& changes);
+
+    void clear();
+
+private:
+    void add(const EditRecord& record);
+    void close_step();
+    void trim();
+    void apply(size_t first, size_t last, bool forward, DesignStore& design, Journal& journal,
+               HistoryChanges& changes);
+    size_t apply_run(size_t first, size_t k, size_t n, bool forward, DesignStore& design, Journal& journal,
+                     HistoryChanges& changes);
+
+    size_t memory_limit;
+    std::deque<EditRecord> records;
+    // Record count of each step, oldest first. The first applied_steps
+    // steps (applied_records records) are done; the rest can be redone.
+    std::deque<size_t> steps;
+    size_t applied_steps = 0;
+    size_t applied_records = 0;
+    // Open begin_group nesting, and records added to the open step so far.
+    int depth = 0;
+    size_t open_records = 0;
+    // Positions of the add/remove run being applied.
+    std::vector<size_t> run;
+};
@@ -0,0 +1,62 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../util/Rect.h"
+
+class DesignStore;
+
+// Axis-aligned boxes as parallel min/max arrays. They are floats, half the
+// memory of the exact boxes they cover, so a hit only means "maybe".
+struct BoxArrays {
+    const float* x0;
+    const float* y0;
+    const float* x1;
+    const float* y1;
+};
+
+// Line segments as parallel endpoint arrays.
+struct SegmentArrays {
+    const double* x1;
+    const double* y1;
+    const double* x2;
+    const double* y2;
+};
+
+// Batched tests of one point or rectangle against many objects. Each kernel
+// tests the objects at the n positions listed in `positions`, or at 0..n-1
+// when it is null, and sets hits[k] to 1 or 0 for the k-th one. They use
+// AVX2 or SSE2 when the build targets them and plain C++ otherwise; every
+// variant gives the same answers.
+void boxes_containing_point(const BoxArrays& boxes, const uint32_t* positions, size_t n,
+                            double px, double py, uint8_t* hits);
+void boxes_inside_rect(const BoxArrays& boxes, const uint32_t* positions, size_t n,
+                       const Rect& r, uint8_t* hits);
+// Segments passing within radius of (px, py).
+void segments_near_point(const SegmentArrays& segments, const uint32_t* positions, size_t n,
+                         double px, double py, double radius, uint8_t* hits);
+// Segments with both ends inside r.
+void segments_inside_rect(const SegmentArrays& segments, const uint32_t* positions, size_t n,
+                          const Rect& r, uint8_t* hits);
+
+// "avx2", "sse2" or "scalar".
+const char* hit_test_isa();
+
+// Topmost component or wire under (px, py) among candidate stacking
+// positions given in ascending order, or DesignStore::NPOS.
+size_t topmost_component_at(const DesignStore& design, const std::vector<uint32_t>& candidates,
+                            double px, double py);
+size_t topmost_wire_at(const DesignStore& design, const std::vector<uint32_t>& candidates,
+                       double px, double py);
+
+// Appends the stacking positions of everything lying entirely inside r, in
+// ascending order. Pass candidates to only test those, or null for all.
+void components_inside_rect(const DesignStore& design, const std::vector<uint32_t>* candidates,
+                            const Rect& r, std::vector<size_t>& out);
+void wires_inside_rect(const DesignStore& design, const std::vector<uint32_t>* candidates,
+                       const Rect& r, std::vector<size_t>& out);
@@ -0,0 +1,536 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "Journal.h"
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+#include <utility>
+#include "Subcircuit.h"
+
+namespace {
+
+constexpr uint64_t FNV_OFFSET = 1469598103934665603ULL;
+constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+void hash_bytes(uint64_t& h, const void* data, size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= FNV_PRIME;
+    }
+}
+
+void hash_double(uint64_t& h, double v) {
+    v += 0.0;  // -0.0 and 0.0 are the same position
+    hash_bytes(h, &v, sizeof(v));
+}
+
+// Folds the records into the commit chain.
+uint64_t chain_records(uint64_t h, const JournalRecord* records, size_t count) {
+    hash_bytes(h, records, count * sizeof(JournalRecord));
+    return h;
+}
+
+// Whether every commit holds the chain up to it. Journals before version 5
+// hold design checksums instead, checked after replay.
+bool chain_verifies(const JournalHeader& header, const std::vector<JournalRecord>& records) {
+    if (header.version < 5) return true;
+    uint64_t h = header.snapshot_checksum;
+    size_t start = 0;
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (records[i].op != JournalRecord::Commit) continue;
+        h = chain_records(h, records.data() + start, i - start);
+        if (records[i].index != h) return false;
+        start = i + 1;
+    }
+    return true;
+}
+
+JournalRecord make_record(JournalRecord::Op op, uint64_t index = 0) {
+    JournalRecord r{};
+    r.op = op;
+    r.index = index;
+    return r;
+}
+
+// Reads the header and every record up to and including the last commit.
+// Version 1 records had no value, so parts they add get the default one.
+bool read_committed(const std::string& path, JournalHeader& header, std::vector<JournalRecord>& records) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    bool ok = std::fread(&header, sizeof(header), 1, f) == 1 &&
+              std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) == 0 &&
+              (header.version == 1 ? header.record_size == JOURNAL_V1_RECORD_SIZE
+                                   : header.version >= 2 && header.version <= JOURNAL_VERSION &&
+                                         header.record_size == sizeof(JournalRecord));
+
+    records.clear();
+    size_t committed = 0;
+    JournalRecord r{};
+    while (ok && std::fread(&r, header.record_size, 1, f) == 1) {
+        if (header.version == 1) {
+            if (r.op > JournalRecord::Commit) {
+                ok = false;
+                break;
+            }
+            if (r.op == JournalRecord::AddComponent && r.kind <= static_cast<uint8_t>(ComponentKind::Transistor))
+                r.values[5] = default_component_value(static_cast<ComponentKind>(r.kind));
+        }
+        records.push_back(r);
+        if (r.op == JournalRecord::Commit) committed = records.size();
+    }
+    std::fclose(f);
+
+    records.resize(committed);
+    return ok;
+}
+
+bool apply(const JournalRecord& r, DesignStore& design) {
+    switch (r.op) {
+        case JournalRecord::AddComponent:
+            if (r.kind > static_cast<uint8_t>(ComponentKind::Transistor)) return false;
+            design.add_component(static_cast<ComponentKind>(r.kind), r.values[0], r.values[1], r.values[2],
+                                 r.values[3], r.values[4], r.values[5]);
+            return true;
+        case JournalRecord::MoveComponent:
+            if (r.index >= design.component_count()) return false;
+            design.move_component(r.index, r.values[0], r.values[1]);
+            return true;
+        case JournalRecord::RotateComponent:
+            if (r.index >= design.component_count()) return false;
+            design.set_rotation(r.index, r.values[0]);
+            return true;
+        case JournalRecord::DeleteComponent:
+            if (r.index >= design.component_count()) return false;
+            design.remove_component(r.index);
+            return true;
+        case JournalRecord::AddWire:
+            design.add_wire(r.values[0], r.values[1], r.values[2], r.values[3]);
+            return true;
+        case JournalRecord::DeleteWire:
+            if (r.index >= design.wire_count()) return false;
+            design.remove_wire(r.index);
+            return true;
+        case JournalRecord::MoveWire:
+            if (r.index >= design.wire_count()) return false;
+            design.move_wire(r.index, r.values[0], r.values[1], r.values[2], r.values[3]);
+            return true;
+        case JournalRecord::SetValue:
+            if (r.index >= design.component_count()) return false;
+            design.set_value(r.index, r.values[0]);
+            return true;
+        case JournalRecord::AddInstance:
+            if (r.index >= design.definition_count()) return false;
+            design.add_instance(static_cast<uint32_t>(r.index), r.values[0], r.values[1], r.values[2]);
+            return true;
+        case JournalRecord::MoveInstance:
+            if (r.index >= design.instance_count()) return false;
+            design.move_instance(r.index, r.values[0], r.values[1]);
+            design.set_instance_rotation(r.index, r.values[2]);
+            return true;
+        case JournalRecord::DeleteInstance:
+            if (r.index >= design.instance_count()) return false;
+            design.remove_instance(r.index);
+            return true;
+        case JournalRecord::InsertInstance:
+            if (r.index > design.instance_count() || !(r.values[3] >= 0 && r.values[3] < design.definition_count()))
+                return false;
+            design.insert_instance(r.index, DesignStore::InstanceRow{static_cast<uint32_t>(r.values[3]), r.values[0],
+                                                                     r.values[1], r.values[2]});
+            return true;
+        case JournalRecord::SetInstanceDefinition:
+            if (r.index >= design.instance_count() || !(r.values[0] >= 0 && r.values[0] < design.definition_count()))
+                return false;
+            design.set_instance_definition(r.index, static_cast<uint32_t>(r.values[0]));
+            return true;
+        case JournalRecord::Commit:
+            return true;
+        case JournalRecord::InsertComponent:
+        case JournalRecord::InsertWire:
+            break;  // applied in runs by apply_run
+    }
+    return false;
+}
+
+// Bulk deletes are recorded as deletes at descending positions, and undoing
+// them as inserts at ascending ones. A run of either is applied in one pass
+// instead of shifting the columns once per record. Advances i past the run.
+bool apply_run(const std::vector<JournalRecord>& records, size_t& i, DesignStore& design, std::vector<size_t>& run) {
+    const uint8_t op = records[i].op;
+    const bool components = op == JournalRecord::DeleteComponent || op == JournalRecord::InsertComponent;
+    const bool inserting = op == JournalRecord::InsertComponent || op == JournalRecord::InsertWire;
+    const size_t count = components ? design.component_count() : design.wire_count();
+    std::vector<DesignStore::ComponentRow> component_rows;
+    std::vector<DesignStore::WireRow> wire_rows;
+    run.clear();
+    for (; i < records.size() && records[i].op == op; ++i) {
+        const JournalRecord& r = records[i];
+        if (inserting) {
+            if (r.index > count + run.size() || (!run.empty() && r.index <= run.back())) break;
+        } else if (r.index >= count || (!run.empty() && r.index >= run.back())) {
+            break;
+        }
+        if (op == JournalRecord::InsertComponent) {
+            if (r.kind > static_cast<uint8_t>(ComponentKind::Transistor)) return false;
+            component_rows.push_back({ComponentGeometry{static_cast<ComponentKind>(r.kind), r.values[0], r.values[1],
+                                                        r.values[2], r.values[3], r.values[4]},
+                                      r.values[5]});
+        } else if (op == JournalRecord::InsertWire) {
+            wire_rows.push_back({r.values[0], r.values[1], r.values[2], r.values[3]});
+        }
+        run.push_back(r.index);
+    }
+    if (run.empty()) return false;
+
+    if (op == JournalRecord::InsertComponent) {
+        design.insert_components(run, component_rows);
+    } else if (op == JournalRecord::InsertWire) {
+        design.insert_wires(run, wire_rows);
+    } else {
+        std::reverse(run.begin(), run.end());
+        if (components) design.remove_components(run);
+        else design.remove_wires(run);
+    }
+    return true;
+}
+
+}
+
+std::string journal_path(const std::string& design_filename) {
+    return design_filename + ".journal";
+}
+
+namespace {
+
+// As the given journal version hashed the design: version 1 left out
+// component values, and before version 5 every definition counted, placed
+// or not, numbered as in the store.
+uint64_t checksum(const DesignStore& design, uint32_t version) {
+    const bool values = version >= 2;
+    const DesignStore::ComponentColumns& c = design.components();
+    const DesignStore::WireColumns& w = design.wires();
+    uint64_t h = FNV_OFFSET;
+    uint64_t counts[2] = {c.size(), w.size()};
+    hash_bytes(h, counts, sizeof(counts));
+    for (size_t i = 0; i < c.size(); ++i) {
+        uint8_t kind = static_cast<uint8_t>(c.kind[i]);
+        hash_bytes(h, &kind, sizeof(kind));
+        hash_double(h, c.x[i]);
+        hash_double(h, c.y[i]);
+        hash_double(h, c.width[i]);
+        hash_double(h, c.height[i]);
+        hash_double(h, c.rotation[i]);
+        if (values) hash_double(h, c.value[i]);
+    }
+    for (size_t i = 0; i < w.size(); ++i) {
+        hash_double(h, w.x1[i]);
+        hash_double(h, w.y1[i]);
+        hash_double(h, w.x2[i]);
+        hash_double(h, w.y2[i]);
+    }
+    // Left out of designs without subcircuits, so older journals still verify.
+    if (version >= 5 ? design.instance_count() > 0 : design.definition_count() > 0) {
+        std::vector<uint32_t> numbers = design.placed_definition_numbers();
+        if (version < 5) {
+            for (uint32_t d = 0; d < numbers.size(); ++d) numbers[d] = d;
+        }
+        for (uint32_t d = 0; d < design.definition_count(); ++d) {
+            if (numbers[d] == DesignStore::NO_DEFINITION) continue;
+            uint64_t block = checksum(design.definition(d).contents(), version);
+            hash_bytes(h, &block, sizeof(block));
+        }
+        const DesignStore::InstanceColumns& n = design.instances();
+        for (size_t i = 0; i < n.size(); ++i) {
+            hash_bytes(h, &numbers[n.definition[i]], sizeof(numbers[n.definition[i]]));
+            hash_double(h, n.x[i]);
+            hash_double(h, n.y[i]);
+            hash_double(h, n.rotation[i]);
+        }
+    }
+    return h;
+}
+
+}
+
+uint64_t design_checksum(const DesignStore& design) {
+    return checksum(design, JOURNAL_VERSION);
+}
+
+bool replay_journal(const std::string& design_filename, DesignStore& design) {
+    const std::string path = journal_path(design_filename);
+    if (access(path.c_str(), F_OK) != 0) return true;
+
+    JournalHeader header;
+    std::vector<JournalRecord> records;
+    if (!read_committed(path, header, records)) return false;
+    if (header.snapshot_components != design.component_count() || header.snapshot_wires != design.wire_count() ||
+        header.snapshot_checksum != checksum(design, header.version) || !chain_verifies(header, records))
+        return false;
+    if (records.empty()) return true;
+
+    std::vector<size_t> run;
+    for (size_t i = 0; i < records.size();) {
+        const JournalRecord& r = records[i];
+        if (r.op == JournalRecord::DeleteComponent || r.op == JournalRecord::DeleteWire ||
+            r.op == JournalRecord::InsertComponent || r.op == JournalRecord::InsertWire) {
+            if (!apply_run(records, i, design, run)) return false;
+            continue;
+        }
+        if (!apply(r, design)) return false;
+        ++i;
+    }
+
+    const JournalRecord& last = records.back();
+    return last.values[0] == design.component_count() && last.values[1] == design.wire_count() &&
+           (header.version >= 5 || last.index == checksum(design, header.version));
+}
+
+Journal::~Journal() {
+    detach();
+}
+
+void Journal::set_recording(bool on) {
+    recording = on;
+    if (!on) pending.clear();
+}
+
+void Journal::add(const JournalRecord& record) {
+    if (recording) pending.push_back(record);
+}
+
+void Journal::record_add_component(const ComponentGeometry& geometry, double value) {
+    record_component(JournalRecord::AddComponent, 0, geometry, value);
+}
+
+void Journal::record_insert_component(size_t index, const ComponentGeometry& geometry, double value) {
+    record_component(JournalRecord::InsertComponent, index, geometry, value);
+}
+
+void Journal::record_component(JournalRecord::Op op, size_t index, const ComponentGeometry& geometry, double value) {
+    JournalRecord r = make_record(op, index);
+    r.kind = static_cast<uint8_t>(geometry.kind);
+    r.values[0] = geometry.x;
+    r.values[1] = geometry.y;
+    r.values[2] = geometry.width;
+    r.values[3] = geometry.height;
+    r.values[4] = geometry.rotation;
+    r.values[5] = value;
+    add(r);
+}
+
+void Journal::record_move_component(size_t index, double x, double y) {
+    JournalRecord r = make_record(JournalRecord::MoveComponent, index);
+    r.values[0] = x;
+    r.values[1] = y;
+    add(r);
+}
+
+void Journal::record_rotate_component(size_t index, double rotation) {
+    JournalRecord r = make_record(JournalRecord::RotateComponent, index);
+    r.values[0] = rotation;
+    add(r);
+}
+
+void Journal::record_set_value(size_t index, double value) {
+    JournalRecord r = make_record(JournalRecord::SetValue, index);
+    r.values[0] = value;
+    add(r);
+}
+
+void Journal::record_delete_component(size_t index) {
+    add(make_record(JournalRecord::DeleteComponent, index));
+}
+
+void Journal::record_add_wire(double x1, double y1, double x2, double y2) {
+    record_wire(JournalRecord::AddWire, 0, x1, y1, x2, y2);
+}
+
+void Journal::record_insert_wire(size_t index, double x1, double y1, double x2, double y2) {
+    record_wire(JournalRecord::InsertWire, index, x1, y1, x2, y2);
+}
+
+void Journal::record_wire(JournalRecord::Op op, size_t index, double x1, double y1, double x2, double y2) {
+    JournalRecord r = make_record(op, index);
+    r.values[0] = x1;
+    r.values[1] = y1;
+    r.values[2] = x2;
+    r.values[3] = y2;
+    add(r);
+}
+
+void Journal::record_add_instance(const DesignStore::InstanceRow& row) {
+    JournalRecord r = make_record(JournalRecord::AddInstance, row.definition);
+    r.values[0] = row.x;
+    r.values[1] = row.y;
+    r.values[2] = row.rotation;
+    add(r);
+}
+
+void Journal::record_move_instance(size_t index, double x, double y, double rotation) {
+    JournalRecord r = make_record(JournalRecord::MoveInstance, index);
+    r.values[0] = x;
+    r.values[1] = y;
+    r.values[2] = rotation;
+    add(r);
+}
+
+void Journal::record_delete_instance(size_t index) {
+    add(make_record(JournalRecord::DeleteInstance, index));
+}
+
+void Journal::record_insert_instance(size_t index, const DesignStore::InstanceRow& row) {
+    JournalRecord r = make_record(JournalRecord::InsertInstance, index);
+    r.values[0] = row.x;
+    r.values[1] = row.y;
+    r.values[2] = row.rotation;
+    r.values[3] = row.definition;
+    add(r);
+}
+
+void Journal::record_set_instance_definition(size_t index, uint32_t definition) {
+    JournalRecord r = make_record(JournalRecord::SetInstanceDefinition, index);
+    r.values[0] = definition;
+    add(r);
+}
+
+void Journal::record_delete_wire(size_t index) {
+    add(make_record(JournalRecord::DeleteWire, index));
+}
+
+void Journal::record_move_wire(size_t index, double x1, double y1, double x2, double y2) {
+    JournalRecord r = make_record(JournalRecord::MoveWire, index);
+    r.values[0] = x1;
+    r.values[1] = y1;
+    r.values[2] = x2;
+    r.values[3] = y2;
+    add(r);
+}
+
+bool Journal::reset(const std::string& design_filename, uint64_t snapshot_checksum,
+                    size_t snapshot_components, size_t snapshot_wires, size_t included,
+                    std::vector<uint32_t> definition_numbers) {
+    detach();
+    pending.erase(pending.begin(), pending.begin() + std::min(included, pending.size()));
+
+    JournalHeader header{};
+    std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+    header.version = JOURNAL_VERSION;
+    header.record_size = sizeof(JournalRecord);
+    header.snapshot_checksum = snapshot_checksum;
+    header.snapshot_components = snapshot_components;
+    header.snapshot_wires = snapshot_wires;
+
+    // Write the new header beside the old journal and swap it in atomically.
+    const std::string path = journal_path(design_filename);
+    const std::string temp = path + ".tmp";
+    std::FILE* f = std::fopen(temp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1 && std::fflush(f) == 0 &&
+              fsync(fileno(f)) == 0;
+    std::fclose(f);
+    if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return false;
+    }
+
+    file = std::fopen(path.c_str(), "r+b");
+    if (!file) return false;
+    std::fseek(file, 0, SEEK_END);
+    attached_filename = design_filename;
+    written = 0;
+    chain = snapshot_checksum;
+    this->definition_numbers = std::move(definition_numbers);
+    return true;
+}
+
+bool Journal::attach(const std::string& design_filename, const DesignStore& design) {
+    detach();
+    pending.clear();
+
+    JournalHeader header;
+    std::vector<JournalRecord> records;
+    if (!read_committed(journal_path(design_filename), header, records)) return false;
+    // Older journals are only read; the next full save starts a current one.
+    if (header.version != JOURNAL_VERSION || !chain_verifies(header, records)) return false;
+
+    // The chain and the snapshot were checked when the journal was replayed,
+    // so only the counts are left to match.
+    size_t components = records.empty() ? header.snapshot_components : static_cast<size_t>(records.back().values[0]);
+    size_t wires = records.empty() ? header.snapshot_wires : static_cast<size_t>(records.back().values[1]);
+    if (components != design.component_count() || wires != design.wire_count()) return false;
+
+    file = std::fopen(journal_path(design_filename).c_str(), "r+b");
+    if (!file) return false;
+
+    // Drop any uncommitted tail so new batches follow the last commit directly.
+    long end = static_cast<long>(sizeof(JournalHeader) + records.size() * sizeof(JournalRecord));
+    if (ftruncate(fileno(file), end) != 0 || std::fseek(file, end, SEEK_SET) != 0) {
+        detach();
+        return false;
+    }
+    attached_filename = design_filename;
+    written = records.size();
+    chain = records.empty() ? header.snapshot_checksum : records.back().index;
+    // The loaded store numbers its definitions as the file does.
+    definition_numbers.resize(design.definition_count());
+    for (uint32_t d = 0; d < definition_numbers.size(); ++d) definition_numbers[d] = d;
+    return true;
+}
+
+// Turns the store's definition number in an instance record into the
+// snapshot's. False if the snapshot doesn't have that definition.
+bool Journal::renumber_definition(JournalRecord& record) const {
+    auto renumber = [&](auto& field) {
+        const uint64_t d = static_cast<uint64_t>(field);
+        if (d >= definition_numbers.size() || definition_numbers[d] == DesignStore::NO_DEFINITION) return false;
+        field = definition_numbers[d];
+        return true;
+    };
+    switch (record.op) {
+        case JournalRecord::AddInstance: return renumber(record.index);
+        case JournalRecord::InsertInstance: return renumber(record.values[3]);
+        case JournalRecord::SetInstanceDefinition: return renumber(record.values[0]);
+        default: return true;
+    }
+}
+
+bool Journal::commit(const DesignStore& design) {
+    if (!file) return false;
+
+    std::vector<JournalRecord> batch = pending;
+    for (JournalRecord& r : batch) {
+        if (!renumber_definition(r)) return false;
+    }
+    const uint64_t next = chain_records(chain, batch.data(), batch.size());
+    JournalRecord done = make_record(JournalRecord::Commit, next);
+    done.values[0] = static_cast<double>(design.component_count());
+    done.values[1] = static_cast<double>(design.wire_count());
+
+    long start = std::ftell(file);
+    bool ok = (batch.empty() ||
+               std::fwrite(batch.data(), sizeof(JournalRecord), batch.size(), file) == batch.size()) &&
+              std::fwrite(&done, sizeof(done), 1, file) == 1 &&
+              std::fflush(file) == 0 && fsync(fileno(file)) == 0;
+    if (!ok) {
+        // Cut the partial batch off so the next commit doesn't inherit it.
+        std::fflush(file);
+        if (ftruncate(fileno(file), start) != 0) detach();
+        else std::fseek(file, start, SEEK_SET);
+        return false;
+    }
+
+    written += pending.size() + 1;
+    pending.clear();
+    chain = next;
+    return true;
+}
+
+void Journal::detach() {
+    if (file) std::fclose(file);
+    file = nullptr;
+    attached_filename.clear();
+}
@@ -0,0 +1,157 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "DesignStore.h"
+
+// Append-only edit log stored next to a design as "<design>.journal".
+//
+// The header records the checksum of the snapshot the journal builds on.
+// Each save appends the edits made since the previous save followed by a
+// commit record holding a hash chained from the snapshot checksum through
+// every record before it. A save therefore costs only its own edits, and a
+// reader that has checked the snapshot and the chain knows replay gives
+// exactly what a full save would have written. The whole design is only
+// hashed when a full save starts a journal and when one is loaded. Edits
+// after the last commit (a save cut short) are discarded. Components and
+// wires are addressed by their index in stacking order, which replay
+// reproduces exactly.
+constexpr char JOURNAL_MAGIC[8] = {'A', 'C', 'A', 'D', 'J', 'R', 'N', '\0'};
+// Version 3 added MoveWire and the inserts, version 4 the instance edits,
+// version 5 the chained commits; before that a commit held the checksum of
+// the whole design. Older journals are still replayed, version 1 ones with
+// the shorter records and value-less checksums of that version. Subcircuit
+// definitions are only written by full saves, so instance records refer to
+// ones already in the snapshot, by their number there. Placing a definition
+// the snapshot left out takes a full save.
+constexpr uint32_t JOURNAL_VERSION = 5;
+constexpr uint32_t JOURNAL_V1_RECORD_SIZE = 56;
+
+struct JournalHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t snapshot_checksum;
+    uint64_t snapshot_components;
+    uint64_t snapshot_wires;
+};
+
+struct JournalRecord {
+    enum Op : uint8_t {
+        AddComponent,      // kind, values = x, y, width, height, rotation, value
+        MoveComponent,     // index, values = x, y
+        RotateComponent,   // index, values = rotation
+        DeleteComponent,   // index
+        AddWire,           // values = x1, y1, x2, y2
+        DeleteWire,        // index
+        Commit,            // index = chained hash, values = component count, wire count
+        SetValue,          // index, values = value
+        MoveWire,          // index, values = x1, y1, x2, y2
+        InsertComponent,   // index, kind, values as AddComponent
+        InsertWire,        // index, values as AddWire
+        AddInstance,       // index = definition, values = x, y, rotation
+        MoveInstance,      // index, values = x, y, rotation
+        DeleteInstance,    // index
+        InsertInstance,    // index, values = x, y, rotation, definition
+        SetInstanceDefinition  // index, values = definition
+    };
+
+    uint8_t op;
+    uint8_t kind;
+    uint8_t reserved[6];
+    uint64_t index;
+    double values[6];
+};
+
+static_assert(sizeof(JournalHeader) == 40, "unexpected journal header padding");
+static_assert(sizeof(JournalRecord) == 64, "unexpected journal record padding");
+
+std::string journal_path(const std::string& design_filename);
+
+// Order-sensitive hash over every component and wire field that is saved,
+// and over the placed subcircuits, numbered as saved, when there are any.
+uint64_t design_checksum(const DesignStore& design);
+
+// Applies the committed part of the design's journal, if it has one, to a
+// freshly loaded snapshot. Returns false if the journal does not belong to
+// this snapshot or the replayed design fails the commit checksum; the store
+// may then hold a partial replay and should be reloaded.
+bool replay_journal(const std::string& design_filename, DesignStore& design);
+
+class Journal {
+public:
+    Journal() = default;
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Edits are only kept while recording is on.
+    void set_recording(bool on);
+    bool is_recording() const { return recording; }
+
+    void record_add_component(const ComponentGeometry& geometry, double value);
+    void record_move_component(size_t index, double x, double y);
+    void record_rotate_component(size_t index, double rotation);
+    void record_set_value(size_t index, double value);
+    void record_delete_component(size_t index);
+    void record_add_wire(double x1, double y1, double x2, double y2);
+    void record_delete_wire(size_t index);
+    void record_move_wire(size_t index, double x1, double y1, double x2, double y2);
+    // Puts an object back at a stacking position, as undoing a delete does.
+    void record_insert_component(size_t index, const ComponentGeometry& geometry, double value);
+    void record_insert_wire(size_t index, double x1, double y1, double x2, double y2);
+    void record_add_instance(const DesignStore::InstanceRow& row);
+    void record_move_instance(size_t index, double x, double y, double rotation);
+    void record_delete_instance(size_t index);
+    void record_insert_instance(size_t index, const DesignStore::InstanceRow& row);
+    void record_set_instance_definition(size_t index, uint32_t definition);
+
+    size_t pending_count() const { return pending.size(); }
+    size_t written_count() const { return written; }
+    bool is_attached_to(const std::string& design_filename) const {
+        return file && attached_filename == design_filename;
+    }
+
+    // Starts an empty journal on top of a snapshot just written for
+    // design_filename. The first `included` pending edits are already part
+    // of that snapshot and are dropped. definition_numbers is what
+    // placed_definition_numbers() gave when the snapshot was taken.
+    bool reset(const std::string& design_filename, uint64_t snapshot_checksum,
+               size_t snapshot_components, size_t snapshot_wires, size_t included,
+               std::vector<uint32_t> definition_numbers);
+
+    // Continues the existing journal of a design just loaded, with that
+    // journal replayed, into the store, discarding edits recorded against
+    // the previous design. Fails if the journal is from an older version or
+    // doesn't end at that state, in which case the next save has to write a
+    // full snapshot.
+    bool attach(const std::string& design_filename, const DesignStore& design);
+
+    // Appends the pending edits and a commit record for the given state.
+    // Costs the pending edits, not the design. Fails without writing if an
+    // edit places a definition the snapshot doesn't have.
+    bool commit(const DesignStore& design);
+
+    void detach();
+
+private:
+    void add(const JournalRecord& record);
+    void record_component(JournalRecord::Op op, size_t index, const ComponentGeometry& geometry, double value);
+    void record_wire(JournalRecord::Op op, size_t index, double x1, double y1, double x2, double y2);
+    bool renumber_definition(JournalRecord& record) const;
+
+    bool recording = false;
+    std::vector<JournalRecord> pending;
+    size_t written = 0;
+    uint64_t chain = 0;  // hash up to the last commit
+    std::vector<uint32_t> definition_numbers;  // the store's definition -> the snapshot's
+    std::string attached_filename;
+    std::FILE* file = nullptr;
+};
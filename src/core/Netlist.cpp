@@ -0,0 +1,165 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "Netlist.h"
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include "../util/UnionFind.h"
+#include "../util/Units.h"
+
+namespace {
+
+// Grid cell of size CONNECT_TOLERANCE containing (x, y), packed into one key.
+uint64_t point_key(double x, double y) {
+    auto q = [](double v) {
+        return static_cast<uint32_t>(static_cast<int32_t>(std::llround(v / Netlist::CONNECT_TOLERANCE)));
+    };
+    return (static_cast<uint64_t>(q(x)) << 32) | q(y);
+}
+
+class PointNodes {
+public:
+    explicit PointNodes(size_t expected) { nodes.reserve(expected); }
+
+    uint32_t at(double x, double y) {
+        auto [it, inserted] = nodes.try_emplace(point_key(x, y), 0);
+        if (inserted) it->second = sets.add();
+        return it->second;
+    }
+
+    UnionFind sets;
+
+private:
+    std::unordered_map<uint64_t, uint32_t> nodes;
+};
+
+const char* spice_prefix(ComponentKind kind) {
+    switch (kind) {
+        case ComponentKind::Resistor: return "R";
+        case ComponentKind::Capacitor: return "C";
+        case ComponentKind::Coil: return "L";
+        case ComponentKind::Transistor: return "Q";
+    }
+    return "X";
+}
+
+}
+
+Netlist extract_netlist(const ComponentList& components, const WireList& wires) {
+    std::vector<size_t> pin_offsets;
+    std::vector<Pin> pins;
+    pin_offsets.reserve(components.size() + 1);
+    pins.reserve(components.size() * 2);
+
+    pin_offsets.push_back(0);
+    Pin buffer[CircuitComponent::MAX_PINS];
+    for (const auto& comp : components) {
+        size_t count = comp->get_pins(buffer);
+        pins.insert(pins.end(), buffer, buffer + count);
+        pin_offsets.push_back(pins.size());
+    }
+    return extract_netlist(std::move(pin_offsets), std::move(pins), wires);
+}
+
+Netlist extract_netlist(std::vector<size_t> pin_offsets, std::vector<Pin> pins, const WireList& wires) {
+    Netlist netlist;
+    netlist.pin_offsets = std::move(pin_offsets);
+    netlist.pins = std::move(pins);
+
+    PointNodes points(netlist.pins.size() + wires.size() * 2);
+    std::vector<uint32_t> pin_nodes;
+    pin_nodes.reserve(netlist.pins.size());
+    for (const Pin& pin : netlist.pins)
+        pin_nodes.push_back(points.at(pin.x, pin.y));
+
+    std::vector<uint32_t> wire_nodes;
+    wire_nodes.reserve(wires.size());
+    for (const auto& wire : wires) {
+        uint32_t a = points.at(wire->get_x1(), wire->get_y1());
+        uint32_t b = points.at(wire->get_x2(), wire->get_y2());
+        points.sets.unite(a, b);
+        wire_nodes.push_back(a);
+    }
+
+    // Number the sets densely in order of first appearance.
+    constexpr uint32_t UNASSIGNED = UINT32_MAX;
+    std::vector<uint32_t> net_of_root(points.sets.count(), UNASSIGNED);
+    auto net_of = [&](uint32_t node) {
+        uint32_t& net = net_of_root[points.sets.find(node)];
+        if (net == UNASSIGNED) net = static_cast<uint32_t>(netlist.net_count++);
+        return net;
+    };
+
+    netlist.pin_nets.reserve(pin_nodes.size());
+    for (uint32_t node : pin_nodes)
+        netlist.pin_nets.push_back(net_of(node));
+    netlist.wire_nets.reserve(wire_nodes.size());
+    for (uint32_t node : wire_nodes)
+        netlist.wire_nets.push_back(net_of(node));
+    return netlist;
+}
+
+std::vector<bool> find_dangling_pins(const Netlist& netlist) {
+    std::vector<uint32_t> use(netlist.net_count, 0);
+    for (uint32_t net : netlist.pin_nets) ++use[net];
+    for (uint32_t net : netlist.wire_nets) use[net] += 2;
+    std::vector<bool> dangling(netlist.pin_nets.size());
+    for (size_t p = 0; p < dangling.size(); ++p)
+        dangling[p] = use[netlist.pin_nets[p]] == 1;
+    return dangling;
+}
+
+std::vector<std::string> component_designators(const ComponentList& components) {
+    std::vector<std::string> names;
+    names.reserve(components.size());
+    size_t counts[4] = {0, 0, 0, 0};
+    for (const auto& comp : components) {
+        ComponentKind kind = comp->get_kind();
+        names.push_back(spice_prefix(kind) + std::to_string(++counts[static_cast<int>(kind)]));
+    }
+    return names;
+}
+
+void write_spice_netlist(std::ostream& out, const ComponentList& components, const Netlist& netlist,
+                         const std::string& title) {
+    out << "* " << title << "\n";
+
+    // Transistors share one NPN model per distinct forward gain.
+    std::map<double, size_t> models;
+    const std::vector<std::string> names = component_designators(components);
+    for (size_t i = 0; i < components.size(); ++i) {
+        const auto& comp = components[i];
+        ComponentKind kind = comp->get_kind();
+        out << names[i];
+        for (size_t p = netlist.pin_offsets[i]; p < netlist.pin_offsets[i + 1]; ++p)
+            out << ' ' << Netlist::net_name(netlist.pin_nets[p]);
+        if (kind == ComponentKind::Transistor) {
+            auto model = models.try_emplace(comp->value, models.size() + 1).first;
+            out << " NPN" << model->second << "\n";
+        } else {
+            out << ' ' << format_si_value(comp->value) << "\n";
+        }
+    }
+
+    for (const auto& [beta, id] : models)
+        out << ".model NPN" << id << " NPN(BF=" << beta << ")\n";
+    out << ".end\n";
+}
+
+bool export_spice_netlist(const std::string& filename, const ComponentList& components, const WireList& wires) {
+    try {
+        std::ofstream file(filename);
+        if (!file.is_open()) return false;
+        write_spice_netlist(file, components, extract_netlist(components, wires), filename);
+        return static_cast<bool>(file);
+    } catch (const std::exception& e) {
+        std::cerr << "Netlist export error: " << e.what() << std::endl;
+        return false;
+    }
+}
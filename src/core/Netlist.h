@@ -0,0 +1,49 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "DesignIO.h"
+
+// Electrical connectivity of a design. Wire endpoints and component pins that
+// land on the same point (within CONNECT_TOLERANCE) are joined, and each wire
+// joins its two endpoints. A wire endpoint touching the middle of another wire
+// is not a connection, the same as on the canvas.
+struct Netlist {
+    static constexpr double CONNECT_TOLERANCE = 0.5;
+
+    // The pins of components[i] are pins[pin_offsets[i] .. pin_offsets[i + 1]).
+    std::vector<size_t> pin_offsets;
+    std::vector<Pin> pins;
+    std::vector<uint32_t> pin_nets;
+    std::vector<uint32_t> wire_nets;
+    // Nets are numbered 0..net_count-1 in order of first appearance, pins first.
+    size_t net_count = 0;
+
+    static std::string net_name(uint32_t net) { return "N" + std::to_string(net + 1); }
+};
+
+Netlist extract_netlist(const ComponentList& components, const WireList& wires);
+
+// Same, from pins already gathered in the layout of Netlist::pins, for
+// callers that move a few components of an otherwise unchanged design.
+Netlist extract_netlist(std::vector<size_t> pin_offsets, std::vector<Pin> pins, const WireList& wires);
+
+// Marks the pins that share their net with no other pin and no wire.
+std::vector<bool> find_dangling_pins(const Netlist& netlist);
+
+// Reference designators in SPICE style (R1, R2, C1, Q1, ...), numbered per
+// kind in stacking order.
+std::vector<std::string> component_designators(const ComponentList& components);
+
+// One SPICE element line per component (R, C, L, and Q with an NPN model per
+// distinct gain), followed by ".end". Nets are named N1, N2, ...
+void write_spice_netlist(std::ostream& out, const ComponentList& components, const Netlist& netlist,
+                         const std::string& title);
+
+bool export_spice_netlist(const std::string& filename, const ComponentList& components, const WireList& wires);
@@ -0,0 +1,254 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "Router.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include "../util/ThreadPool.h"
+
+namespace {
+
+constexpr int DX[4] = {1, 0, -1, 0};
+constexpr int DY[4] = {0, 1, 0, -1};
+constexpr uint8_t NO_DIRECTION = 4;
+constexpr uint32_t UNREACHED = std::numeric_limits<uint32_t>::max();
+
+int floor_div(int a, int b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+// Adds a corner, merging it into the last segment when it continues it.
+void append_corner(RoutePath& path, double x, double y) {
+    if (!path.empty() && path.back().x == x && path.back().y == y) return;
+    const size_t n = path.size();
+    if (n >= 2) {
+        const RoutePoint& a = path[n - 2];
+        const RoutePoint& b = path[n - 1];
+        if ((a.x == b.x && b.x == x) || (a.y == b.y && b.y == y)) {
+            path.back() = RoutePoint{x, y};
+            return;
+        }
+    }
+    path.push_back(RoutePoint{x, y});
+}
+
+}
+
+// Scratch of one search, sized to its window and reused across searches.
+// A state is a node and the direction it was entered in; a state's cost is
+// only valid while its stamp matches the current search.
+//
+// Costs are small integers and the estimate never drops by more than a
+// step costs, so the open set is a ring of buckets by estimated total
+// (Dial's algorithm): pushes and pops are O(1). Each bucket is popped
+// newest first, which follows one promising path instead of widening
+// across every tie.
+struct Router::Search {
+    struct Open {
+        uint32_t g;
+        uint32_t state;
+    };
+
+    int x0 = 0, y0 = 0;
+    int width = 0, height = 0;
+    std::vector<uint8_t> blocked;
+    std::vector<uint32_t> cost;
+    std::vector<uint32_t> stamp;
+    std::vector<uint8_t> came_from;
+    std::vector<std::vector<Open>> ring;
+    size_t open_count = 0;
+    std::vector<uint32_t> nodes;
+    uint32_t generation = 0;
+
+    void begin(size_t node_count, size_t ring_size) {
+        blocked.assign(node_count, 0);
+        if (stamp.size() < node_count * 4) {
+            cost.resize(node_count * 4);
+            stamp.assign(node_count * 4, 0);
+            came_from.resize(node_count * 4);
+        }
+        if (++generation == 0) {
+            std::fill(stamp.begin(), stamp.end(), 0);
+            generation = 1;
+        }
+        ring.resize(ring_size);
+        for (auto& bucket : ring) bucket.clear();
+        open_count = 0;
+    }
+
+    void push(uint32_t f, uint32_t g, uint32_t state) {
+        ring[f % ring.size()].push_back({g, state});
+        ++open_count;
+    }
+};
+
+Router::Router(const DesignStore& design, const RouterOptions& options) : options(options) {
+    const double eps = 1e-6;
+    obstacles.reserve(design.component_count());
+    for (size_t i = 0; i < design.component_count(); ++i) {
+        const Rect b = design.geometry(i).bounds();
+        Obstacle o{static_cast<int>(std::ceil(b.x0 / GRID_SIZE - eps)),
+                   static_cast<int>(std::ceil(b.y0 / GRID_SIZE - eps)),
+                   static_cast<int>(std::floor(b.x1 / GRID_SIZE + eps)),
+                   static_cast<int>(std::floor(b.y1 / GRID_SIZE + eps))};
+        if (o.x0 > o.x1 || o.y0 > o.y1) continue;
+        const uint32_t id = static_cast<uint32_t>(obstacles.size());
+        obstacles.push_back(o);
+        for (int by = floor_div(o.y0, BUCKET); by <= floor_div(o.y1, BUCKET); ++by)
+            for (int bx = floor_div(o.x0, BUCKET); bx <= floor_div(o.x1, BUCKET); ++bx)
+                buckets[bucket_key(bx, by)].push_back(id);
+    }
+}
+
+Router::~Router() = default;
+
+// Marks the window's nodes that lie on a part.
+void Router::fill_window(Search& search) const {
+    const int wx1 = search.x0 + search.width - 1;
+    const int wy1 = search.y0 + search.height - 1;
+    for (int by = floor_div(search.y0, BUCKET); by <= floor_div(wy1, BUCKET); ++by) {
+        for (int bx = floor_div(search.x0, BUCKET); bx <= floor_div(wx1, BUCKET); ++bx) {
+            auto bucket = buckets.find(bucket_key(bx, by));
+            if (bucket == buckets.end()) continue;
+            for (uint32_t id : bucket->second) {
+                const Obstacle& o = obstacles[id];
+                const int x0 = std::max(o.x0, search.x0), x1 = std::min(o.x1, wx1);
+                const int y0 = std::max(o.y0, search.y0), y1 = std::min(o.y1, wy1);
+                for (int y = y0; y <= y1; ++y)
+                    for (int x = x0; x <= x1; ++x)
+                        search.blocked[(y - search.y0) * search.width + (x - search.x0)] = 1;
+            }
+        }
+    }
+}
+
+bool Router::route(const RouteRequest& request, RoutePath& out) const {
+    Search search;
+    return route(request, search, out);
+}
+
+bool Router::route(const RouteRequest& request, Search& search, RoutePath& out) const {
+    out.clear();
+    const int sx = static_cast<int>(std::lround(request.x1 / GRID_SIZE));
+    const int sy = static_cast<int>(std::lround(request.y1 / GRID_SIZE));
+    const int gx = static_cast<int>(std::lround(request.x2 / GRID_SIZE));
+    const int gy = static_cast<int>(std::lround(request.y2 / GRID_SIZE));
+
+    search.x0 = std::min(sx, gx) - options.margin;
+    search.y0 = std::min(sy, gy) - options.margin;
+    search.width = std::abs(sx - gx) + 2 * options.margin + 1;
+    search.height = std::abs(sy - gy) + 2 * options.margin + 1;
+    const size_t node_count = static_cast<size_t>(search.width) * search.height;
+    if (node_count > options.max_window_nodes) return false;
+    // A step costs at most 1 + bend + obstacle and moves the estimate by
+    // one, so no open state is further than that above the current bucket.
+    const uint32_t bend = options.bend_cost;
+    search.begin(node_count, 3 + bend + options.obstacle_cost);
+    fill_window(search);
+
+    const int w = search.width;
+    const uint32_t start = (sy - search.y0) * w + (sx - search.x0);
+    const uint32_t goal = (gy - search.y0) * w + (gx - search.x0);
+    const int goal_x = gx - search.x0, goal_y = gy - search.y0;
+    auto estimate = [&](int x, int y) -> uint32_t {
+        return std::abs(x - goal_x) + std::abs(y - goal_y);
+    };
+
+    // The start may be left in any direction without a bend.
+    uint32_t f = estimate(sx - search.x0, sy - search.y0);
+    for (uint8_t d = 0; d < 4; ++d) {
+        const uint32_t s = start * 4 + d;
+        search.cost[s] = 0;
+        search.stamp[s] = search.generation;
+        search.came_from[s] = NO_DIRECTION;
+        search.push(f, 0, s);
+    }
+
+    uint32_t reached = UNREACHED;
+    while (search.open_count > 0) {
+        std::vector<Search::Open>& bucket = search.ring[f % search.ring.size()];
+        if (bucket.empty()) {
+            ++f;
+            continue;
+        }
+        const Search::Open top = bucket.back();
+        bucket.pop_back();
+        --search.open_count;
+        if (top.g != search.cost[top.state]) continue;
+        const uint32_t node = top.state / 4;
+        if (node == goal) {
+            reached = top.state;
+            break;
+        }
+        const uint8_t dir = top.state % 4;
+        const int x = node % w, y = node / w;
+        for (uint8_t d = 0; d < 4; ++d) {
+            if (d == (dir + 2) % 4) continue;
+            const int nx = x + DX[d], ny = y + DY[d];
+            if (nx < 0 || ny < 0 || nx >= w || ny >= search.height) continue;
+            const uint32_t next = ny * w + nx;
+            uint32_t g = top.g + 1;
+            if (d != dir) g += bend;
+            if (search.blocked[next] && next != goal) g += options.obstacle_cost;
+            const uint32_t s = next * 4 + d;
+            if (search.stamp[s] == search.generation && search.cost[s] <= g) continue;
+            search.stamp[s] = search.generation;
+            search.cost[s] = g;
+            search.came_from[s] = dir;
+            search.push(g + estimate(nx, ny), g, s);
+        }
+    }
+    if (reached == UNREACHED) return false;
+
+    // Walk back from the goal; a state's predecessor is one step against
+    // the direction it was entered in.
+    search.nodes.clear();
+    for (uint32_t s = reached;;) {
+        const uint32_t node = s / 4;
+        search.nodes.push_back(node);
+        const uint8_t prev = search.came_from[s];
+        if (prev == NO_DIRECTION) break;
+        const uint8_t d = s % 4;
+        const uint32_t back = (node / w - DY[d]) * w + (node % w - DX[d]);
+        s = back * 4 + prev;
+    }
+
+    auto corner = [&](uint32_t node) {
+        append_corner(out, double(int(node % w) + search.x0) * GRID_SIZE,
+                      double(int(node / w) + search.y0) * GRID_SIZE);
+    };
+    out.push_back(RoutePoint{request.x1, request.y1});
+    append_corner(out, request.x1, double(sy) * GRID_SIZE);
+    for (auto it = search.nodes.rbegin(); it != search.nodes.rend(); ++it) corner(*it);
+    append_corner(out, double(gx) * GRID_SIZE, request.y2);
+    append_corner(out, request.x2, request.y2);
+    return true;
+}
+
+size_t Router::route_all(const std::vector<RouteRequest>& requests, std::vector<RoutePath>& out,
+                         ThreadPool& pool) const {
+    out.assign(requests.size(), RoutePath{});
+    // One scratch per worker, plus one for the calling thread.
+    std::vector<Search> searches(pool.size() + 1);
+    std::vector<uint8_t> routed(requests.size(), 0);
+    pool.parallel_for(requests.size(), 16, [&](size_t begin, size_t end) {
+        Search& search = searches[pool.current_worker()];
+        for (size_t k = begin; k < end; ++k)
+            routed[k] = route(requests[k], search, out[k]);
+    });
+    return static_cast<size_t>(std::count(routed.begin(), routed.end(), 1));
+}
+
+size_t add_route_wires(DesignStore& design, const RoutePath& path) {
+    size_t added = 0;
+    for (size_t k = 1; k < path.size(); ++k) {
+        if (path[k].x == path[k - 1].x && path[k].y == path[k - 1].y) continue;
+        design.add_wire(path[k - 1].x, path[k - 1].y, path[k].x, path[k].y);
+        ++added;
+    }
+    return added;
+}
@@ -0,0 +1,77 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "DesignStore.h"
+
+class ThreadPool;
+
+// Costs are in grid steps.
+struct RouterOptions {
+    uint32_t bend_cost = 2;
+    // Extra cost of each node crossed inside or on the edge of a part's box,
+    // pins included, so routes go around parts unless there is no other way.
+    uint32_t obstacle_cost = 40;
+    // How far beyond the box of its two ends a route may detour, in grid cells.
+    int margin = 16;
+    // Searches whose window would hold more nodes than this fail instead.
+    size_t max_window_nodes = size_t(1) << 22;
+};
+
+struct RouteRequest {
+    double x1, y1, x2, y2;
+};
+
+struct RoutePoint {
+    double x, y;
+};
+
+// Corners of an orthogonal route, both ends included; empty if it failed.
+using RoutePath = std::vector<RoutePoint>;
+
+// A* over the GRID_SIZE lattice with the design's parts as obstacles.
+// Ends off the lattice are joined to the nearest node by a short stub.
+// A Router reads the parts once when built and never changes, so one
+// instance can route from many threads.
+class Router {
+public:
+    explicit Router(const DesignStore& design, const RouterOptions& options = {});
+    ~Router();
+
+    bool route(const RouteRequest& request, RoutePath& out) const;
+
+    // Routes every request on the pool; out[k] is the route of requests[k].
+    // Routes don't see each other. Returns how many succeeded.
+    size_t route_all(const std::vector<RouteRequest>& requests, std::vector<RoutePath>& out,
+                     ThreadPool& pool) const;
+
+private:
+    struct Search;
+
+    // Nodes covered by a part's box, inclusive, in lattice coordinates.
+    struct Obstacle {
+        int x0, y0, x1, y1;
+    };
+
+    // Side of a bucket of obstacles, in lattice nodes.
+    static constexpr int BUCKET = 16;
+
+    bool route(const RouteRequest& request, Search& search, RoutePath& out) const;
+    void fill_window(Search& search) const;
+    static uint64_t bucket_key(int bx, int by) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(bx)) << 32) | static_cast<uint32_t>(by);
+    }
+
+    RouterOptions options;
+    std::vector<Obstacle> obstacles;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> buckets;
+};
+
+// Appends one wire per segment of the path. Returns how many were added.
+size_t add_route_wires(DesignStore& design, const RoutePath& path);
@@ -0,0 +1,292 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "../util/Constants.h"
+#include "../util/Rect.h"
+
+// Uniform grid of buckets over the drawn extents of canvas objects, named by
+// DesignStore handles. The extents given for an item have to enclose every
+// point its hit test accepts. Every item carries an insertion order so
+// queries can keep the canvas rule that the most recently added object is
+// the topmost one.
+template <typename Handle>
+class SpatialIndex {
+public:
+    explicit SpatialIndex(double cell_size = GRID_SIZE * 4)
+        : cell_size(cell_size) {}
+
+    void insert(Handle handle, const Rect& bounds) {
+        if (handle.slot >= items.size()) items.resize(handle.slot + 1);
+        Item& it = items[handle.slot];
+        it.generation = handle.generation;
+        it.order = next_order++;
+        it.bounds = bounds;
+        it.span = cell_range(bounds);
+        add_to_cells(handle, it);
+        ++count;
+    }
+
+    // Re-buckets an item after it moved or rotated, keeping its stacking order.
+    void update(Handle handle, const Rect& bounds) {
+        Item* it = find(handle);
+        if (!it) return;
+        const CellRange span = cell_range(bounds);
+        if (span != it->span) {
+            remove_from_cells(handle, *it);
+            it->bounds = bounds;
+            it->span = span;
+            add_to_cells(handle, *it);
+        } else {
+            it->bounds = bounds;
+        }
+    }
+
+    void remove(Handle handle) {
+        Item* it = find(handle);
+        if (!it) return;
+        remove_from_cells(handle, *it);
+        it->order = ABSENT;
+        --count;
+    }
+
+    // Makes room for about n items, for a bulk load.
+    void reserve(size_t n) {
+        items.reserve(n);
+        while (cells.size() < n * 2) grow();
+    }
+
+    void clear() {
+        cells.clear();
+        cell_count = 0;
+        items.clear();
+        next_order = 0;
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+    bool contains(Handle handle) const {
+        return handle.slot < items.size() && items[handle.slot].order != ABSENT &&
+               items[handle.slot].generation == handle.generation;
+    }
+    // Extents the item was last inserted or updated with.
+    bool get_bounds(Handle handle, Rect& out) const {
+        if (!contains(handle)) return false;
+        out = items[handle.slot].bounds;
+        return true;
+    }
+
+    // Topmost item whose extents contain (x, y) and that hit(handle)
+    // accepts, or an empty handle.
+    template <typename Hit>
+    Handle topmost_at(double x, double y, Hit&& hit) const {
+        const size_t cell = find_cell(key(cell_coord(x), cell_coord(y)));
+        if (cell == NO_CELL) return Handle{};
+        const std::vector<Entry>& entries = cells[cell].entries;
+        for (auto e = entries.rbegin(); e != entries.rend(); ++e) {
+            if (items[e->handle.slot].bounds.contains(x, y) && hit(e->handle))
+                return e->handle;
+        }
+        return Handle{};
+    }
+
+    // Every item bucketed in the cell holding (x, y), bottom to top, for a
+    // caller that tests them in a batch.
+    void candidates_at(double x, double y, std::vector<Handle>& out) const {
+        out.clear();
+        const size_t cell = find_cell(key(cell_coord(x), cell_coord(y)));
+        if (cell == NO_CELL) return;
+        for (const Entry& e : cells[cell].entries)
+            out.push_back(e.handle);
+    }
+
+    // Items whose drawn extents intersect r, bottom to top.
+    std::vector<Handle> query(const Rect& r) const {
+        std::vector<Entry> hits;
+        each_entry(r, [&](const Entry& e) { hits.push_back(e); });
+        std::sort(hits.begin(), hits.end(),
+                  [](const Entry& a, const Entry& b) { return a.order < b.order; });
+
+        std::vector<Handle> out;
+        out.reserve(hits.size());
+        for (const Entry& e : hits)
+            out.push_back(e.handle);
+        return out;
+    }
+
+    // Calls visit(handle) for each item whose extents intersect r, in no
+    // particular order and without allocating.
+    template <typename Visit>
+    void visit(const Rect& r, Visit&& visit) const {
+        each_entry(r, [&](const Entry& e) { visit(e.handle); });
+    }
+
+private:
+    static constexpr uint64_t ABSENT = UINT64_MAX;
+    static constexpr size_t NO_CELL = SIZE_MAX;
+
+    struct Entry {
+        Handle handle;
+        uint64_t order;
+    };
+
+    struct CellRange {
+        int x0, y0, x1, y1;
+        bool operator!=(const CellRange& o) const {
+            return x0 != o.x0 || y0 != o.y0 || x1 != o.x1 || y1 != o.y1;
+        }
+    };
+
+    // Indexed by handle slot; slots are dense, so this is a flat array.
+    struct Item {
+        uint64_t order = ABSENT;
+        uint32_t generation = 0;
+        Rect bounds;
+        CellRange span;
+    };
+
+    // A grid cell in the hash table; one with no entries is a free spot.
+    struct Cell {
+        uint64_t key;
+        std::vector<Entry> entries;
+    };
+
+    template <typename Visit>
+    void each_entry(const Rect& r, Visit&& visit) const {
+        CellRange range = cell_range(r);
+        const bool one_cell = range.x0 == range.x1 && range.y0 == range.y1;
+        for (int cy = range.y0; cy <= range.y1; ++cy) {
+            for (int cx = range.x0; cx <= range.x1; ++cx) {
+                const size_t cell = find_cell(key(cx, cy));
+                if (cell == NO_CELL) continue;
+                for (const Entry& e : cells[cell].entries) {
+                    const Item& it = items[e.handle.slot];
+                    // An item spanning several cells is reported from its first one only.
+                    if (!one_cell && (std::max(it.span.x0, range.x0) != cx ||
+                                      std::max(it.span.y0, range.y0) != cy))
+                        continue;
+                    if (it.bounds.intersects(r))
+                        visit(e);
+                }
+            }
+        }
+    }
+
+    Item* find(Handle handle) {
+        if (handle.slot >= items.size()) return nullptr;
+        Item& it = items[handle.slot];
+        if (it.order == ABSENT || it.generation != handle.generation) return nullptr;
+        return &it;
+    }
+
+    int cell_coord(double v) const {
+        return static_cast<int>(std::floor(v / cell_size));
+    }
+
+    CellRange cell_range(const Rect& r) const {
+        return CellRange{cell_coord(r.x0), cell_coord(r.y0),
+                         cell_coord(r.x1), cell_coord(r.y1)};
+    }
+
+    static uint64_t key(int cx, int cy) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) |
+               static_cast<uint32_t>(cy);
+    }
+
+    void add_to_cells(Handle handle, const Item& it) {
+        const CellRange& range = it.span;
+        for (int cy = range.y0; cy <= range.y1; ++cy) {
+            for (int cx = range.x0; cx <= range.x1; ++cx) {
+                // Buckets stay sorted by order so a reverse scan finds the topmost hit first.
+                std::vector<Entry>& entries = cell_for(key(cx, cy)).entries;
+                auto pos = std::upper_bound(entries.begin(), entries.end(), it.order,
+                    [](uint64_t order, const Entry& e) { return order < e.order; });
+                entries.insert(pos, Entry{handle, it.order});
+            }
+        }
+    }
+
+    void remove_from_cells(Handle handle, const Item& it) {
+        const CellRange& range = it.span;
+        for (int cy = range.y0; cy <= range.y1; ++cy) {
+            for (int cx = range.x0; cx <= range.x1; ++cx) {
+                const size_t cell = find_cell(key(cx, cy));
+                if (cell == NO_CELL) continue;
+                std::vector<Entry>& entries = cells[cell].entries;
+                entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                  [handle](const Entry& e) { return e.handle == handle; }),
+                              entries.end());
+                if (entries.empty()) free_cell(cell);
+            }
+        }
+    }
+
+    size_t home(uint64_t k) const {
+        return static_cast<size_t>((k * 0x9E3779B97F4A7C15ull) >> 32) & (cells.size() - 1);
+    }
+
+    // Position of the cell for k in the table, or NO_CELL.
+    size_t find_cell(uint64_t k) const {
+        if (cells.empty()) return NO_CELL;
+        for (size_t i = home(k);; i = (i + 1) & (cells.size() - 1)) {
+            if (cells[i].entries.empty()) return NO_CELL;
+            if (cells[i].key == k) return i;
+        }
+    }
+
+    // The cell for k, claiming a free slot if there is none yet. The caller
+    // has to give it an entry.
+    Cell& cell_for(uint64_t k) {
+        if ((cell_count + 1) * 2 > cells.size()) grow();
+        size_t i = home(k);
+        while (!cells[i].entries.empty() && cells[i].key != k)
+            i = (i + 1) & (cells.size() - 1);
+        if (cells[i].entries.empty()) {
+            cells[i].key = k;
+            ++cell_count;
+        }
+        return cells[i];
+    }
+
+    void grow() {
+        std::vector<Cell> old = std::move(cells);
+        cells = std::vector<Cell>(std::max<size_t>(64, old.size() * 2));
+        for (Cell& cell : old) {
+            if (cell.entries.empty()) continue;
+            size_t i = home(cell.key);
+            while (!cells[i].entries.empty()) i = (i + 1) & (cells.size() - 1);
+            cells[i] = std::move(cell);
+        }
+    }
+
+    // Empties slot i and shifts later cells of the same probe run back, so
+    // lookups never stop short at the hole.
+    void free_cell(size_t i) {
+        --cell_count;
+        const size_t mask = cells.size() - 1;
+        for (size_t j = (i + 1) & mask; !cells[j].entries.empty(); j = (j + 1) & mask) {
+            const size_t h = home(cells[j].key);
+            // Cell j may fill the hole unless its home lies cyclically in (i, j].
+            if (((j - h) & mask) >= ((j - i) & mask)) {
+                cells[i] = std::move(cells[j]);
+                cells[j].entries.clear();
+                i = j;
+            }
+        }
+    }
+
+    double cell_size;
+    uint64_t next_order = 0;
+    size_t count = 0;
+    // Open addressing with linear probing, a power of two in size and at
+    // most half full, so a lookup is one multiply and usually one probe.
+    std::vector<Cell> cells;
+    size_t cell_count = 0;
+    std::vector<Item> items;
+};
@@ -0,0 +1,38 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "Subcircuit.h"
+
+SubcircuitDefinition::SubcircuitDefinition(std::string name, DesignStore contents)
+    : block_name(std::move(name)), parts(std::move(contents)) {
+    Pin pins[ComponentGeometry::MAX_PINS];
+    for (size_t i = 0; i < parts.component_count(); ++i) {
+        const ComponentGeometry geometry = parts.geometry(i);
+        drawn = drawn.united(geometry.draw_bounds());
+        hit = hit.united(geometry.bounds());
+        const size_t count = geometry.pins(pins);
+        connections.insert(connections.end(), pins, pins + count);
+    }
+    const DesignStore::WireColumns& w = parts.wires();
+    for (size_t i = 0; i < parts.wire_count(); ++i) {
+        drawn = drawn.united(parts.wire_bounds(i));
+        hit = hit.united(parts.wire_bounds(i));
+        connections.push_back(Pin{"", w.x1[i], w.y1[i]});
+        connections.push_back(Pin{"", w.x2[i], w.y2[i]});
+    }
+}
+
+bool SubcircuitDefinition::contains_point(double lx, double ly) const {
+    if (!hit.contains(lx, ly)) return false;
+    for (size_t i = 0; i < parts.component_count(); ++i)
+        if (parts.geometry(i).contains_point(lx, ly)) return true;
+    for (size_t i = 0; i < parts.wire_count(); ++i)
+        if (parts.wire_contains_point(i, lx, ly)) return true;
+    return false;
+}
+
+size_t SubcircuitDefinition::memory_usage() const {
+    return sizeof(*this) + block_name.capacity() + parts.memory_usage() + connections.capacity() * sizeof(Pin);
+}
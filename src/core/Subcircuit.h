@@ -0,0 +1,112 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "ComponentGeometry.h"
+#include "DesignStore.h"
+#include "../util/Rect.h"
+
+// Where an instance puts its definition: turned by rotation degrees about
+// the definition's origin, clockwise on screen like a part, then moved to
+// (x, y). Quarter turns are exact.
+struct Placement {
+    double x, y;
+    double rotation;
+
+    void to_world(double lx, double ly, double& wx, double& wy) const {
+        double c, s;
+        turn(c, s);
+        wx = x + lx * c - ly * s;
+        wy = y + lx * s + ly * c;
+    }
+
+    void to_local(double wx, double wy, double& lx, double& ly) const {
+        double c, s;
+        turn(c, s);
+        const double dx = wx - x, dy = wy - y;
+        lx = dx * c + dy * s;
+        ly = -dx * s + dy * c;
+    }
+
+    // A part placed like this keeps its size; its center moves and it
+    // turns with the instance.
+    ComponentGeometry to_world(const ComponentGeometry& g) const {
+        double cx, cy;
+        to_world(g.x + g.width/2, g.y + g.height/2, cx, cy);
+        double r = std::fmod(g.rotation + rotation, 360.0);
+        if (r < 0) r += 360.0;
+        return ComponentGeometry{g.kind, cx - g.width/2, cy - g.height/2, g.width, g.height, r};
+    }
+
+    ComponentGeometry to_local(const ComponentGeometry& g) const {
+        double cx, cy;
+        to_local(g.x + g.width/2, g.y + g.height/2, cx, cy);
+        double r = std::fmod(g.rotation - rotation, 360.0);
+        if (r < 0) r += 360.0;
+        return ComponentGeometry{g.kind, cx - g.width/2, cy - g.height/2, g.width, g.height, r};
+    }
+
+    // Box around a local box once placed.
+    Rect to_world(const Rect& r) const {
+        double xs[4], ys[4];
+        to_world(r.x0, r.y0, xs[0], ys[0]);
+        to_world(r.x1, r.y0, xs[1], ys[1]);
+        to_world(r.x0, r.y1, xs[2], ys[2]);
+        to_world(r.x1, r.y1, xs[3], ys[3]);
+        return Rect{*std::min_element(xs, xs + 4), *std::min_element(ys, ys + 4),
+                    *std::max_element(xs, xs + 4), *std::max_element(ys, ys + 4)};
+    }
+
+private:
+    void turn(double& c, double& s) const {
+        const double quarters = rotation / 90.0;
+        if (quarters == std::floor(quarters)) {
+            static constexpr double COS[4] = {1, 0, -1, 0};
+            static constexpr double SIN[4] = {0, 1, 0, -1};
+            const int q = static_cast<int>(((static_cast<long long>(quarters) % 4) + 4) % 4);
+            c = COS[q];
+            s = SIN[q];
+            return;
+        }
+        const double rad = rotation * M_PI / 180.0;
+        c = std::cos(rad);
+        s = std::sin(rad);
+    }
+};
+
+// A reusable block of parts and wires, in its own coordinates around its
+// origin. A definition never changes once built: every instance placing it,
+// and every copy of the store holding them, shares the one object. Editing
+// a block means building a new definition and pointing the instances at it.
+class SubcircuitDefinition {
+public:
+    SubcircuitDefinition(std::string name, DesignStore contents);
+
+    const std::string& name() const { return block_name; }
+    const DesignStore& contents() const { return parts; }
+
+    // Local extents of everything the block draws, and of its hit areas.
+    const Rect& draw_bounds() const { return drawn; }
+    const Rect& bounds() const { return hit; }
+
+    // Pins of its parts and ends of its wires, where something outside
+    // the block can connect, in local coordinates.
+    const std::vector<Pin>& connection_points() const { return connections; }
+
+    // Whether a local point hits one of the block's parts or wires.
+    bool contains_point(double lx, double ly) const;
+
+    size_t memory_usage() const;
+
+private:
+    std::string block_name;
+    DesignStore parts;
+    Rect drawn, hit;
+    std::vector<Pin> connections;
+};
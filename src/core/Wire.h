@@ -4,10 +4,14 @@
 */
 
 #pragma once
-#include <cairomm/context.h>
+#include <algorithm>
 #include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
 #include <nlohmann/json.hpp>
 #include "../util/Constants.h"
+#include "../util/Rect.h"
 
 using json = nlohmann::json;
 
@@ -18,27 +22,40 @@ public:
 
     void set_end(double nx, double ny) { x2 = nx; y2 = ny; }
 
-    void draw(const Cairo::RefPtr<Cairo::Context>& cr) {
-        cr->set_source_rgb(0, 0, 0);
-        cr->set_line_width(2.0);
-        cr->move_to(x1, y1);
-        cr->line_to(x2, y2);
-        cr->stroke();
+    static constexpr double HIT_BUFFER = 5.0; // pixels
+
+    bool contains_point(double px, double py) const {
+        return segment_contains_point(x1, y1, x2, y2, px, py);
+    }
+
+    Rect get_bounds() const {
+        return segment_bounds(x1, y1, x2, y2);
+    }
+
+    Rect get_draw_bounds() const {
+        return get_bounds();
     }
 
-    bool contains_point(double px, double py) {
-        const double buffer = 5.0; // pixels
+    // Hit test and extents of a wire from (x1, y1) to (x2, y2), shared with
+    // DesignStore's wire columns.
+    static bool segment_contains_point(double x1, double y1, double x2, double y2, double px, double py) {
+        const double buffer = HIT_BUFFER;
         double dx = x2 - x1;
         double dy = y2 - y1;
+        double ox = px - x1;
+        double oy = py - y1;
         double length_sq = dx*dx + dy*dy;
-        if (length_sq == 0) return std::hypot(px-x1, py-y1) <= buffer;
-
-        double t = ((px - x1)*dx + (py - y1)*dy) / length_sq;
+        double t = length_sq > 0 ? (ox*dx + oy*dy) / length_sq : 0.0;
         t = std::max(0.0, std::min(1.0, t));
-        double closest_x = x1 + t*dx;
-        double closest_y = y1 + t*dy;
 
-        return std::hypot(px - closest_x, py - closest_y) <= buffer;
+        // Offset from the closest point on the segment, compared squared
+        double cx = ox - t*dx;
+        double cy = oy - t*dy;
+        return cx*cx + cy*cy <= buffer*buffer;
+    }
+
+    static Rect segment_bounds(double x1, double y1, double x2, double y2) {
+        return Rect::from_points(x1, y1, x2, y2).expanded(HIT_BUFFER);
     }
 
     std::string get_type() const {
@@ -71,3 +88,5 @@ public:
 private:
     double x1, y1, x2, y2;
 };
+
+using WireList = std::vector<std::shared_ptr<Wire>>;
@@ -4,6 +4,7 @@
 */
 #include <gtkmm.h>
 #include "ui/CircuitCanvas.h"
+#include <cstdlib>
 #include <iostream>
 
 int main(int argc, char* argv[]) {
@@ -25,20 +26,48 @@ int main(int argc, char* argv[]) {
 
     Gtk::MenuItem open_item("_Open", true);
     Gtk::MenuItem save_item("_Save", true);
+    Gtk::MenuItem export_netlist_item("Export _Netlist", true);
+    Gtk::MenuItem export_image_item("Export _Image", true);
+    Gtk::MenuItem export_timings_item("Export _Timings", true);
+    Gtk::CheckMenuItem autosave_item("_Autosave", true);
+    autosave_item.set_active(true);
+    Gtk::CheckMenuItem journal_item("_Journal Saves", true);
+    journal_item.set_active(true);
     
     file_menu.append(open_item);
     file_menu.append(save_item);
+    file_menu.append(export_netlist_item);
+    file_menu.append(export_image_item);
+    file_menu.append(export_timings_item);
+    file_menu.append(autosave_item);
+    file_menu.append(journal_item);
     file_menu_item.set_submenu(file_menu);
 
+    // Edit menu
+    Gtk::MenuItem edit_menu_item("_Edit", true);
+    Gtk::Menu edit_menu;
+
+    Gtk::MenuItem undo_item("_Undo", true);
+    Gtk::MenuItem redo_item("_Redo", true);
+
+    edit_menu.append(undo_item);
+    edit_menu.append(redo_item);
+    edit_menu_item.set_submenu(edit_menu);
+
     menubar.append(file_menu_item);
+    menubar.append(edit_menu_item);
     menubar.show_all();
 
     // --- Canvas ---
     CircuitCanvas canvas;
 
-    // Pack menu + canvas into the vbox
+    // --- Status bar ---
+    Gtk::Statusbar statusbar;
+
+    // Pack menu + canvas + status bar into the vbox
     vbox.pack_start(menubar, Gtk::PACK_SHRINK);
     vbox.pack_start(canvas);
+    vbox.pack_start(statusbar, Gtk::PACK_SHRINK);
 
     window.add(vbox);
 
@@ -65,17 +94,128 @@ int main(int argc, char* argv[]) {
         dialog.add_button("_Save", Gtk::RESPONSE_OK);
         dialog.set_do_overwrite_confirmation(true);
 
+        if (dialog.run() == Gtk::RESPONSE_OK) {
+            canvas.save_to_file_async(dialog.get_filename());
+        }
+    });
+
+    undo_item.signal_activate().connect([&]() { canvas.undo(); });
+    redo_item.signal_activate().connect([&]() { canvas.redo(); });
+
+    export_netlist_item.signal_activate().connect([&]() {
+        Gtk::FileChooserDialog dialog(window, "Export Netlist", Gtk::FILE_CHOOSER_ACTION_SAVE);
+        dialog.add_button("_Cancel", Gtk::RESPONSE_CANCEL);
+        dialog.add_button("_Export", Gtk::RESPONSE_OK);
+        dialog.set_do_overwrite_confirmation(true);
+
         if (dialog.run() == Gtk::RESPONSE_OK) {
             std::string filename = dialog.get_filename();
-            if (!canvas.save_to_file(filename)) {
-                std::cerr << "Failed to save file: " << filename << std::endl;
+            if (!canvas.export_netlist(filename)) {
+                std::cerr << "Failed to export netlist: " << filename << std::endl;
             } else {
-                std::cout << "Saved to " << filename << std::endl;
+                std::cout << "Exported netlist to " << filename << std::endl;
             }
         }
     });
 
+    export_image_item.signal_activate().connect([&]() {
+        Gtk::FileChooserDialog dialog(window, "Export Image", Gtk::FILE_CHOOSER_ACTION_SAVE);
+        dialog.add_button("_Cancel", Gtk::RESPONSE_CANCEL);
+        dialog.add_button("_Export", Gtk::RESPONSE_OK);
+        dialog.set_do_overwrite_confirmation(true);
+        dialog.set_current_name("design.png");
+
+        if (dialog.run() == Gtk::RESPONSE_OK) {
+            std::string filename = dialog.get_filename();
+            if (!canvas.export_image(filename)) {
+                std::cerr << "Failed to export image: " << filename << std::endl;
+            }
+        }
+    });
+
+    export_timings_item.signal_activate().connect([&]() {
+        Gtk::FileChooserDialog dialog(window, "Export Timings", Gtk::FILE_CHOOSER_ACTION_SAVE);
+        dialog.add_button("_Cancel", Gtk::RESPONSE_CANCEL);
+        dialog.add_button("_Export", Gtk::RESPONSE_OK);
+        dialog.set_do_overwrite_confirmation(true);
+
+        if (dialog.run() == Gtk::RESPONSE_OK) {
+            std::string filename = dialog.get_filename();
+            if (!canvas.dump_metrics(filename)) {
+                std::cerr << "Failed to export timings: " << filename << std::endl;
+            } else {
+                std::cout << "Exported timings to " << filename << std::endl;
+            }
+        }
+    });
+
+    // Saves finish on a worker thread; their status arrives here on the main loop.
+    canvas.set_save_status_callback([&](const AsyncSaver::Status& status) {
+        const std::string what = status.autosave ? "Autosaving " : "Saving ";
+        statusbar.remove_all_messages();
+        switch (status.state) {
+            case AsyncSaver::Status::Started:
+                statusbar.push(what + status.filename + "...");
+                break;
+            case AsyncSaver::Status::Finished:
+                statusbar.push((status.autosave ? "Autosaved to " : "Saved to ") + status.filename);
+                std::cout << (status.autosave ? "Autosaved to " : "Saved to ") << status.filename << std::endl;
+                break;
+            case AsyncSaver::Status::Failed:
+                statusbar.push("Failed to save file: " + status.filename);
+                std::cerr << "Failed to save file: " << status.filename << std::endl;
+                break;
+        }
+    });
+
+    // Images render on a worker thread too.
+    canvas.set_export_status_callback([&](const AsyncExporter::Status& status) {
+        statusbar.remove_all_messages();
+        switch (status.state) {
+            case AsyncExporter::Status::Started:
+                statusbar.push("Exporting " + status.filename + "...");
+                break;
+            case AsyncExporter::Status::Finished:
+                statusbar.push("Exported image to " + status.filename);
+                std::cout << "Exported image to " << status.filename << std::endl;
+                break;
+            case AsyncExporter::Status::Failed:
+                statusbar.push("Failed to export image: " + status.filename);
+                std::cerr << "Failed to export image: " << status.filename << std::endl;
+                break;
+        }
+    });
+
+    canvas.set_autosave_enabled(autosave_item.get_active());
+    autosave_item.signal_toggled().connect([&]() {
+        // Images render on a worker thread too.
+    canvas.set_export_status_callback([&](const AsyncExporter::Status& status) {
+        statusbar.remove_all_messages();
+        switch (status.state) {
+            case AsyncExporter::Status::Started:
+                statusbar.push("Exporting " + status.filename + "...");
+                break;
+            case AsyncExporter::Status::Finished:
+                statusbar.push("Exported image to " + status.filename);
+                std::cout << "Exported image to " << status.filename << std::endl;
+                break;
+            case AsyncExporter::Status::Failed:
+                statusbar.push("Failed to export image: " + status.filename);
+                std::cerr << "Failed to export image: " << status.filename << std::endl;
+                break;
+        }
+    });
+
+    canvas.set_autosave_enabled(autosave_item.get_active());
+    });
+    canvas.set_journal_enabled(journal_item.get_active());
+    journal_item.signal_toggled().connect([&]() {
+        canvas.set_journal_enabled(journal_item.get_active());
+    });
+
     window.show_all();
 
-    return app->run(window);
+    int status = app->run(window);
+    if (std::getenv("ACAD_FRAME_STATS")) canvas.dump_metrics("-");
+    return status;
 }
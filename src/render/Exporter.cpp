@@ -0,0 +1,270 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "Exporter.h"
+#include <algorithm>
+#include <cairomm/context.h>
+#include <cairomm/surface.h>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <csetjmp>
+#include <cstdio>
+#include <iostream>
+#include <png.h>
+#include <vector>
+#include "Renderer.h"
+#include "../util/ThreadPool.h"
+
+namespace {
+
+// How the output image is cut into tiles, in pixels.
+struct TileGrid {
+    Rect region;
+    double scale;
+    int width, height;
+    int tile;
+    int columns, rows;
+
+    int column_of(double x) const {
+        return std::clamp(static_cast<int>(std::floor((x - region.x0) * scale / tile)), 0, columns - 1);
+    }
+    int row_of(double y) const {
+        return std::clamp(static_cast<int>(std::floor((y - region.y0) * scale / tile)), 0, rows - 1);
+    }
+};
+
+// Stacking positions of the objects touching each tile, as one array with
+// the range of tile k at items[offsets[k]..offsets[k + 1]).
+struct TileBuckets {
+    std::vector<size_t> offsets;
+    std::vector<uint32_t> items;
+};
+
+template <typename Bounds>
+void fill_buckets(const TileGrid& grid, size_t count, Bounds bounds, TileBuckets& out) {
+    const size_t tiles = static_cast<size_t>(grid.columns) * grid.rows;
+    out.offsets.assign(tiles + 1, 0);
+    auto each_tile = [&](size_t i, auto&& visit) {
+        const Rect b = bounds(i);
+        if (!b.intersects(grid.region)) return;
+        for (int r = grid.row_of(b.y0); r <= grid.row_of(b.y1); ++r)
+            for (int c = grid.column_of(b.x0); c <= grid.column_of(b.x1); ++c)
+                visit(static_cast<size_t>(r) * grid.columns + c);
+    };
+    for (size_t i = 0; i < count; ++i)
+        each_tile(i, [&](size_t k) { ++out.offsets[k + 1]; });
+    for (size_t k = 0; k < tiles; ++k) out.offsets[k + 1] += out.offsets[k];
+    out.items.resize(out.offsets[tiles]);
+    std::vector<size_t> next(out.offsets.begin(), out.offsets.end() - 1);
+    for (size_t i = 0; i < count; ++i)
+        each_tile(i, [&](size_t k) { out.items[next[k]++] = static_cast<uint32_t>(i); });
+}
+
+// Draws the objects of one tile, with the tile's top-left pixel at the
+// surface's origin.
+void draw_tile(const DesignStore& design, const TileGrid& grid, const TileBuckets& wires,
+               const TileBuckets& components, int column, int row, const Cairo::RefPtr<Cairo::ImageSurface>& surface) {
+    auto cr = Cairo::Context::create(surface);
+    cr->set_source_rgb(1, 1, 1);
+    cr->paint();
+    cr->translate(-static_cast<double>(column) * grid.tile, -static_cast<double>(row) * grid.tile);
+    cr->scale(grid.scale, grid.scale);
+    cr->translate(-grid.region.x0, -grid.region.y0);
+
+    const size_t k = static_cast<size_t>(row) * grid.columns + column;
+    const DesignStore::WireColumns& ws = design.wires();
+    for (size_t j = wires.offsets[k]; j < wires.offsets[k + 1]; ++j) {
+        const uint32_t i = wires.items[j];
+        draw_wire(cr, ws.x1[i], ws.y1[i], ws.x2[i], ws.y2[i]);
+    }
+    for (size_t j = components.offsets[k]; j < components.offsets[k + 1]; ++j)
+        draw_component_uncached(cr, design.geometry(components.items[j]));
+    surface->flush();
+}
+
+// Writes an 8-bit RGB PNG a row at a time. libpng reports errors by
+// longjmp, so each call that can fail sets its own jump target and nothing
+// with a destructor lives in those frames.
+class PngWriter {
+public:
+    ~PngWriter() {
+        if (png) png_destroy_write_struct(&png, info ? &info : nullptr);
+        if (file) std::fclose(file);
+    }
+
+    bool open(const std::string& filename, int width, int height) {
+        file = std::fopen(filename.c_str(), "wb");
+        if (!file) return false;
+        png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+        if (!png) return false;
+        info = png_create_info_struct(png);
+        if (!info) return false;
+        if (setjmp(png_jmpbuf(png))) return false;
+        png_init_io(png, file);
+        png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+                     PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+        png_write_info(png, info);
+        return true;
+    }
+
+    bool write_row(const uint8_t* rgb) {
+        if (setjmp(png_jmpbuf(png))) return false;
+        png_write_row(png, rgb);
+        return true;
+    }
+
+    bool finish() {
+        if (setjmp(png_jmpbuf(png))) return false;
+        png_write_end(png, nullptr);
+        const bool closed = std::fclose(file) == 0;
+        file = nullptr;
+        return closed;
+    }
+
+private:
+    FILE* file = nullptr;
+    png_structp png = nullptr;
+    png_infop info = nullptr;
+};
+
+bool export_png(const DesignStore& design, const std::string& filename, const TileGrid& grid, ThreadPool& pool) {
+    TileBuckets wires, components;
+    fill_buckets(grid, design.wire_count(), [&](size_t i) { return design.wire_bounds(i); }, wires);
+    fill_buckets(grid, design.component_count(), [&](size_t i) { return design.geometry(i).draw_bounds(); },
+                 components);
+
+    PngWriter writer;
+    if (!writer.open(filename, grid.width, grid.height)) return false;
+
+    // Enough rows of tiles per batch to keep every thread busy.
+    const size_t threads = pool.size() + 1;
+    const int batch_rows = std::clamp(static_cast<int>((2 * threads + grid.columns - 1) / grid.columns), 1, grid.rows);
+    std::vector<Cairo::RefPtr<Cairo::ImageSurface>> tiles(static_cast<size_t>(batch_rows) * grid.columns);
+    for (auto& tile : tiles) tile = Cairo::ImageSurface::create(Cairo::FORMAT_RGB24, grid.tile, grid.tile);
+    std::vector<uint8_t> line(static_cast<size_t>(grid.width) * 3);
+
+    for (int first_row = 0; first_row < grid.rows; first_row += batch_rows) {
+        const int rows = std::min(batch_rows, grid.rows - first_row);
+        pool.parallel_for(static_cast<size_t>(rows) * grid.columns, 1, [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; ++t)
+                draw_tile(design, grid, wires, components, static_cast<int>(t % grid.columns),
+                          first_row + static_cast<int>(t / grid.columns), tiles[t]);
+        });
+
+        // Stitch each pixel row together from the tiles across.
+        for (int r = 0; r < rows; ++r) {
+            const int y0 = (first_row + r) * grid.tile;
+            const int tile_height = std::min(grid.tile, grid.height - y0);
+            for (int y = 0; y < tile_height; ++y) {
+                uint8_t* out = line.data();
+                for (int c = 0; c < grid.columns; ++c) {
+                    const Cairo::RefPtr<Cairo::ImageSurface>& tile = tiles[static_cast<size_t>(r) * grid.columns + c];
+                    const uint32_t* pixels =
+                        reinterpret_cast<const uint32_t*>(tile->get_data() + static_cast<size_t>(y) * tile->get_stride());
+                    const int tile_width = std::min(grid.tile, grid.width - c * grid.tile);
+                    for (int x = 0; x < tile_width; ++x) {
+                        const uint32_t p = pixels[x];
+                        *out++ = static_cast<uint8_t>(p >> 16);
+                        *out++ = static_cast<uint8_t>(p >> 8);
+                        *out++ = static_cast<uint8_t>(p);
+                    }
+                }
+                if (!writer.write_row(line.data())) return false;
+            }
+        }
+    }
+    return writer.finish();
+}
+
+bool export_vector(const DesignStore& design, const std::string& filename, ExportFormat format,
+                   const Rect& region, double scale) {
+    const double width = region.width() * scale;
+    const double height = region.height() * scale;
+    Cairo::RefPtr<Cairo::Surface> surface;
+    if (format == ExportFormat::Svg) surface = Cairo::SvgSurface::create(filename, width, height);
+    else surface = Cairo::PdfSurface::create(filename, width, height);
+
+    auto cr = Cairo::Context::create(surface);
+    cr->set_source_rgb(1, 1, 1);
+    cr->paint();
+    cr->scale(scale, scale);
+    cr->translate(-region.x0, -region.y0);
+    const DesignStore::WireColumns& ws = design.wires();
+    for (size_t i = 0; i < design.wire_count(); ++i) {
+        if (design.wire_bounds(i).intersects(region)) draw_wire(cr, ws.x1[i], ws.y1[i], ws.x2[i], ws.y2[i]);
+    }
+    for (size_t i = 0; i < design.component_count(); ++i) {
+        const ComponentGeometry geometry = design.geometry(i);
+        if (geometry.draw_bounds().intersects(region)) draw_component_uncached(cr, geometry);
+    }
+    cr->show_page();
+    // The writes happen as the surface is finished, so that is where a full
+    // disk or unwritable file shows up.
+    surface->finish();
+    const cairo_status_t status = cairo_surface_status(surface->cobj());
+    if (status != CAIRO_STATUS_SUCCESS) {
+        std::cerr << "Failed to write " << filename << ": " << cairo_status_to_string(status) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}
+
+bool export_format_for(const std::string& filename, ExportFormat& format) {
+    const size_t dot = filename.find_last_of('.');
+    if (dot == std::string::npos) return false;
+    std::string extension = filename.substr(dot + 1);
+    for (char& ch : extension) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    if (extension == "png") format = ExportFormat::Png;
+    else if (extension == "svg") format = ExportFormat::Svg;
+    else if (extension == "pdf") format = ExportFormat::Pdf;
+    else return false;
+    return true;
+}
+
+Rect design_draw_bounds(const DesignStore& design) {
+    Rect bounds;
+    for (size_t i = 0; i < design.component_count(); ++i) bounds = bounds.united(design.geometry(i).draw_bounds());
+    for (size_t i = 0; i < design.wire_count(); ++i) bounds = bounds.united(design.wire_bounds(i));
+    return bounds;
+}
+
+bool export_design(const DesignStore& design, const std::string& filename, ExportFormat format,
+                   const ExportOptions& options, ThreadPool& pool) {
+    // Blocks are drawn as the parts they place.
+    if (design.instance_count() > 0) return export_design(design.flattened(), filename, format, options, pool);
+
+    Rect region = options.region;
+    if (region.empty()) {
+        region = design_draw_bounds(design);
+        if (region.empty()) region = Rect{0, 0, 1, 1};
+        region = region.expanded(options.margin);
+    }
+    const double width = std::ceil(region.width() * options.scale);
+    const double height = std::ceil(region.height() * options.scale);
+    if (!(options.scale > 0) || !(width >= 1 && width <= INT_MAX) || !(height >= 1 && height <= INT_MAX)) {
+        std::cerr << "Export size out of range: " << width << " x " << height << std::endl;
+        return false;
+    }
+
+    bool ok = false;
+    try {
+        if (format == ExportFormat::Png) {
+            TileGrid grid{region, options.scale, static_cast<int>(width), static_cast<int>(height),
+                          std::max(options.tile_size, 16), 0, 0};
+            grid.columns = (grid.width + grid.tile - 1) / grid.tile;
+            grid.rows = (grid.height + grid.tile - 1) / grid.tile;
+            ok = export_png(design, filename, grid, pool);
+        } else {
+            ok = export_vector(design, filename, format, region, options.scale);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to export " << filename << ": " << e.what() << std::endl;
+    }
+    if (!ok) std::remove(filename.c_str());
+    return ok;
+}
@@ -0,0 +1,38 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <string>
+#include "../core/DesignStore.h"
+#include "../util/Rect.h"
+
+class ThreadPool;
+
+enum class ExportFormat { Png, Svg, Pdf };
+
+// Format named by the file's extension (.png, .svg or .pdf, any case).
+bool export_format_for(const std::string& filename, ExportFormat& format);
+
+struct ExportOptions {
+    // Pixels (PNG) or points (SVG, PDF) per canvas unit.
+    double scale = 1.0;
+    // Part of the canvas to draw; empty means the whole design plus margin.
+    Rect region;
+    double margin = 20.0;
+    // Side of the square tiles a PNG is rendered in.
+    int tile_size = 512;
+};
+
+// Draws the design like the canvas at zoom 1, without grid or highlights,
+// on white. A PNG is rendered a few rows of tiles at a time, the tiles in
+// parallel on the pool, and streamed to the file as rows of pixels, so its
+// size is limited by neither memory nor cairo's maximum surface size. SVG
+// and PDF are vector output and drawn in one pass. Symbols are drawn
+// uncached, so this may run off the UI thread.
+bool export_design(const DesignStore& design, const std::string& filename, ExportFormat format,
+                   const ExportOptions& options, ThreadPool& pool);
+
+// Extents of everything the design draws.
+Rect design_draw_bounds(const DesignStore& design);
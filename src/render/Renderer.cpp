@@ -0,0 +1,166 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "Renderer.h"
+#include <cmath>
+#include "SymbolCache.h"
+#include "../util/Constants.h"
+
+namespace {
+
+void draw_resistor(const Cairo::RefPtr<Cairo::Context>& cr, double width, double height, double rotation) {
+    cr->save();
+    cr->translate(width/2, height/2);
+    cr->rotate(rotation * M_PI / 180.0);
+    cr->translate(-width/2, -height/2);
+    cr->set_source_rgb(0, 0, 0);
+    cr->set_line_width(2.0);
+    double segment = width / 8.0;
+    cr->move_to(0, height/2);
+    bool up = true;
+    for(int i = 0; i < 7; ++i) {
+        cr->line_to(segment * (i + 1), up ? 0 : i == 6 ? height/2 : height);
+        up = !up;
+    }
+    cr->line_to(width, height/2);
+    cr->stroke();
+    cr->set_line_width(4.0);
+    cr->move_to(-10, height/2); cr->line_to(0, height/2);
+    cr->move_to(width, height/2); cr->line_to(width + 10, height/2);
+    cr->stroke();
+    cr->restore();
+}
+
+void draw_capacitor(const Cairo::RefPtr<Cairo::Context>& cr, double width, double height, double rotation) {
+    cr->save();
+    cr->translate(width/2, height/2);
+    cr->rotate(rotation * M_PI / 180.0);
+    cr->translate(-width/2, -height/2);
+    cr->set_source_rgb(0.0, 0.0, 0.0);
+    cr->set_line_width(3.0);
+    double gap = width / 4.0;
+    cr->move_to(width/2 - gap, 0);
+    cr->line_to(width/2 - gap, height);
+    cr->stroke();
+    cr->move_to(width/2 + gap, 0);
+    cr->line_to(width/2 + gap, height);
+    cr->stroke();
+    cr->set_line_width(2.0);
+    cr->move_to(0, height/2);
+    cr->line_to(width/2 - gap, height/2);
+    cr->move_to(width/2 + gap, height/2);
+    cr->line_to(width, height/2);
+    cr->stroke();
+    cr->restore();
+}
+
+void draw_coil(const Cairo::RefPtr<Cairo::Context>& cr, double width, double height, double rotation) {
+    cr->save();
+    cr->translate(width/2, height/2);
+    cr->rotate(rotation * M_PI / 180.0);
+    cr->translate(-width/2, -height/2);
+    cr->set_source_rgb(0, 0, 0);
+    int num_loops = 3;
+    double loop_radius = height / 4.0;
+    double total_width = 2 * num_loops * loop_radius;
+    double x_offset = (width - total_width) / 2.0;
+    x_offset -= loop_radius / 2.0;
+    double center_y = height / 2;
+    cr->set_line_width(4.0);
+    cr->move_to(-5, center_y);
+    cr->line_to(x_offset, center_y);
+    cr->stroke();
+    cr->set_line_width(2.0);
+    double x_pos = x_offset;
+    for (int i = 0; i < num_loops; ++i) {
+        cr->arc(x_pos + loop_radius, center_y, loop_radius, M_PI, 0);
+        x_pos += 2 * loop_radius;
+    }
+    cr->stroke();
+    cr->set_line_width(4.0);
+    cr->move_to(x_pos, center_y);
+    cr->line_to(width + 5, center_y);
+    cr->stroke();
+    cr->restore();
+}
+
+void draw_transistor(const Cairo::RefPtr<Cairo::Context>& cr, double width, double height, double rotation) {
+    cr->save();
+    cr->translate(width/2, height/2 + GRID_SIZE / 2.0);
+    cr->rotate(rotation * M_PI / 180.0);
+    cr->translate(-width/2, -height/2);
+    cr->set_line_width(2.0);
+    cr->set_source_rgb(0, 0, 0);
+    cr->move_to(width/2, 0); cr->line_to(width/2, height/4);
+    cr->move_to(width/2, height); cr->line_to(width/2, 3*height/4);
+    cr->move_to(0, height/2); cr->line_to(width/4, height/2);
+    cr->stroke();
+    double center_x = width / 2;
+    double center_y = height / 2;
+    double radius = std::min(width, height) / 4.0;
+    cr->arc(center_x, center_y, radius, 0, 2*M_PI);
+    cr->stroke();
+    double left_x = center_x - radius;
+    double left_y = center_y;
+    double top_x = center_x;
+    double top_y = center_y - radius;
+    double bottom_x = center_x;
+    double bottom_y = center_y + radius;
+    cr->move_to(left_x, left_y); cr->line_to(top_x, top_y);
+    cr->move_to(left_x, left_y); cr->line_to(bottom_x, bottom_y);
+    cr->stroke();
+    cr->restore();
+}
+
+}
+
+void draw_symbol(const Cairo::RefPtr<Cairo::Context>& cr, const ComponentGeometry& g) {
+    switch (g.kind) {
+        case ComponentKind::Resistor: draw_resistor(cr, g.width, g.height, g.rotation); break;
+        case ComponentKind::Capacitor: draw_capacitor(cr, g.width, g.height, g.rotation); break;
+        case ComponentKind::Coil: draw_coil(cr, g.width, g.height, g.rotation); break;
+        case ComponentKind::Transistor: draw_transistor(cr, g.width, g.height, g.rotation); break;
+    }
+}
+
+void draw_component(const Cairo::RefPtr<Cairo::Context>& cr, const ComponentGeometry& g) {
+    Rect extents = g.draw_bounds();
+    extents = Rect{extents.x0 - g.x, extents.y0 - g.y, extents.x1 - g.x, extents.y1 - g.y};
+
+    SymbolCache& cache = SymbolCache::instance();
+    SymbolCache::Key key{g.kind, g.width, g.height, g.rotation};
+    auto symbol = cache.find(key);
+    if (!symbol && cache.can_record(key)) {
+        symbol = cache.record(key, extents, [&g](const Cairo::RefPtr<Cairo::Context>& rcr) {
+            draw_symbol(rcr, g);
+        });
+    }
+
+    cr->save();
+    if (symbol) {
+        cr->set_source(symbol, g.x, g.y);
+        cr->rectangle(g.x + extents.x0, g.y + extents.y0, extents.width(), extents.height());
+        cr->fill();
+    } else {
+        cr->translate(g.x, g.y);
+        draw_symbol(cr, g);
+    }
+    cr->restore();
+}
+
+void draw_component_uncached(const Cairo::RefPtr<Cairo::Context>& cr, const ComponentGeometry& g) {
+    cr->save();
+    cr->translate(g.x, g.y);
+    draw_symbol(cr, g);
+    cr->restore();
+}
+
+void draw_wire(const Cairo::RefPtr<Cairo::Context>& cr, double x1, double y1, double x2, double y2) {
+    cr->set_source_rgb(0, 0, 0);
+    cr->set_line_width(2.0);
+    cr->move_to(x1, y1);
+    cr->line_to(x2, y2);
+    cr->stroke();
+}
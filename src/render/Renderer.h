@@ -0,0 +1,37 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <cairomm/context.h>
+#include "../core/CircuitComponent.h"
+#include "../core/Wire.h"
+
+// Cairo drawing of the model. The core classes only describe geometry;
+// everything that draws them lives here.
+
+// Draws the component's symbol with its top-left corner at the origin.
+void draw_symbol(const Cairo::RefPtr<Cairo::Context>& cr, const ComponentGeometry& geometry);
+
+// Replays the cached symbol for the component's kind, size and rotation,
+// translated to its position. Falls back to draw_symbol when the symbol
+// can't be cached. SymbolCache belongs to the UI thread.
+void draw_component(const Cairo::RefPtr<Cairo::Context>& cr, const ComponentGeometry& geometry);
+
+// Draws the symbol directly, for threads other than the UI's.
+void draw_component_uncached(const Cairo::RefPtr<Cairo::Context>& cr, const ComponentGeometry& geometry);
+
+void draw_wire(const Cairo::RefPtr<Cairo::Context>& cr, double x1, double y1, double x2, double y2);
+
+inline void draw_component(const Cairo::RefPtr<Cairo::Context>& cr, const CircuitComponent& comp) {
+    draw_component(cr, comp.geometry());
+}
+
+inline void draw_component_uncached(const Cairo::RefPtr<Cairo::Context>& cr, const CircuitComponent& comp) {
+    draw_component_uncached(cr, comp.geometry());
+}
+
+inline void draw_wire(const Cairo::RefPtr<Cairo::Context>& cr, const Wire& wire) {
+    draw_wire(cr, wire.get_x1(), wire.get_y1(), wire.get_x2(), wire.get_y2());
+}
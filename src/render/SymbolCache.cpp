@@ -0,0 +1,41 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "SymbolCache.h"
+#include <cmath>
+
+SymbolCache& SymbolCache::instance() {
+    static SymbolCache cache;
+    return cache;
+}
+
+size_t SymbolCache::KeyHash::operator()(const Key& k) const {
+    size_t h = std::hash<int>()(static_cast<int>(k.kind));
+    auto mix = [&h](size_t v) { h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2); };
+    // Adding 0.0 folds -0.0 into 0.0, which compare equal and must hash alike.
+    mix(std::hash<double>()(k.width + 0.0));
+    mix(std::hash<double>()(k.height + 0.0));
+    mix(std::hash<double>()(k.rotation + 0.0));
+    return h;
+}
+
+Cairo::RefPtr<Cairo::RecordingSurface> SymbolCache::find(const Key& key) const {
+    auto it = symbols.find(key);
+    return it == symbols.end() ? Cairo::RefPtr<Cairo::RecordingSurface>() : it->second;
+}
+
+bool SymbolCache::can_record(const Key& key) const {
+    return symbols.size() < MAX_SYMBOLS && key.rotation == std::round(key.rotation);
+}
+
+Cairo::RefPtr<Cairo::RecordingSurface> SymbolCache::record(const Key& key, const Rect& extents,
+                                                           const RecordFn& draw) {
+    Cairo::Rectangle area{extents.x0, extents.y0, extents.width(), extents.height()};
+    auto surface = Cairo::RecordingSurface::create(area, Cairo::CONTENT_COLOR_ALPHA);
+    auto cr = Cairo::Context::create(surface);
+    draw(cr);
+    symbols[key] = surface;
+    return surface;
+}
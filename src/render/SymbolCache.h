@@ -0,0 +1,52 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <cairomm/context.h>
+#include <cairomm/surface.h>
+#include <functional>
+#include <unordered_map>
+#include "../core/CircuitComponent.h"
+#include "../util/Rect.h"
+
+// Recorded drawing commands for each distinct component symbol. Identical parts
+// share one recording, so a symbol's path is built once no matter how many
+// instances of it are drawn.
+class SymbolCache {
+public:
+    struct Key {
+        ComponentKind kind;
+        double width, height;
+        double rotation;
+
+        bool operator==(const Key& o) const = default;
+    };
+
+    using RecordFn = std::function<void(const Cairo::RefPtr<Cairo::Context>&)>;
+
+    static SymbolCache& instance();
+
+    Cairo::RefPtr<Cairo::RecordingSurface> find(const Key& key) const;
+
+    // Only whole-degree rotations are cached, and only up to MAX_SYMBOLS keys
+    // so a design full of odd sizes can't grow the cache without bound.
+    bool can_record(const Key& key) const;
+
+    // Records draw into a surface bounded by extents (symbol-local coordinates).
+    Cairo::RefPtr<Cairo::RecordingSurface> record(const Key& key, const Rect& extents,
+                                                  const RecordFn& draw);
+
+    void clear() { symbols.clear(); }
+    size_t size() const { return symbols.size(); }
+
+    static constexpr size_t MAX_SYMBOLS = 1024;
+
+private:
+    struct KeyHash {
+        size_t operator()(const Key& k) const;
+    };
+
+    std::unordered_map<Key, Cairo::RefPtr<Cairo::RecordingSurface>, KeyHash> symbols;
+};
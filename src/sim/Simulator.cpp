@@ -0,0 +1,654 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "Simulator.h"
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace {
+
+// Ebers-Moll NPN parameters shared by every transistor.
+constexpr double BJT_IS = 1e-14;
+constexpr double BJT_BETA_R = 1.0;
+constexpr double THERMAL_VOLTAGE = 0.025852;
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+inline void add(std::vector<double>& values, int slot, double v) {
+    if (slot >= 0) values[slot] += v;
+}
+
+inline void add_rhs(std::vector<double>& rhs, int node, double v) {
+    if (node >= 0) rhs[node] += v;
+}
+
+// SPICE's pnjlim: keeps a junction voltage from jumping so far up the
+// exponential in one Newton step that the next linearization is useless.
+double limit_junction(double v_new, double v_old, bool& limited) {
+    static const double v_crit = THERMAL_VOLTAGE * std::log(THERMAL_VOLTAGE / (std::sqrt(2.0) * BJT_IS));
+    if (v_new > v_crit && std::abs(v_new - v_old) > 2 * THERMAL_VOLTAGE) {
+        limited = true;
+        if (v_old > 0) {
+            double arg = 1 + (v_new - v_old) / THERMAL_VOLTAGE;
+            return arg > 0 ? v_old + THERMAL_VOLTAGE * std::log(arg) : v_crit;
+        }
+        return THERMAL_VOLTAGE * std::log(v_new / THERMAL_VOLTAGE);
+    }
+    return v_new;
+}
+
+}
+
+Waveform Waveform::dc(double value) {
+    Waveform w;
+    w.shape = Dc;
+    w.params[0] = value;
+    return w;
+}
+
+Waveform Waveform::pulse(double v1, double v2, double delay, double rise, double fall,
+                         double width, double period) {
+    Waveform w;
+    w.shape = Pulse;
+    double p[7] = {v1, v2, delay, rise, fall, width, period};
+    std::copy(p, p + 7, w.params);
+    return w;
+}
+
+Waveform Waveform::sine(double offset, double amplitude, double frequency, double delay) {
+    Waveform w;
+    w.shape = Sine;
+    w.params[0] = offset;
+    w.params[1] = amplitude;
+    w.params[2] = frequency;
+    w.params[3] = delay;
+    return w;
+}
+
+double Waveform::at(double t) const {
+    switch (shape) {
+        case Dc:
+            return params[0];
+        case Pulse: {
+            const auto& [v1, v2, delay, rise, fall, width, period] = params;
+            if (t < delay) return v1;
+            double tt = t - delay;
+            if (period > 0) tt = std::fmod(tt, period);
+            if (tt < rise) return v1 + (v2 - v1) * tt / rise;
+            if (tt < rise + width) return v2;
+            if (tt < rise + width + fall) return v2 + (v1 - v2) * (tt - rise - width) / fall;
+            return v1;
+        }
+        case Sine:
+            if (t < params[3]) return params[0];
+            return params[0] + params[1] * std::sin(2 * M_PI * params[2] * (t - params[3]));
+    }
+    return 0;
+}
+
+double Waveform::next_breakpoint(double t) const {
+    const double eps = 1e-15;
+    if (shape == Sine) return t + eps < params[3] ? params[3] : INF;
+    if (shape != Pulse) return INF;
+
+    const auto& [v1, v2, delay, rise, fall, width, period] = params;
+    if (t + eps < delay) return delay;
+    double base = delay;
+    if (period > 0) base += std::floor((t - delay) / period) * period;
+    const double corners[] = {0, rise, rise + width, rise + width + fall, period > 0 ? period : INF};
+    for (double c : corners) {
+        if (base + c > t + eps) return base + c;
+    }
+    return period > 0 ? base + 2 * period : INF;
+}
+
+Simulator::Simulator(const ComponentList& components, const WireList& wires, const SimulationOptions& options)
+    : Simulator(components, extract_netlist(components, wires), options) {}
+
+Simulator::Simulator(const ComponentList& components, Netlist netlist_, const SimulationOptions& options)
+    : options(options), netlist(std::move(netlist_)) {
+    component_elements.reserve(components.size());
+    for (size_t i = 0; i < components.size(); ++i) {
+        const auto& comp = components[i];
+        const uint32_t a = net_of_pin(i, 0);
+        const uint32_t b = net_of_pin(i, 1);
+        const ComponentKind kind = comp->get_kind();
+        switch (kind) {
+            case ComponentKind::Resistor:
+                component_elements.emplace_back(kind, resistors.size());
+                resistors.push_back(Branch{{a, b}, comp->value});
+                break;
+            case ComponentKind::Capacitor:
+                component_elements.emplace_back(kind, capacitors.size());
+                capacitors.push_back(Branch{{a, b}, comp->value});
+                break;
+            case ComponentKind::Coil:
+                component_elements.emplace_back(kind, inductors.size());
+                inductors.push_back(BranchCurrent{{a, b}, comp->value});
+                break;
+            case ComponentKind::Transistor:
+                component_elements.emplace_back(kind, bjts.size());
+                bjts.push_back(Bjt{{a, b, net_of_pin(i, 2)}, comp->value});
+                break;
+        }
+    }
+}
+
+bool Simulator::set_component_value(size_t component, double value) {
+    if (component >= component_elements.size()) {
+        error = "Component does not exist";
+        return false;
+    }
+    const auto [kind, index] = component_elements[component];
+    switch (kind) {
+        case ComponentKind::Resistor:
+            if (!(value > 0)) { error = "Resistor with non-positive resistance"; return false; }
+            resistors[index].value = value;
+            break;
+        case ComponentKind::Capacitor:
+            if (!(value >= 0)) { error = "Capacitor with negative capacitance"; return false; }
+            capacitors[index].value = value;
+            break;
+        case ComponentKind::Coil:
+            if (!(value >= 0)) { error = "Coil with negative inductance"; return false; }
+            inductors[index].value = value;
+            break;
+        case ComponentKind::Transistor:
+            // Gain only enters the Newton stamps, not the linear part.
+            if (!(value > 0)) { error = "Transistor with non-positive gain"; return false; }
+            bjts[index].beta = value;
+            return true;
+    }
+    assembled_h = -1;
+    factor_valid = false;
+    return true;
+}
+
+void Simulator::set_ground(uint32_t net) {
+    ground_net = net;
+    built = false;
+}
+
+void Simulator::add_voltage_source(uint32_t positive, uint32_t negative, const Waveform& waveform) {
+    voltage_sources.push_back(Source{{positive, negative}, waveform});
+    built = false;
+}
+
+void Simulator::add_current_source(uint32_t from, uint32_t to, const Waveform& waveform) {
+    current_sources.push_back(Source{{from, to}, waveform});
+    built = false;
+}
+
+int Simulator::node_of(uint32_t net) const {
+    if (net == ground_net) return GROUND;
+    return static_cast<int>(net < ground_net ? net : net - 1);
+}
+
+// Maps nets to unknowns, fixes the matrix pattern and resolves every
+// element's stamp positions. Runs again after the ground or sources change.
+bool Simulator::build() {
+    error.clear();
+    const size_t net_count = netlist.net_count;
+    if (net_count > 0 && ground_net >= net_count) {
+        error = "Ground net does not exist";
+        return false;
+    }
+    for (const auto* sources : {&voltage_sources, &current_sources}) {
+        for (const auto& s : *sources) {
+            if (s.nets[0] >= net_count || s.nets[1] >= net_count) {
+                error = "Source connected to a net that does not exist";
+                return false;
+            }
+        }
+    }
+    for (const auto& r : resistors)
+        if (!(r.value > 0)) { error = "Resistor with non-positive resistance"; return false; }
+    for (const auto& c : capacitors)
+        if (!(c.value >= 0)) { error = "Capacitor with negative capacitance"; return false; }
+    for (const auto& l : inductors)
+        if (!(l.value >= 0)) { error = "Coil with negative inductance"; return false; }
+    for (const auto& q : bjts)
+        if (!(q.beta > 0)) { error = "Transistor with non-positive gain"; return false; }
+
+    nodes = net_count > 0 ? static_cast<int>(net_count) - 1 : 0;
+    int next_branch = nodes;
+
+    std::vector<std::pair<int, int>> entries;
+    auto entry = [&](int row, int col) {
+        if (row != GROUND && col != GROUND) entries.emplace_back(row, col);
+    };
+    for (int i = 0; i < nodes; ++i)
+        entry(i, i);
+    for (auto* list : {&resistors, &capacitors}) {
+        for (auto& e : *list) {
+            e.a = node_of(e.nets[0]);
+            e.b = node_of(e.nets[1]);
+            entry(e.a, e.a); entry(e.a, e.b); entry(e.b, e.a); entry(e.b, e.b);
+        }
+    }
+    for (auto& e : inductors) {
+        e.a = node_of(e.nets[0]);
+        e.b = node_of(e.nets[1]);
+        e.k = next_branch++;
+        entry(e.a, e.k); entry(e.b, e.k); entry(e.k, e.a); entry(e.k, e.b); entry(e.k, e.k);
+    }
+    for (auto& s : voltage_sources) {
+        s.a = node_of(s.nets[0]);
+        s.b = node_of(s.nets[1]);
+        s.k = next_branch++;
+        entry(s.a, s.k); entry(s.b, s.k); entry(s.k, s.a); entry(s.k, s.b);
+    }
+    for (auto& s : current_sources) {
+        s.a = node_of(s.nets[0]);
+        s.b = node_of(s.nets[1]);
+    }
+    for (auto& q : bjts) {
+        for (int t = 0; t < 3; ++t)
+            q.nodes[t] = node_of(q.nets[t]);
+        for (int r : q.nodes)
+            for (int c : q.nodes)
+                entry(r, c);
+    }
+    unknowns = next_branch;
+
+    matrix = SparseMatrix::from_entries(unknowns, std::move(entries));
+    auto slot = [&](int row, int col) {
+        return row == GROUND || col == GROUND ? -1 : matrix.find(row, col);
+    };
+    gmin_slots.resize(nodes);
+    for (int i = 0; i < nodes; ++i)
+        gmin_slots[i] = slot(i, i);
+    for (auto* list : {&resistors, &capacitors}) {
+        for (auto& e : *list) {
+            int s[4] = {slot(e.a, e.a), slot(e.a, e.b), slot(e.b, e.a), slot(e.b, e.b)};
+            std::copy(s, s + 4, e.slots);
+        }
+    }
+    for (auto& e : inductors) {
+        int s[5] = {slot(e.a, e.k), slot(e.b, e.k), slot(e.k, e.a), slot(e.k, e.b), slot(e.k, e.k)};
+        std::copy(s, s + 5, e.slots);
+    }
+    for (auto& e : voltage_sources) {
+        int s[4] = {slot(e.a, e.k), slot(e.b, e.k), slot(e.k, e.a), slot(e.k, e.b)};
+        std::copy(s, s + 4, e.slots);
+    }
+    for (auto& q : bjts) {
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                q.slots[r][c] = slot(q.nodes[r], q.nodes[c]);
+    }
+
+    linear_values.assign(matrix.nonzeros(), 0.0);
+    lu = SparseLU();
+    if (unknowns > 0) lu.analyze(matrix);
+    factor_valid = false;
+    assembled_h = -1;
+    assembled_gmin = -1;
+    solution.assign(unknowns, 0.0);
+    rhs_base.assign(unknowns, 0.0);
+    rhs.assign(unknowns, 0.0);
+    built = true;
+    return true;
+}
+
+// Matrix entries that only change with the analysis mode, the step or gmin.
+void Simulator::assemble_linear(Mode mode, double h, double gmin) {
+    if (mode == assembled_mode && h == assembled_h && gmin == assembled_gmin) return;
+    assembled_mode = mode;
+    assembled_h = h;
+    assembled_gmin = gmin;
+    factor_valid = false;
+
+    std::vector<double>& v = linear_values;
+    std::fill(v.begin(), v.end(), 0.0);
+    for (int s : gmin_slots)
+        add(v, s, gmin);
+
+    auto conductance = [&](const Branch& e, double g) {
+        add(v, e.slots[0], g);
+        add(v, e.slots[1], -g);
+        add(v, e.slots[2], -g);
+        add(v, e.slots[3], g);
+    };
+    for (const auto& e : resistors)
+        conductance(e, 1.0 / e.value);
+    if (mode == Mode::Transient) {
+        for (const auto& e : capacitors)
+            conductance(e, 2.0 * e.value / h);
+    }
+
+    // v_a - v_b = (2L/h) i - (history) in transient, a short at DC.
+    for (const auto& e : inductors) {
+        add(v, e.slots[0], 1.0);
+        add(v, e.slots[1], -1.0);
+        add(v, e.slots[2], 1.0);
+        add(v, e.slots[3], -1.0);
+        if (mode == Mode::Transient) add(v, e.slots[4], -2.0 * e.value / h);
+    }
+    for (const auto& e : voltage_sources) {
+        add(v, e.slots[0], 1.0);
+        add(v, e.slots[1], -1.0);
+        add(v, e.slots[2], 1.0);
+        add(v, e.slots[3], -1.0);
+    }
+}
+
+void Simulator::assemble_rhs(Mode mode, double t, double h, std::vector<double>& out) const {
+    std::fill(out.begin(), out.end(), 0.0);
+    auto voltage = [&](int node) { return node == GROUND ? 0.0 : solution[node]; };
+
+    if (mode == Mode::Transient) {
+        // Trapezoidal companions: i(n+1) = (2C/h) v(n+1) - ((2C/h) v(n) + i(n)).
+        for (size_t i = 0; i < capacitors.size(); ++i) {
+            const Branch& e = capacitors[i];
+            double ieq = 2.0 * e.value / h * (voltage(e.a) - voltage(e.b)) + capacitor_currents[i];
+            add_rhs(out, e.a, ieq);
+            add_rhs(out, e.b, -ieq);
+        }
+        for (size_t i = 0; i < inductors.size(); ++i) {
+            const BranchCurrent& e = inductors[i];
+            out[e.k] = -2.0 * e.value / h * solution[e.k] - inductor_voltages[i];
+        }
+    }
+    for (const auto& s : voltage_sources)
+        out[s.k] = s.waveform.at(t);
+    for (const auto& s : current_sources) {
+        double i = s.waveform.at(t);
+        add_rhs(out, s.a, -i);
+        add_rhs(out, s.b, i);
+    }
+}
+
+// Linearizes every transistor around x and adds it to the matrix values and
+// rhs. Each terminal current I(vbe, vbc) becomes I0 + dI/dvbe (vbe - vbe0) +
+// dI/dvbc (vbc - vbc0), i.e. conductances plus a constant current.
+void Simulator::stamp_bjts(const std::vector<double>& x, std::vector<double>& out, bool& limited) {
+    auto voltage = [&](int node) { return node == GROUND ? 0.0 : x[node]; };
+    const double gmin = assembled_gmin;
+    for (Bjt& q : bjts) {
+        const int c = q.nodes[0], b = q.nodes[1], e = q.nodes[2];
+        q.vbe = limit_junction(voltage(b) - voltage(e), q.vbe, limited);
+        q.vbc = limit_junction(voltage(b) - voltage(c), q.vbc, limited);
+
+        double ebe = std::exp(std::min(q.vbe / THERMAL_VOLTAGE, 80.0));
+        double ebc = std::exp(std::min(q.vbc / THERMAL_VOLTAGE, 80.0));
+        double ibe = BJT_IS * (ebe - 1) + gmin * q.vbe;
+        double ibc = BJT_IS * (ebc - 1) + gmin * q.vbc;
+        double gbe = BJT_IS / THERMAL_VOLTAGE * ebe + gmin;
+        double gbc = BJT_IS / THERMAL_VOLTAGE * ebc + gmin;
+
+        // Currents into the collector, base and emitter and their partials.
+        double current[3], d_be[3], d_bc[3];
+        current[0] = ibe - ibc - ibc / BJT_BETA_R;
+        d_be[0] = gbe;
+        d_bc[0] = -gbc - gbc / BJT_BETA_R;
+        current[1] = ibe / q.beta + ibc / BJT_BETA_R;
+        d_be[1] = gbe / q.beta;
+        d_bc[1] = gbc / BJT_BETA_R;
+        current[2] = -(current[0] + current[1]);
+        d_be[2] = -(d_be[0] + d_be[1]);
+        d_bc[2] = -(d_bc[0] + d_bc[1]);
+
+        for (int t = 0; t < 3; ++t) {
+            if (q.nodes[t] == GROUND) continue;
+            // vbe = vb - ve and vbc = vb - vc, so by terminal voltage:
+            add(matrix.values, q.slots[t][0], -d_bc[t]);
+            add(matrix.values, q.slots[t][1], d_be[t] + d_bc[t]);
+            add(matrix.values, q.slots[t][2], -d_be[t]);
+            out[q.nodes[t]] -= current[t] - d_be[t] * q.vbe - d_bc[t] * q.vbc;
+        }
+    }
+}
+
+bool Simulator::factorize() {
+    if (lu.refactor(matrix) || lu.factor(matrix)) {
+        factor_valid = true;
+        return true;
+    }
+    // Node unknowns come first, as numbered by node_of; the rest are branch
+    // currents of coils and voltage sources.
+    const int column = lu.singular_column();
+    error = "Singular circuit matrix";
+    if (column >= 0 && column < nodes) {
+        const uint32_t net = static_cast<uint32_t>(column) < ground_net ? column : column + 1;
+        error += ": the voltage of net " + std::to_string(net) + " is not determined";
+    } else if (column >= nodes) {
+        error += ": a loop of voltage sources and coils, or a source across a short";
+    }
+    return false;
+}
+
+bool Simulator::converged(const std::vector<double>& x, const std::vector<double>& previous) const {
+    for (int i = 0; i < unknowns; ++i) {
+        double tol = options.reltol * std::max(std::abs(x[i]), std::abs(previous[i])) +
+                     (i < nodes ? options.vntol : options.abstol);
+        if (std::abs(x[i] - previous[i]) > tol) return false;
+    }
+    return true;
+}
+
+// Newton iteration for one time point, starting from x. A circuit without
+// transistors is linear and takes a single solve; with an unchanged matrix it
+// also reuses the previous factorization.
+bool Simulator::solve_point(Mode mode, double t, double h, double gmin, std::vector<double>& x,
+                            int max_iterations, int& iterations) {
+    assemble_linear(mode, h, gmin);
+    assemble_rhs(mode, t, h, rhs_base);
+
+    for (iterations = 1; iterations <= max_iterations; ++iterations) {
+        rhs = rhs_base;
+        bool limited = false;
+        if (bjts.empty()) {
+            if (!factor_valid) {
+                matrix.values = linear_values;
+                if (!factorize()) return false;
+            }
+        } else {
+            matrix.values = linear_values;
+            stamp_bjts(x, rhs, limited);
+            if (!factorize()) return false;
+        }
+        lu.solve(rhs);
+
+        if (bjts.empty()) {
+            x = rhs;
+            return true;
+        }
+        bool done = !limited && converged(rhs, x);
+        x.swap(rhs);
+        if (done) return true;
+    }
+    error = "Newton iteration did not converge";
+    return false;
+}
+
+bool Simulator::dc_operating_point(DcResult& result) {
+    if (!built && !build()) return false;
+
+    std::vector<double> x(unknowns, 0.0);
+    for (Bjt& q : bjts)
+        q.vbe = q.vbc = 0;
+
+    int iterations = 0;
+    if (unknowns > 0) {
+        bool ok = solve_point(Mode::Dc, 0, 0, options.gmin, x, options.max_dc_iterations, iterations);
+        if (!ok) {
+            // Gmin stepping: start with every node heavily tied to ground and
+            // relax the tie, each solve starting from the previous one.
+            std::fill(x.begin(), x.end(), 0.0);
+            for (Bjt& q : bjts)
+                q.vbe = q.vbc = 0;
+            ok = true;
+            for (double g = 1e-2; ok; g /= 10) {
+                g = std::max(g, options.gmin);
+                int steps = 0;
+                ok = solve_point(Mode::Dc, 0, 0, g, x, options.max_dc_iterations, steps);
+                iterations += steps;
+                if (g == options.gmin) break;
+            }
+        }
+        if (!ok) return false;
+        error.clear();
+    }
+
+    solution = x;
+    result.iterations = iterations;
+    result.net_voltages.assign(netlist.net_count, 0.0);
+    for (uint32_t net = 0; net < netlist.net_count; ++net) {
+        int node = node_of(net);
+        if (node != GROUND) result.net_voltages[net] = x[node];
+    }
+    result.source_currents.clear();
+    for (const auto& s : voltage_sources)
+        result.source_currents.push_back(x[s.k]);
+    return true;
+}
+
+void Simulator::accept_step(double h, const std::vector<double>& x) {
+    auto voltage = [](const std::vector<double>& v, int node) { return node == GROUND ? 0.0 : v[node]; };
+    for (size_t i = 0; i < capacitors.size(); ++i) {
+        const Branch& e = capacitors[i];
+        double v_old = voltage(solution, e.a) - voltage(solution, e.b);
+        double v_new = voltage(x, e.a) - voltage(x, e.b);
+        capacitor_currents[i] = 2.0 * e.value / h * (v_new - v_old) - capacitor_currents[i];
+    }
+    for (size_t i = 0; i < inductors.size(); ++i) {
+        const BranchCurrent& e = inductors[i];
+        inductor_voltages[i] = voltage(x, e.a) - voltage(x, e.b);
+    }
+    solution = x;
+}
+
+bool Simulator::transient(const TransientOptions& topt, TransientResult& result) {
+    if (!(topt.stop_time > 0) || !(topt.step > 0)) {
+        error = "Transient analysis needs a positive stop time and step";
+        return false;
+    }
+    DcResult op;
+    if (!dc_operating_point(op)) return false;
+
+    result = TransientResult{};
+    result.probes = topt.probes;
+    if (result.probes.empty()) {
+        for (uint32_t net = 0; net < netlist.net_count; ++net)
+            result.probes.push_back(net);
+    }
+    std::vector<int> probe_nodes;
+    for (uint32_t net : result.probes) {
+        if (net >= netlist.net_count) {
+            error = "Probe on a net that does not exist";
+            return false;
+        }
+        probe_nodes.push_back(node_of(net));
+    }
+    auto record = [&](double t, const std::vector<double>& x) {
+        result.times.push_back(t);
+        for (int node : probe_nodes)
+            result.values.push_back(node == GROUND ? 0.0 : x[node]);
+    };
+
+    // The operating point has no current through capacitors and no voltage
+    // across inductors.
+    capacitor_currents.assign(capacitors.size(), 0.0);
+    inductor_voltages.assign(inductors.size(), 0.0);
+    record(0, solution);
+
+    // Truncation error is estimated from the third divided difference of
+    // each capacitor voltage and inductor current over the last four points.
+    const size_t state_count = capacitors.size() + inductors.size();
+    auto states = [&](const std::vector<double>& x, std::vector<double>& out) {
+        auto voltage = [&](int node) { return node == GROUND ? 0.0 : x[node]; };
+        out.resize(state_count);
+        size_t s = 0;
+        for (const auto& e : capacitors) out[s++] = voltage(e.a) - voltage(e.b);
+        for (const auto& e : inductors) out[s++] = x[e.k];
+    };
+    std::vector<double> history_t;
+    std::vector<std::vector<double>> history(3);
+    std::vector<double> candidate_states;
+    states(solution, history[0]);
+    history_t.push_back(0);
+
+    const double stop = topt.stop_time;
+    const double max_step = topt.adaptive ? (topt.max_step > 0 ? topt.max_step : stop / 50) : topt.step;
+    const double min_step = stop * 1e-12;
+    double h = std::min(topt.step, max_step);
+    double t = 0;
+    std::vector<double> x;
+
+    while (t < stop * (1 - 1e-12)) {
+        double breakpoint = INF;
+        for (const auto* sources : {&voltage_sources, &current_sources})
+            for (const auto& s : *sources)
+                breakpoint = std::min(breakpoint, s.waveform.next_breakpoint(t));
+        double step = std::min({h, max_step, stop - t});
+        bool at_breakpoint = breakpoint - t <= step * (1 + 1e-9);
+        if (at_breakpoint) step = breakpoint - t;
+
+        x = solution;
+        std::vector<std::pair<double, double>> junctions;
+        for (const Bjt& q : bjts) junctions.emplace_back(q.vbe, q.vbc);
+        int iterations = 0;
+        if (unknowns > 0 && !solve_point(Mode::Transient, t + step, step, options.gmin, x,
+                                          options.max_step_iterations, iterations)) {
+            for (size_t i = 0; i < bjts.size(); ++i)
+                std::tie(bjts[i].vbe, bjts[i].vbc) = junctions[i];
+            ++result.rejected_steps;
+            h = step / 8;
+            if (h < min_step) {
+                error = "Time step too small at t = " + std::to_string(t);
+                return false;
+            }
+            continue;
+        }
+
+        double next_h = topt.step;
+        if (topt.adaptive) {
+            next_h = std::min(step * 2, max_step);
+            if (history_t.size() == 3 && state_count > 0) {
+                states(x, candidate_states);
+                const double t0 = history_t[0], t1 = history_t[1], t2 = history_t[2], t3 = t + step;
+                double ratio = 0;
+                for (size_t s = 0; s < state_count; ++s) {
+                    double y0 = history[0][s], y1 = history[1][s], y2 = history[2][s], y3 = candidate_states[s];
+                    double d01 = (y1 - y0) / (t1 - t0), d12 = (y2 - y1) / (t2 - t1), d23 = (y3 - y2) / (t3 - t2);
+                    double d012 = (d12 - d01) / (t2 - t0), d123 = (d23 - d12) / (t3 - t1);
+                    double d0123 = (d123 - d012) / (t3 - t0);
+                    double lte = std::abs(step * step * step * d0123 / 2);
+                    double tol = options.reltol * std::max(std::abs(y3), std::abs(y2)) +
+                                 (s < capacitors.size() ? options.vntol : options.abstol);
+                    ratio = std::max(ratio, lte / (options.trtol * tol));
+                }
+                double scale = ratio > 0 ? 0.9 * std::cbrt(1 / ratio) : 2.0;
+                if (ratio > 1) {
+                    for (size_t i = 0; i < bjts.size(); ++i)
+                        std::tie(bjts[i].vbe, bjts[i].vbc) = junctions[i];
+                    ++result.rejected_steps;
+                    h = std::max(step * std::max(0.25, scale), min_step);
+                    continue;
+                }
+                next_h = std::min(step * std::min(2.0, scale), max_step);
+            }
+        }
+
+        accept_step(step, x);
+        t = at_breakpoint ? breakpoint : t + step;
+        record(t, solution);
+
+        // Derivatives jump at a breakpoint, so the error history restarts.
+        if (at_breakpoint) {
+            history_t.clear();
+            next_h = std::min(next_h, topt.step);
+        }
+        if (history_t.size() == 3) {
+            history_t.erase(history_t.begin());
+            std::rotate(history.begin(), history.begin() + 1, history.end());
+        }
+        states(solution, history[history_t.size()]);
+        history_t.push_back(t);
+        h = next_h;
+    }
+    return true;
+}
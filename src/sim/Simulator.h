@@ -0,0 +1,201 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+#include "SparseLU.h"
+#include "../core/Netlist.h"
+
+// Time-dependent value of a stimulus, with SPICE's DC, PULSE and SIN shapes.
+struct Waveform {
+    enum Shape { Dc, Pulse, Sine };
+
+    static Waveform dc(double value);
+    static Waveform pulse(double v1, double v2, double delay, double rise, double fall,
+                          double width, double period);
+    static Waveform sine(double offset, double amplitude, double frequency, double delay = 0);
+
+    double at(double t) const;
+    // First corner of the waveform strictly after t, or infinity. Transient
+    // analysis lands a step on each one instead of stepping over it.
+    double next_breakpoint(double t) const;
+
+    Shape shape = Dc;
+    double params[7] = {};
+};
+
+struct SimulationOptions {
+    double reltol = 1e-3;
+    double vntol = 1e-6;      // absolute tolerance on voltages
+    double abstol = 1e-9;     // absolute tolerance on currents
+    double gmin = 1e-12;      // conductance from every node to ground
+    double trtol = 7.0;       // how far truncation error may exceed reltol
+    int max_dc_iterations = 100;
+    int max_step_iterations = 20;
+};
+
+struct DcResult {
+    // Voltage of every net against ground, indexed by net id.
+    std::vector<double> net_voltages;
+    // Current through each voltage source, in the order they were added,
+    // flowing from its positive terminal through the source to the negative.
+    std::vector<double> source_currents;
+    int iterations = 0;
+
+    double voltage(uint32_t net) const { return net_voltages[net]; }
+};
+
+struct TransientOptions {
+    double stop_time = 0;
+    // Output step for fixed stepping, first step for adaptive stepping.
+    double step = 0;
+    // Adaptive stepping picks each step from an estimate of the trapezoidal
+    // rule's truncation error and never exceeds max_step (0: stop_time / 50).
+    bool adaptive = false;
+    double max_step = 0;
+    // Nets to record. Empty records every net, which for large circuits is
+    // net count * steps doubles.
+    std::vector<uint32_t> probes;
+};
+
+struct TransientResult {
+    std::vector<uint32_t> probes;
+    std::vector<double> times;
+    // Row-major: values[step * probes.size() + probe].
+    std::vector<double> values;
+    size_t rejected_steps = 0;
+
+    double voltage(size_t step, size_t probe) const { return values[step * probes.size() + probe]; }
+};
+
+// Modified nodal analysis of a design.
+//
+// Connectivity comes from extract_netlist. Unknowns are the voltages of all
+// nets but ground, plus a branch current per inductor and voltage source.
+// The matrix pattern is fixed when the simulator is built, and each element
+// looks up the positions it stamps once, so assembly is a pass of plain
+// additions. The sparse LU is ordered once and refactored in place while
+// the pattern holds; a linear circuit with a fixed step factors only once.
+//
+// Capacitors and inductors use the trapezoidal rule. Transistors are NPN
+// Ebers-Moll models with the component value as forward gain, solved by
+// Newton iteration with junction voltage limiting.
+class Simulator {
+public:
+    Simulator(const ComponentList& components, const WireList& wires,
+              const SimulationOptions& options = SimulationOptions{});
+    // Uses a netlist already extracted for these components.
+    Simulator(const ComponentList& components, Netlist netlist,
+              const SimulationOptions& options = SimulationOptions{});
+
+    const Netlist& get_netlist() const { return netlist; }
+    uint32_t net_of_pin(size_t component, size_t pin) const {
+        return netlist.pin_nets[netlist.pin_offsets[component] + pin];
+    }
+
+    // Net 0 is ground unless set otherwise.
+    void set_ground(uint32_t net);
+    void add_voltage_source(uint32_t positive, uint32_t negative, const Waveform& waveform);
+    // Drives current from `from` through the source into `to`, as in SPICE.
+    void add_current_source(uint32_t from, uint32_t to, const Waveform& waveform);
+
+    // Maps nets to unknowns and orders the matrix now instead of on the first
+    // analysis, e.g. so copies of the simulator don't each do it again.
+    bool prepare() { return built || build(); }
+
+    // Changes the value of components[component] without rebuilding: the
+    // matrix pattern and ordering are kept and only the numbers are redone.
+    // Fails, leaving the old value, if the value isn't valid for the kind.
+    bool set_component_value(size_t component, double value);
+
+    bool dc_operating_point(DcResult& result);
+    bool transient(const TransientOptions& options, TransientResult& result);
+
+    const std::string& get_error() const { return error; }
+    size_t unknown_count() const { return static_cast<size_t>(unknowns); }
+
+private:
+    static constexpr int GROUND = -1;
+
+    // Elements keep the nets they connect; build() maps those to unknowns
+    // (GROUND for the ground net) and looks up the matrix positions each
+    // element stamps, -1 where the row or column is ground.
+    struct Branch {
+        uint32_t nets[2];
+        double value;
+        int a = GROUND, b = GROUND;
+        int slots[4] = {};       // aa, ab, ba, bb
+    };
+    struct BranchCurrent {
+        uint32_t nets[2];
+        double value;
+        int a = GROUND, b = GROUND, k = GROUND;   // k: the branch current's unknown
+        int slots[5] = {};       // ak, bk, ka, kb, kk
+    };
+    struct Bjt {
+        uint32_t nets[3];        // collector, base, emitter
+        double beta;
+        int nodes[3] = {GROUND, GROUND, GROUND};
+        int slots[3][3] = {};
+        double vbe = 0, vbc = 0;
+    };
+    struct Source {
+        uint32_t nets[2];        // positive, negative
+        Waveform waveform;
+        int a = GROUND, b = GROUND, k = GROUND;   // k: voltage sources only
+        int slots[4] = {};       // ak, bk, ka, kb
+    };
+
+    enum class Mode { Dc, Transient };
+
+    bool build();
+    int node_of(uint32_t net) const;
+    void assemble_linear(Mode mode, double h, double gmin);
+    void assemble_rhs(Mode mode, double t, double h, std::vector<double>& rhs) const;
+    void stamp_bjts(const std::vector<double>& x, std::vector<double>& rhs, bool& limited);
+    bool factorize();
+    bool solve_point(Mode mode, double t, double h, double gmin, std::vector<double>& x,
+                     int max_iterations, int& iterations);
+    bool converged(const std::vector<double>& x, const std::vector<double>& previous) const;
+    void accept_step(double h, const std::vector<double>& x);
+
+    SimulationOptions options;
+    Netlist netlist;
+    uint32_t ground_net = 0;
+    bool built = false;
+    std::string error;
+
+    std::vector<Branch> resistors;
+    std::vector<Branch> capacitors;
+    std::vector<BranchCurrent> inductors;
+    std::vector<Bjt> bjts;
+    std::vector<Source> voltage_sources;
+    std::vector<Source> current_sources;
+    // Kind and position in the element lists of each component.
+    std::vector<std::pair<ComponentKind, uint32_t>> component_elements;
+
+    int nodes = 0;
+    int unknowns = 0;
+    SparseMatrix matrix;
+    std::vector<double> linear_values;
+    std::vector<int> gmin_slots;
+    SparseLU lu;
+    bool factor_valid = false;
+    Mode assembled_mode = Mode::Dc;
+    double assembled_h = -1;
+    double assembled_gmin = -1;
+
+    // Trapezoidal history: capacitor currents and inductor voltages at the
+    // last accepted time point.
+    std::vector<double> capacitor_currents;
+    std::vector<double> inductor_voltages;
+    std::vector<double> solution;
+    std::vector<double> rhs_base;
+    std::vector<double> rhs;
+};
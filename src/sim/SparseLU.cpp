@@ -0,0 +1,369 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "SparseLU.h"
+#include <cmath>
+#include <queue>
+
+namespace {
+
+// Approximate minimum degree order of the graph of A + A^T.
+//
+// Eliminating a vertex joins its neighbours into a clique, which is the fill
+// LU creates with diagonal pivots; picking the vertex of smallest degree each
+// time keeps that fill low. The cliques are not formed explicitly: each
+// eliminated vertex becomes an "element" holding its neighbour list, and a
+// variable's neighbours are its remaining variable neighbours plus the
+// members of its elements (a quotient graph). Elements that become subsets
+// of a newer one are absorbed. Exact degrees would cost a set union per
+// update, so the bound from Amestoy, Davis and Duff is used instead.
+std::vector<int> minimum_degree_order(const SparseMatrix& a) {
+    const int n = a.n;
+    std::vector<std::vector<int>> vars(n);      // variable neighbours of each variable
+    std::vector<std::vector<int>> elems(n);     // elements each variable belongs to
+    std::vector<std::vector<int>> members(n);   // variables of each element
+    for (int c = 0; c < n; ++c) {
+        for (int p = a.col_ptr[c]; p < a.col_ptr[c + 1]; ++p) {
+            int r = a.row_idx[p];
+            if (r == c) continue;
+            vars[r].push_back(c);
+            vars[c].push_back(r);
+        }
+    }
+
+    // Degree buckets as intrusive doubly linked lists.
+    std::vector<int> degree(n), head(n, -1), next(n, -1), prev(n, -1);
+    auto unlink = [&](int i) {
+        if (prev[i] >= 0) next[prev[i]] = next[i];
+        else head[degree[i]] = next[i];
+        if (next[i] >= 0) prev[next[i]] = prev[i];
+    };
+    auto link = [&](int i) {
+        prev[i] = -1;
+        next[i] = head[degree[i]];
+        if (next[i] >= 0) prev[next[i]] = i;
+        head[degree[i]] = i;
+    };
+    for (int v = 0; v < n; ++v) {
+        std::sort(vars[v].begin(), vars[v].end());
+        vars[v].erase(std::unique(vars[v].begin(), vars[v].end()), vars[v].end());
+        degree[v] = static_cast<int>(vars[v].size());
+        link(v);
+    }
+
+    enum : char { Variable, Element, Absorbed };
+    std::vector<char> state(n, Variable);
+    std::vector<int> in_pivot(n, -1);       // == p while a variable is in the current pivot's list
+    std::vector<int> outside(n, 0);         // |members(e) \ pivot list| for elements touched this step
+    std::vector<int> outside_stamp(n, -1);
+    std::vector<int> order;
+    order.reserve(n);
+
+    int min_degree = 0;
+    for (int remaining = n; remaining > 0; --remaining) {
+        while (head[min_degree] < 0) ++min_degree;
+        const int p = head[min_degree];
+        unlink(p);
+        order.push_back(p);
+
+        // The new element's members: p's variable neighbours plus the
+        // members of every element p belonged to, which p now absorbs.
+        std::vector<int>& pivot_list = members[p];
+        pivot_list.clear();
+        in_pivot[p] = p;
+        auto add = [&](int i) {
+            if (state[i] == Variable && in_pivot[i] != p) {
+                in_pivot[i] = p;
+                pivot_list.push_back(i);
+            }
+        };
+        for (int i : vars[p]) add(i);
+        for (int e : elems[p]) {
+            for (int i : members[e]) add(i);
+            state[e] = Absorbed;
+            std::vector<int>().swap(members[e]);
+        }
+        state[p] = Element;
+        std::vector<int>().swap(vars[p]);
+        std::vector<int>().swap(elems[p]);
+
+        // |members(e) \ pivot list| for every element next to the pivot list.
+        for (int i : pivot_list) {
+            for (int e : elems[i]) {
+                if (state[e] != Element) continue;
+                if (outside_stamp[e] != p) {
+                    outside_stamp[e] = p;
+                    outside[e] = static_cast<int>(members[e].size());
+                }
+                --outside[e];
+            }
+        }
+
+        const int pivot_size = static_cast<int>(pivot_list.size());
+        for (int i : pivot_list) {
+            unlink(i);
+
+            // Drop absorbed elements and elements now contained in p.
+            int external = 0;
+            auto& ie = elems[i];
+            size_t keep = 0;
+            for (int e : ie) {
+                if (state[e] != Element) continue;
+                if (outside[e] == 0 && outside_stamp[e] == p) {
+                    state[e] = Absorbed;
+                    std::vector<int>().swap(members[e]);
+                    continue;
+                }
+                external += outside[e];
+                ie[keep++] = e;
+            }
+            ie.resize(keep);
+            ie.push_back(p);
+
+            // Variable neighbours reachable through p are no longer listed.
+            auto& iv = vars[i];
+            keep = 0;
+            for (int j : iv) {
+                if (state[j] == Variable && in_pivot[j] != p) iv[keep++] = j;
+            }
+            iv.resize(keep);
+
+            int bound = std::min(degree[i] + pivot_size - 1,
+                                 static_cast<int>(iv.size()) + pivot_size - 1 + external);
+            degree[i] = std::max(0, std::min(remaining - 2, bound));
+            link(i);
+            min_degree = std::min(min_degree, degree[i]);
+        }
+    }
+    return order;
+}
+
+}
+
+void SparseLU::analyze(const SparseMatrix& a) {
+    n = a.n;
+    order = minimum_degree_order(a);
+    pivot_of.assign(n, -1);
+    l_ptr.clear();
+    u_ptr.clear();
+}
+
+// Rows of L (in A's row numbering) that L \ A(:, col) can make nonzero, in
+// topological order, as reach_out[top .. n).
+int SparseLU::reach(const SparseMatrix& a, int col) {
+    if (++visit_stamp == 0) {
+        std::fill(visited.begin(), visited.end(), 0u);
+        visit_stamp = 1;
+    }
+
+    int top = n;
+    for (int p = a.col_ptr[col]; p < a.col_ptr[col + 1]; ++p) {
+        int start = a.row_idx[p];
+        if (visited[start] == visit_stamp) continue;
+
+        // Iterative depth-first search through the columns of L.
+        int head = 0;
+        dfs_stack[0] = start;
+        while (head >= 0) {
+            int j = dfs_stack[head];
+            int jcol = pivot_of[j];
+            if (visited[j] != visit_stamp) {
+                visited[j] = visit_stamp;
+                dfs_pos[head] = jcol < 0 ? 0 : l_ptr[jcol];
+            }
+            bool done = true;
+            int end = jcol < 0 ? 0 : l_ptr[jcol + 1];
+            for (int q = dfs_pos[head]; q < end; ++q) {
+                int i = l_idx[q];
+                if (visited[i] == visit_stamp) continue;
+                dfs_pos[head] = q;
+                dfs_stack[++head] = i;
+                done = false;
+                break;
+            }
+            if (done) {
+                --head;
+                reach_out[--top] = j;
+            }
+        }
+    }
+    return top;
+}
+
+bool SparseLU::factor(const SparseMatrix& a) {
+    if (!is_analyzed() || a.n != n) analyze(a);
+
+    work.assign(n, 0.0);
+    reach_out.assign(n, 0);
+    dfs_stack.assign(n, 0);
+    dfs_pos.assign(n, 0);
+    visited.assign(n, 0u);
+    visit_stamp = 0;
+    pivot_of.assign(n, -1);
+    singular = -1;
+
+    l_ptr.assign(n + 1, 0);
+    u_ptr.assign(n + 1, 0);
+    l_idx.clear();
+    l_val.clear();
+    u_idx.clear();
+    u_val.clear();
+    l_idx.reserve(a.nonzeros() * 2);
+    l_val.reserve(a.nonzeros() * 2);
+    u_idx.reserve(a.nonzeros() * 2);
+    u_val.reserve(a.nonzeros() * 2);
+
+    for (int k = 0; k < n; ++k) {
+        l_ptr[k] = static_cast<int>(l_idx.size());
+        u_ptr[k] = static_cast<int>(u_idx.size());
+        const int col = order[k];
+
+        // work = L \ A(:, col) over the reachable rows.
+        int top = reach(a, col);
+        double scale = 0.0;
+        for (int p = a.col_ptr[col]; p < a.col_ptr[col + 1]; ++p) {
+            work[a.row_idx[p]] = a.values[p];
+            scale = std::max(scale, std::abs(a.values[p]));
+        }
+        for (int px = top; px < n; ++px) {
+            int j = reach_out[px];
+            int jcol = pivot_of[j];
+            if (jcol < 0) continue;
+            double xj = work[j];
+            for (int q = l_ptr[jcol] + 1; q < l_ptr[jcol + 1]; ++q)
+                work[l_idx[q]] -= l_val[q] * xj;
+        }
+
+        // Rows already pivotal go to U; pick the pivot among the rest.
+        int pivot_row = -1;
+        double largest = 0.0;
+        for (int px = top; px < n; ++px) {
+            int i = reach_out[px];
+            if (pivot_of[i] < 0) {
+                double t = std::abs(work[i]);
+                if (t > largest || pivot_row < 0) {
+                    largest = t;
+                    pivot_row = i;
+                }
+            } else {
+                u_idx.push_back(pivot_of[i]);
+                u_val.push_back(work[i]);
+                scale = std::max(scale, std::abs(work[i]));
+            }
+        }
+        if (pivot_row < 0 || !std::isfinite(largest) || !(largest > SINGULAR_TOLERANCE * scale)) {
+            // Structurally or numerically singular; leave nothing to refactor from.
+            std::fill(work.begin(), work.end(), 0.0);
+            l_ptr.clear();
+            u_ptr.clear();
+            singular = col;
+            return false;
+        }
+        if (pivot_of[col] < 0 && std::abs(work[col]) >= PIVOT_TOLERANCE * largest)
+            pivot_row = col;
+
+        double pivot = work[pivot_row];
+        u_idx.push_back(k);
+        u_val.push_back(pivot);
+        pivot_of[pivot_row] = k;
+        l_idx.push_back(pivot_row);
+        l_val.push_back(1.0);
+        for (int px = top; px < n; ++px) {
+            int i = reach_out[px];
+            if (pivot_of[i] < 0) {
+                l_idx.push_back(i);
+                l_val.push_back(work[i] / pivot);
+            }
+            work[i] = 0.0;
+        }
+    }
+    l_ptr[n] = static_cast<int>(l_idx.size());
+    u_ptr[n] = static_cast<int>(u_idx.size());
+
+    // Renumber L's rows into pivot order and sort U's columns so refactor()
+    // can eliminate in ascending row order.
+    for (int& i : l_idx)
+        i = pivot_of[i];
+    std::vector<std::pair<int, double>> column;
+    for (int k = 0; k < n; ++k) {
+        column.clear();
+        for (int p = u_ptr[k]; p < u_ptr[k + 1]; ++p)
+            column.emplace_back(u_idx[p], u_val[p]);
+        std::sort(column.begin(), column.end());
+        for (int p = u_ptr[k], c = 0; p < u_ptr[k + 1]; ++p, ++c) {
+            u_idx[p] = column[c].first;
+            u_val[p] = column[c].second;
+        }
+    }
+    return true;
+}
+
+bool SparseLU::refactor(const SparseMatrix& a) {
+    if (a.n != n || static_cast<int>(l_ptr.size()) != n + 1) return false;
+
+    std::vector<double>& x = work;
+    for (int k = 0; k < n; ++k) {
+        const int col = order[k];
+        double scale = 0.0;
+        for (int p = a.col_ptr[col]; p < a.col_ptr[col + 1]; ++p) {
+            x[pivot_of[a.row_idx[p]]] = a.values[p];
+            scale = std::max(scale, std::abs(a.values[p]));
+        }
+
+        const int u_diag = u_ptr[k + 1] - 1;
+        for (int p = u_ptr[k]; p < u_diag; ++p) {
+            int j = u_idx[p];
+            double xj = x[j];
+            u_val[p] = xj;
+            scale = std::max(scale, std::abs(xj));
+            x[j] = 0.0;
+            for (int q = l_ptr[j] + 1; q < l_ptr[j + 1]; ++q)
+                x[l_idx[q]] -= l_val[q] * xj;
+        }
+
+        double pivot = x[k];
+        x[k] = 0.0;
+        double largest = std::abs(pivot);
+        for (int q = l_ptr[k] + 1; q < l_ptr[k + 1]; ++q)
+            largest = std::max(largest, std::abs(x[l_idx[q]]));
+
+        if (!std::isfinite(pivot) || std::abs(pivot) < PIVOT_TOLERANCE * largest ||
+            !(std::abs(pivot) > SINGULAR_TOLERANCE * std::max(scale, largest))) {
+            std::fill(x.begin(), x.end(), 0.0);
+            return false;
+        }
+        u_val[u_diag] = pivot;
+        for (int q = l_ptr[k] + 1; q < l_ptr[k + 1]; ++q) {
+            l_val[q] = x[l_idx[q]] / pivot;
+            x[l_idx[q]] = 0.0;
+        }
+    }
+    return true;
+}
+
+void SparseLU::solve(std::vector<double>& b) const {
+    std::vector<double>& y = solve_work;
+    y.resize(n);
+    for (int i = 0; i < n; ++i)
+        y[pivot_of[i]] = b[i];
+
+    for (int k = 0; k < n; ++k) {
+        double yk = y[k];
+        if (yk == 0.0) continue;
+        for (int p = l_ptr[k] + 1; p < l_ptr[k + 1]; ++p)
+            y[l_idx[p]] -= l_val[p] * yk;
+    }
+    for (int k = n - 1; k >= 0; --k) {
+        const int u_diag = u_ptr[k + 1] - 1;
+        double yk = y[k] / u_val[u_diag];
+        y[k] = yk;
+        if (yk == 0.0) continue;
+        for (int p = u_ptr[k]; p < u_diag; ++p)
+            y[u_idx[p]] -= u_val[p] * yk;
+    }
+
+    for (int k = 0; k < n; ++k)
+        b[order[k]] = y[k];
+}
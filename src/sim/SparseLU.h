@@ -0,0 +1,65 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <vector>
+#include "SparseMatrix.h"
+
+// Sparse LU factorization P A Q = L U for circuit matrices.
+//
+// analyze() picks a fill-reducing column order Q by minimum degree on the
+// pattern of A + A^T. factor() is a left-looking (Gilbert-Peierls) LU with
+// threshold partial pivoting that prefers the diagonal, so the symmetric
+// order is mostly kept. refactor() reuses the pivot order and the L and U
+// patterns of the last factor() for a matrix with the same pattern and new
+// values, skipping all symbolic work; it fails if a reused pivot has become
+// too small, and the caller falls back to factor(). Both fail on a matrix
+// that is singular to working precision.
+class SparseLU {
+public:
+    void analyze(const SparseMatrix& a);
+    bool factor(const SparseMatrix& a);
+    bool refactor(const SparseMatrix& a);
+
+    // Solves A x = b in place. Requires a successful factor() or refactor().
+    void solve(std::vector<double>& b) const;
+
+    bool is_analyzed() const { return n > 0 && static_cast<int>(order.size()) == n; }
+    size_t factor_nonzeros() const { return l_idx.size() + u_idx.size(); }
+    // Column of A with no usable pivot after a failed factor(), or -1.
+    int singular_column() const { return singular; }
+
+    // A pivot is accepted if it is at least this fraction of the largest
+    // candidate in its column.
+    static constexpr double PIVOT_TOLERANCE = 1e-3;
+    // A column whose best pivot is below this fraction of the largest value
+    // in it, before or during elimination, is taken as dependent on the
+    // columns before it: what is left is rounding error.
+    static constexpr double SINGULAR_TOLERANCE = 1e-12;
+
+private:
+    int reach(const SparseMatrix& a, int col);
+
+    int n = 0;
+    int singular = -1;
+    std::vector<int> order;       // Q: column k of the factors is column order[k] of A
+    std::vector<int> pivot_of;    // P: pivot_of[row] is the pivot position of row
+
+    // L is unit lower triangular with its diagonal stored first in each
+    // column; U keeps its diagonal last, rows ascending.
+    std::vector<int> l_ptr, l_idx;
+    std::vector<double> l_val;
+    std::vector<int> u_ptr, u_idx;
+    std::vector<double> u_val;
+
+    // Workspace for factor(): dense accumulator, reach output and DFS stack.
+    std::vector<double> work;
+    std::vector<int> reach_out;
+    std::vector<int> dfs_stack;
+    std::vector<int> dfs_pos;
+    std::vector<unsigned> visited;
+    unsigned visit_stamp = 0;
+    mutable std::vector<double> solve_work;
+};
@@ -0,0 +1,51 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// Square matrix in compressed sparse column form. The pattern is fixed once
+// built; callers look up the position of each entry they stamp once and then
+// write values[position] directly.
+struct SparseMatrix {
+    int n = 0;
+    std::vector<int> col_ptr;   // n + 1 entries
+    std::vector<int> row_idx;   // sorted within each column
+    std::vector<double> values;
+
+    size_t nonzeros() const { return row_idx.size(); }
+
+    // Position of (row, col) in values, or -1 if it is not in the pattern.
+    int find(int row, int col) const {
+        auto begin = row_idx.begin() + col_ptr[col];
+        auto end = row_idx.begin() + col_ptr[col + 1];
+        auto it = std::lower_bound(begin, end, row);
+        return it != end && *it == row ? static_cast<int>(it - row_idx.begin()) : -1;
+    }
+
+    // Builds the pattern from (row, col) pairs, duplicates allowed, with all
+    // values zero.
+    static SparseMatrix from_entries(int n, std::vector<std::pair<int, int>> entries) {
+        std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second < b.second : a.first < b.first;
+        });
+        entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+        SparseMatrix m;
+        m.n = n;
+        m.col_ptr.assign(n + 1, 0);
+        m.row_idx.reserve(entries.size());
+        for (const auto& [row, col] : entries) {
+            m.row_idx.push_back(row);
+            ++m.col_ptr[col + 1];
+        }
+        for (int c = 0; c < n; ++c)
+            m.col_ptr[c + 1] += m.col_ptr[c];
+        m.values.assign(entries.size(), 0.0);
+        return m;
+    }
+};
@@ -0,0 +1,437 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "Sweep.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <utility>
+#include "../util/ThreadPool.h"
+
+namespace {
+
+// Small, fast generator so every run can seed its own from (seed, run).
+struct SplitMix64 {
+    uint64_t state;
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, 1).
+    double uniform() { return (next() >> 11) * 0x1.0p-53; }
+
+    double gaussian() {
+        double u1 = 1.0 - uniform();
+        double u2 = uniform();
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(2 * M_PI * u2);
+    }
+};
+
+// Net count and pins left hanging on a net of their own.
+void connectivity(const Netlist& netlist, uint32_t& nets, uint32_t& dangling) {
+    const std::vector<bool> pins = find_dangling_pins(netlist);
+    nets = static_cast<uint32_t>(netlist.net_count);
+    dangling = static_cast<uint32_t>(std::count(pins.begin(), pins.end(), true));
+}
+
+const char* status_name(SweepStatus status) {
+    switch (status) {
+        case SweepStatus::Ok: return "ok";
+        case SweepStatus::InvalidValue: return "invalid_value";
+        case SweepStatus::SolveFailed: return "solve_failed";
+    }
+    return "unknown";
+}
+
+}
+
+uint64_t SweepPlan::run_count() const {
+    uint64_t count = samples;
+    for (const auto& s : value_sweeps) count *= s.steps;
+    for (const auto& p : placements) count *= p.alternatives.size() + 1;
+    return count;
+}
+
+void ProbeStats::add(double v) {
+    ++count;
+    double delta = v - mean;
+    mean += delta / count;
+    m2 += delta * (v - mean);
+    min = std::min(min, v);
+    max = std::max(max, v);
+}
+
+// Chan et al.'s pairwise combination of two Welford accumulators.
+void ProbeStats::merge(const ProbeStats& other) {
+    if (other.count == 0) return;
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+    uint64_t total = count + other.count;
+    double delta = other.mean - mean;
+    mean += delta * other.count / total;
+    m2 += other.m2 + delta * delta * (static_cast<double>(count) * other.count / total);
+    count = total;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+}
+
+double ProbeStats::stddev() const {
+    return count > 1 ? std::sqrt(m2 / (count - 1)) : 0.0;
+}
+
+bool SweepWriter::open(const std::string& filename, Format fmt, const std::vector<std::string>& names,
+                       uint64_t runs) {
+    close();
+    format = fmt;
+    columns = names.size();
+    if (filename == "-") {
+        file = stdout;
+        owns_file = false;
+    } else {
+        file = std::fopen(filename.c_str(), fmt == Format::Binary ? "wb" : "w");
+        owns_file = true;
+        if (!file) return false;
+    }
+
+    if (format == Format::Csv) {
+        std::fputs("run,status,nets,dangling_pins,iterations", file);
+        for (const auto& name : names) std::fprintf(file, ",%s", name.c_str());
+        std::fputc('\n', file);
+    } else {
+        SweepFileHeader header{};
+        std::memcpy(header.magic, SWEEP_FILE_MAGIC, sizeof(header.magic));
+        header.version = SWEEP_FILE_VERSION;
+        header.columns = static_cast<uint32_t>(columns);
+        header.runs = runs;
+        std::fwrite(&header, sizeof(header), 1, file);
+        for (const auto& name : names) std::fwrite(name.c_str(), 1, name.size() + 1, file);
+    }
+    return std::ferror(file) == 0;
+}
+
+bool SweepWriter::write(const SweepChunk& chunk) {
+    if (!file) return false;
+    const double* values = chunk.values.data();
+
+    if (format == Format::Binary) {
+        for (const SweepRow& row : chunk.rows) {
+            SweepRecord r{};
+            r.run = row.run;
+            r.status = static_cast<uint8_t>(row.status);
+            r.nets = row.nets;
+            r.dangling_pins = row.dangling_pins;
+            r.iterations = row.iterations;
+            std::fwrite(&r, sizeof(r), 1, file);
+            std::fwrite(values, sizeof(double), columns, file);
+            values += columns;
+        }
+        return std::ferror(file) == 0;
+    }
+
+    // Format the chunk into one buffer and write it in a single call.
+    std::string out;
+    out.reserve(chunk.rows.size() * (48 + columns * 16));
+    char buf[64];
+    for (const SweepRow& row : chunk.rows) {
+        int n = std::snprintf(buf, sizeof(buf), "%llu,%s,%u,%u,%u", static_cast<unsigned long long>(row.run),
+                              status_name(row.status), row.nets, row.dangling_pins, row.iterations);
+        out.append(buf, n);
+        for (size_t c = 0; c < columns; ++c) {
+            n = std::snprintf(buf, sizeof(buf), ",%.9g", *values++);
+            out.append(buf, n);
+        }
+        out += '\n';
+    }
+    std::fwrite(out.data(), 1, out.size(), file);
+    return std::ferror(file) == 0;
+}
+
+bool SweepWriter::close() {
+    if (!file) return true;
+    bool ok = std::fflush(file) == 0 && std::ferror(file) == 0;
+    if (owns_file) ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
+
+// Per-thread state. The simulator and connectivity belong to the placement
+// combination of the last run, which the next run usually shares.
+struct Sweep::Worker {
+    bool ready = false;
+    uint64_t placement = 0;
+    std::unique_ptr<Simulator> simulator;
+    uint32_t nets = 0, dangling = 0;
+    std::vector<uint32_t> probe_nets;
+
+    std::vector<ComponentOverride> overrides;
+    std::vector<uint32_t> changed;
+    DcResult dc;
+
+    std::vector<ProbeStats> stats;
+    uint64_t runs = 0, failed = 0;
+};
+
+Sweep::Sweep(ComponentList components_, WireList wires_, SweepPlan plan_, const SimulationOptions& options)
+    : components(std::move(components_)), wires(std::move(wires_)), plan(std::move(plan_)), options(options) {
+    names = component_designators(components);
+    base_netlist = extract_netlist(components, wires);
+
+    auto check_pin = [&](const PinRef& p) {
+        return p.component < components.size() &&
+               p.pin < base_netlist.pin_offsets[p.component + 1] - base_netlist.pin_offsets[p.component];
+    };
+    if (plan.samples == 0) error = "Sweep needs at least one sample";
+    for (const auto& t : plan.tolerances)
+        if (!(t.relative >= 0)) error = "Negative tolerance";
+    for (const auto& s : plan.value_sweeps) {
+        if (s.component >= components.size()) error = "Swept component does not exist";
+        else if (s.steps == 0) error = "Value sweep needs at least one step";
+        else if (s.logarithmic && !(s.from > 0 && s.to > 0)) error = "Logarithmic sweep needs positive bounds";
+    }
+    for (const auto& p : plan.placements)
+        if (p.component >= components.size()) error = "Placed component does not exist";
+    if (plan.has_source && (!check_pin(plan.source_positive) || !check_pin(plan.source_negative)))
+        error = "Source pin does not exist";
+    for (const auto& p : plan.probes) {
+        if (!check_pin(p)) error = "Probe pin does not exist";
+        else if (!plan.has_source) error = "Probes need a source";
+    }
+}
+
+std::vector<std::string> Sweep::columns() const {
+    std::vector<std::string> out;
+    for (const auto& s : plan.value_sweeps) out.push_back(names[s.component]);
+    for (const auto& p : plan.placements) out.push_back(names[p.component] + ".placement");
+    for (const auto& p : plan.probes) {
+        const Pin& pin = base_netlist.pins[base_netlist.pin_offsets[p.component] + p.pin];
+        out.push_back("V(" + names[p.component] + "." + pin.name + ")");
+    }
+    return out;
+}
+
+void Sweep::decode(uint64_t run, uint64_t& sample, uint64_t& point, uint64_t& placement) const {
+    uint64_t points = 1;
+    for (const auto& s : plan.value_sweeps) points *= s.steps;
+    sample = run % plan.samples;
+    point = run / plan.samples % points;
+    placement = run / plan.samples / points;
+}
+
+double Sweep::swept_value(size_t sweep, uint64_t point) const {
+    for (size_t i = 0; i < sweep; ++i) point /= plan.value_sweeps[i].steps;
+    const auto& s = plan.value_sweeps[sweep];
+    uint64_t step = point % s.steps;
+    if (s.steps == 1) return s.from;
+    double f = static_cast<double>(step) / (s.steps - 1);
+    return s.logarithmic ? s.from * std::pow(s.to / s.from, f) : s.from + (s.to - s.from) * f;
+}
+
+size_t Sweep::placement_index(size_t placement, uint64_t combination) const {
+    for (size_t i = 0; i < placement; ++i) combination /= plan.placements[i].alternatives.size() + 1;
+    return combination % (plan.placements[placement].alternatives.size() + 1);
+}
+
+void Sweep::variant(uint64_t run, std::vector<ComponentOverride>& out) const {
+    out.clear();
+    uint64_t sample, point, placement;
+    decode(run, sample, point, placement);
+
+    for (size_t i = 0; i < plan.value_sweeps.size(); ++i)
+        out.push_back({plan.value_sweeps[i].component, ComponentOverride::Value, swept_value(i, point)});
+
+    if (!plan.tolerances.empty()) {
+        SplitMix64 rng{plan.seed ^ (run * 0xd1342543de82ef95ULL)};
+        const size_t swept = out.size();
+        for (uint32_t c = 0; c < components.size(); ++c) {
+            const ComponentKind kind = components[c]->get_kind();
+            auto t = std::find_if(plan.tolerances.begin(), plan.tolerances.end(),
+                                  [&](const SweepPlan::Tolerance& t) { return t.kind == kind; });
+            if (t == plan.tolerances.end()) continue;
+
+            double factor = t->gaussian ? 1 + t->relative / 3 * rng.gaussian()
+                                        : 1 + t->relative * (2 * rng.uniform() - 1);
+            auto own = std::find_if(out.begin(), out.begin() + swept,
+                                    [&](const ComponentOverride& o) { return o.component == c; });
+            if (own != out.begin() + swept) own->value *= factor;
+            else out.push_back({c, ComponentOverride::Value, components[c]->value * factor});
+        }
+    }
+
+    for (size_t i = 0; i < plan.placements.size(); ++i) {
+        size_t index = placement_index(i, placement);
+        if (index == 0) continue;
+        const auto& p = plan.placements[i];
+        const auto& pos = p.alternatives[index - 1];
+        out.push_back({p.component, ComponentOverride::X, pos.x});
+        out.push_back({p.component, ComponentOverride::Y, pos.y});
+        out.push_back({p.component, ComponentOverride::Rotation, pos.rotation});
+    }
+}
+
+void Sweep::prepare(Worker& worker, uint64_t placement) const {
+    if (worker.ready && worker.placement == placement) return;
+    worker.ready = true;
+    worker.placement = placement;
+
+    const Netlist* netlist = &base_netlist;
+    Netlist moved;
+    if (placement == 0) {
+        worker.simulator = std::make_unique<Simulator>(*prototype);
+    } else {
+        // Only the pins of moved parts change; wires and everything else
+        // come from the base design.
+        std::vector<Pin> pins = base_netlist.pins;
+        Pin buffer[CircuitComponent::MAX_PINS];
+        for (size_t i = 0; i < plan.placements.size(); ++i) {
+            size_t index = placement_index(i, placement);
+            if (index == 0) continue;
+            const auto& p = plan.placements[i];
+            const auto& pos = p.alternatives[index - 1];
+            const auto& comp = components[p.component];
+            auto copy = CircuitComponent::create(comp->get_kind(), pos.x, pos.y, comp->width, comp->height);
+            copy->set_rotation(pos.rotation);
+            size_t count = copy->get_pins(buffer);
+            std::copy(buffer, buffer + count, pins.begin() + base_netlist.pin_offsets[p.component]);
+        }
+        moved = extract_netlist(base_netlist.pin_offsets, std::move(pins), wires);
+        netlist = &moved;
+
+        worker.simulator = std::make_unique<Simulator>(components, moved, options);
+        if (plan.has_source) {
+            uint32_t ground = worker.simulator->net_of_pin(plan.source_negative.component, plan.source_negative.pin);
+            worker.simulator->set_ground(ground);
+            worker.simulator->add_voltage_source(
+                worker.simulator->net_of_pin(plan.source_positive.component, plan.source_positive.pin),
+                ground, Waveform::dc(plan.source_voltage));
+        }
+        worker.simulator->prepare();
+    }
+
+    connectivity(*netlist, worker.nets, worker.dangling);
+    worker.probe_nets.clear();
+    for (const PinRef& p : plan.probes)
+        worker.probe_nets.push_back(worker.simulator->net_of_pin(p.component, p.pin));
+}
+
+void Sweep::evaluate(Worker& worker, uint64_t run, SweepRow& row, double* values) const {
+    uint64_t sample, point, placement;
+    decode(run, sample, point, placement);
+    prepare(worker, placement);
+    variant(run, worker.overrides);
+
+    for (size_t i = 0; i < plan.value_sweeps.size(); ++i)
+        *values++ = swept_value(i, point);
+    for (size_t i = 0; i < plan.placements.size(); ++i)
+        *values++ = static_cast<double>(placement_index(i, placement));
+
+    row.run = run;
+    row.status = SweepStatus::Ok;
+    row.nets = worker.nets;
+    row.dangling_pins = worker.dangling;
+    row.iterations = 0;
+
+    Simulator& sim = *worker.simulator;
+    worker.changed.clear();
+    for (const ComponentOverride& o : worker.overrides) {
+        if (o.field != ComponentOverride::Value) continue;
+        if (!sim.set_component_value(o.component, o.value)) {
+            row.status = SweepStatus::InvalidValue;
+            break;
+        }
+        worker.changed.push_back(o.component);
+    }
+
+    if (row.status == SweepStatus::Ok && plan.has_source) {
+        if (sim.dc_operating_point(worker.dc)) row.iterations = worker.dc.iterations;
+        else row.status = SweepStatus::SolveFailed;
+    }
+
+    const bool solved = row.status == SweepStatus::Ok;
+    for (size_t i = 0; i < worker.probe_nets.size(); ++i) {
+        values[i] = solved ? worker.dc.voltage(worker.probe_nets[i]) : std::nan("");
+        if (solved) worker.stats[i].add(values[i]);
+    }
+    ++worker.runs;
+    if (!solved) ++worker.failed;
+
+    // Put the shared topology back the way the next run expects it.
+    for (uint32_t c : worker.changed)
+        sim.set_component_value(c, components[c]->value);
+}
+
+bool Sweep::run(ThreadPool& pool, SweepWriter* writer, SweepSummary& summary, size_t chunk_size) {
+    summary = SweepSummary{};
+    if (!error.empty()) return false;
+    auto start = std::chrono::steady_clock::now();
+
+    prototype = std::make_unique<Simulator>(components, base_netlist, options);
+    if (plan.has_source) {
+        uint32_t ground = prototype->net_of_pin(plan.source_negative.component, plan.source_negative.pin);
+        prototype->set_ground(ground);
+        prototype->add_voltage_source(prototype->net_of_pin(plan.source_positive.component, plan.source_positive.pin),
+                                      ground, Waveform::dc(plan.source_voltage));
+    }
+    prototype->prepare();
+
+    const uint64_t total = plan.run_count();
+    const size_t width = columns().size();
+    chunk_size = std::max<size_t>(chunk_size, 1);
+    const uint64_t chunks = (total + chunk_size - 1) / chunk_size;
+
+    std::vector<Worker> workers(pool.size() + 1);
+    for (Worker& w : workers) w.stats.resize(plan.probes.size());
+
+    // Chunks finish out of order; hold them until the next one in line is
+    // done so the output stays sorted by run.
+    std::mutex output_mutex;
+    std::map<uint64_t, SweepChunk> finished;
+    uint64_t next_chunk = 0;
+    bool write_failed = false;
+
+    pool.parallel_for(chunks, 1, [&](size_t begin, size_t end) {
+        Worker& worker = workers[pool.current_worker()];
+        for (size_t c = begin; c < end; ++c) {
+            const uint64_t first = c * chunk_size;
+            const uint64_t count = std::min<uint64_t>(chunk_size, total - first);
+            SweepChunk chunk;
+            chunk.rows.resize(count);
+            chunk.values.resize(count * width);
+            for (uint64_t i = 0; i < count; ++i)
+                evaluate(worker, first + i, chunk.rows[i], chunk.values.data() + i * width);
+
+            if (!writer) continue;
+            std::lock_guard<std::mutex> lock(output_mutex);
+            finished.emplace(c, std::move(chunk));
+            for (auto it = finished.begin(); it != finished.end() && it->first == next_chunk;
+                 it = finished.erase(it), ++next_chunk) {
+                if (!write_failed && !writer->write(it->second)) write_failed = true;
+            }
+        }
+    });
+
+    summary.probes.resize(plan.probes.size());
+    for (const Worker& w : workers) {
+        summary.runs += w.runs;
+        summary.failed += w.failed;
+        for (size_t i = 0; i < w.stats.size(); ++i)
+            summary.probes[i].merge(w.stats[i]);
+    }
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (write_failed) {
+        error = "Failed to write sweep results";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,202 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Simulator.h"
+
+class ThreadPool;
+
+// A pin of one component, e.g. the base of Q1. Sweeps refer to pins rather
+// than nets because moving a part can renumber the nets.
+struct PinRef {
+    uint32_t component;
+    uint32_t pin;
+};
+
+// Change to one field of one component for a single run.
+struct ComponentOverride {
+    enum Field : uint8_t { Value, X, Y, Rotation };
+
+    uint32_t component;
+    Field field;
+    double value;
+};
+
+// What to vary and what to measure. Runs enumerate the Monte Carlo sample
+// fastest, then the value steps, then the placements, so consecutive runs
+// share a topology.
+struct SweepPlan {
+    // Scales each component of a kind by a random factor in 1 +/- relative
+    // (uniform), or with relative as three standard deviations (gaussian).
+    struct Tolerance {
+        ComponentKind kind;
+        double relative;
+        bool gaussian = false;
+    };
+    // Steps a component's value from `from` to `to` inclusive.
+    struct ValueSweep {
+        uint32_t component;
+        double from, to;
+        uint32_t steps;
+        bool logarithmic = false;
+    };
+    // Positions to try a component at besides its own, which is placement
+    // index 0; alternatives[i] is placement index i + 1.
+    struct Placement {
+        uint32_t component;
+        struct Position { double x, y, rotation; };
+        std::vector<Position> alternatives;
+    };
+
+    std::vector<Tolerance> tolerances;
+    std::vector<ValueSweep> value_sweeps;
+    std::vector<Placement> placements;
+    uint64_t samples = 1;
+    uint64_t seed = 1;
+
+    // DC stimulus between two pins, the negative one being ground. Without
+    // it runs only measure connectivity.
+    bool has_source = false;
+    PinRef source_positive{}, source_negative{};
+    double source_voltage = 0;
+    std::vector<PinRef> probes;
+
+    uint64_t run_count() const;
+};
+
+enum class SweepStatus : uint8_t { Ok, InvalidValue, SolveFailed };
+
+struct SweepRow {
+    uint64_t run;
+    SweepStatus status;
+    uint32_t nets;
+    // Pins on a net with no other pin and no wire.
+    uint32_t dangling_pins;
+    uint32_t iterations;
+};
+
+// Rows of consecutive runs plus their values, row-major with
+// Sweep::columns() values per row: the swept values, the placement
+// indices, then the probe voltages (NaN when the run failed).
+struct SweepChunk {
+    std::vector<SweepRow> rows;
+    std::vector<double> values;
+};
+
+// Running mean, deviation and range of one probe over the successful runs.
+struct ProbeStats {
+    uint64_t count = 0;
+    double mean = 0, m2 = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    void add(double v);
+    void merge(const ProbeStats& other);
+    double stddev() const;
+};
+
+struct SweepSummary {
+    uint64_t runs = 0;
+    uint64_t failed = 0;
+    double seconds = 0;
+    std::vector<ProbeStats> probes;
+
+    double runs_per_second() const { return seconds > 0 ? runs / seconds : 0; }
+};
+
+// Streams chunks to a CSV or binary file in run order, whatever order the
+// workers finish them in.
+//
+// The binary file is a SweepFileHeader, the column names as NUL-terminated
+// strings, then per run a SweepRecord followed by `columns` doubles.
+constexpr char SWEEP_FILE_MAGIC[8] = {'A', 'C', 'A', 'D', 'S', 'W', 'P', '\0'};
+constexpr uint32_t SWEEP_FILE_VERSION = 1;
+
+struct SweepFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t columns;
+    uint64_t runs;
+};
+
+struct SweepRecord {
+    uint64_t run;
+    uint8_t status;
+    uint8_t reserved[3];
+    uint32_t nets;
+    uint32_t dangling_pins;
+    uint32_t iterations;
+};
+
+static_assert(sizeof(SweepFileHeader) == 24, "unexpected sweep header padding");
+static_assert(sizeof(SweepRecord) == 24, "unexpected sweep record padding");
+
+class SweepWriter {
+public:
+    enum class Format { Csv, Binary };
+
+    ~SweepWriter() { close(); }
+
+    // "-" writes to standard output.
+    bool open(const std::string& filename, Format format, const std::vector<std::string>& columns, uint64_t runs);
+    bool write(const SweepChunk& chunk);
+    bool close();
+
+private:
+    std::FILE* file = nullptr;
+    bool owns_file = false;
+    Format format = Format::Csv;
+    size_t columns = 0;
+};
+
+// Runs a plan against one loaded design. The design, its netlist and a
+// prototype simulator are shared by all runs; each run only carries its
+// overrides. Value-only runs reuse the prototype's matrix pattern and
+// ordering and just refactor; placement runs rebuild the netlist once per
+// placement combination per worker.
+class Sweep {
+public:
+    Sweep(ComponentList components, WireList wires, SweepPlan plan,
+          const SimulationOptions& options = SimulationOptions{});
+
+    // Names of the value columns of each row.
+    std::vector<std::string> columns() const;
+
+    // Overrides applied by a run. Deterministic in (seed, run), so results
+    // don't depend on the thread count or scheduling.
+    void variant(uint64_t run, std::vector<ComponentOverride>& out) const;
+
+    // Evaluates every run on the pool in chunks of chunk_size runs, passing
+    // finished chunks to writer (if given) in run order. Runs that fail are
+    // reported in their rows; this only fails for an invalid plan or when
+    // the writer does.
+    bool run(ThreadPool& pool, SweepWriter* writer, SweepSummary& summary, size_t chunk_size = 256);
+
+    const std::string& get_error() const { return error; }
+
+private:
+    struct Worker;
+
+    void decode(uint64_t run, uint64_t& sample, uint64_t& point, uint64_t& placement) const;
+    double swept_value(size_t sweep, uint64_t point) const;
+    size_t placement_index(size_t placement, uint64_t combination) const;
+    void prepare(Worker& worker, uint64_t placement) const;
+    void evaluate(Worker& worker, uint64_t run, SweepRow& row, double* values) const;
+
+    ComponentList components;
+    WireList wires;
+    SweepPlan plan;
+    SimulationOptions options;
+    std::vector<std::string> names;
+    Netlist base_netlist;
+    std::unique_ptr<Simulator> prototype;
+    std::string error;
+};
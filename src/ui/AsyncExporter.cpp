@@ -0,0 +1,80 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "AsyncExporter.h"
+
+AsyncExporter::AsyncExporter() {
+    dispatcher.connect(sigc::mem_fun(*this, &AsyncExporter::dispatch));
+    worker = std::thread(&AsyncExporter::run, this);
+}
+
+// Finishes the queued exports so no image is left half written.
+AsyncExporter::~AsyncExporter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void AsyncExporter::export_image(const std::string& filename, DesignStore design, ExportFormat format,
+                                 const ExportOptions& options) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(Job{filename, std::move(design), format, options});
+    }
+    wake.notify_one();
+}
+
+bool AsyncExporter::busy() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return running_job || !pending.empty();
+}
+
+void AsyncExporter::run() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) return;
+            job = std::move(pending.front());
+            pending.pop_front();
+            running_job = true;
+        }
+
+        post(Status{Status::Started, job.filename});
+
+        if (!pool) pool = std::make_unique<ThreadPool>();
+        bool ok = export_design(job.design, job.filename, job.format, job.options, *pool);
+        // Let go of the snapshot so the UI's next edits needn't copy arrays.
+        job.design = DesignStore{};
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running_job = false;
+        }
+        post(Status{ok ? Status::Finished : Status::Failed, job.filename});
+    }
+}
+
+void AsyncExporter::post(const Status& status) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        statuses.push_back(status);
+    }
+    dispatcher.emit();
+}
+
+void AsyncExporter::dispatch() {
+    std::deque<Status> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(statuses);
+    }
+    for (const auto& status : ready) {
+        if (on_status) on_status(status);
+    }
+}
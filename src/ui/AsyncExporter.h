@@ -0,0 +1,69 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <gtkmm.h>
+#include "../core/DesignStore.h"
+#include "../render/Exporter.h"
+#include "../util/ThreadPool.h"
+
+// Renders image exports of design snapshots on a worker thread, with the
+// tiles spread over a pool that lives as long as the exporter. As with
+// AsyncSaver, status updates come back through a Glib::Dispatcher so the
+// callback runs on the UI thread. Unlike saves, exports queue up: each one
+// is its own file.
+class AsyncExporter {
+public:
+    struct Status {
+        enum State { Started, Finished, Failed };
+        State state;
+        std::string filename;
+    };
+
+    AsyncExporter();
+    ~AsyncExporter();
+
+    AsyncExporter(const AsyncExporter&) = delete;
+    AsyncExporter& operator=(const AsyncExporter&) = delete;
+
+    // The design is a snapshot sharing the live store's arrays, so the UI
+    // can go on editing while it renders.
+    void export_image(const std::string& filename, DesignStore design, ExportFormat format,
+                      const ExportOptions& options);
+    bool busy() const;
+    void set_status_callback(std::function<void(const Status&)> callback) { on_status = std::move(callback); }
+
+private:
+    struct Job {
+        std::string filename;
+        DesignStore design;
+        ExportFormat format;
+        ExportOptions options;
+    };
+
+    void run();
+    void post(const Status& status);
+    void dispatch();
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> pending;
+    bool running_job = false;
+    bool stopping = false;
+    std::deque<Status> statuses;
+    Glib::Dispatcher dispatcher;
+    std::function<void(const Status&)> on_status;
+    // Made by the worker on the first export, so an editor that never
+    // exports doesn't keep a thread per core asleep.
+    std::unique_ptr<ThreadPool> pool;
+    std::thread worker;
+};
@@ -0,0 +1,81 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#include "AsyncSaver.h"
+#include "../core/Journal.h"
+
+AsyncSaver::AsyncSaver() {
+    dispatcher.connect(sigc::mem_fun(*this, &AsyncSaver::dispatch));
+    worker = std::thread(&AsyncSaver::run, this);
+}
+
+// Waits for a running or pending save to finish so no file is left half written.
+AsyncSaver::~AsyncSaver() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void AsyncSaver::save(const std::string& filename, DesignStore design, uint64_t generation, bool autosave,
+                      bool want_checksum) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = Job{filename, std::move(design), generation, autosave, want_checksum};
+    }
+    wake.notify_one();
+}
+
+bool AsyncSaver::busy() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return running_job || pending.has_value();
+}
+
+void AsyncSaver::run() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || pending.has_value(); });
+            if (!pending) return;
+            job = std::move(*pending);
+            pending.reset();
+            running_job = true;
+        }
+
+        post(Status{Status::Started, job.filename, job.generation, job.autosave, 0});
+
+        bool ok = save_design_atomic(job.filename, job.design);
+        const uint64_t checksum = ok && job.want_checksum ? design_checksum(job.design) : 0;
+        // Let go of the snapshot so the UI's next edits needn't copy arrays.
+        job.design = DesignStore{};
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running_job = false;
+        }
+        post(Status{ok ? Status::Finished : Status::Failed, job.filename, job.generation, job.autosave, checksum});
+    }
+}
+
+void AsyncSaver::post(const Status& status) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        statuses.push_back(status);
+    }
+    dispatcher.emit();
+}
+
+void AsyncSaver::dispatch() {
+    std::deque<Status> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(statuses);
+    }
+    for (const auto& status : ready) {
+        if (on_status) on_status(status);
+    }
+}
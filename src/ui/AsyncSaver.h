@@ -0,0 +1,70 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <gtkmm.h>
+#include "../core/DesignIO.h"
+
+// Serializes and writes snapshots of the design on a worker thread. Status updates are
+// marshalled back to the GTK main loop through a Glib::Dispatcher, so the
+// callback always runs on the UI thread. If saves are queued faster than they
+// complete, only the newest pending one is kept.
+class AsyncSaver {
+public:
+    struct Status {
+        enum State { Started, Finished, Failed };
+        State state;
+        std::string filename;
+        uint64_t generation;
+        bool autosave;
+        // design_checksum of what was written, for saves that asked for it.
+        uint64_t checksum;
+    };
+
+    AsyncSaver();
+    ~AsyncSaver();
+
+    AsyncSaver(const AsyncSaver&) = delete;
+    AsyncSaver& operator=(const AsyncSaver&) = delete;
+
+    // A DesignStore copy is a snapshot that shares the arrays, so passing the
+    // live design costs the UI thread next to nothing. The checksum, when
+    // wanted, is worked out on the worker too.
+    void save(const std::string& filename, DesignStore design, uint64_t generation, bool autosave,
+              bool want_checksum = false);
+    bool busy() const;
+    void set_status_callback(std::function<void(const Status&)> callback) { on_status = std::move(callback); }
+
+private:
+    struct Job {
+        std::string filename;
+        DesignStore design;
+        uint64_t generation;
+        bool autosave;
+        bool want_checksum;
+    };
+
+    void run();
+    void post(const Status& status);
+    void dispatch();
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::optional<Job> pending;
+    bool running_job = false;
+    bool stopping = false;
+    std::deque<Status> statuses;
+    Glib::Dispatcher dispatcher;
+    std::function<void(const Status&)> on_status;
+    std::thread worker;
+};
@@ -3,31 +3,131 @@
     Date: Fri Nov 21st 2025
 */
 
-#include <fstream>   
-#include <nlohmann/json.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
 #include "CircuitCanvas.h"
+#include "../core/DesignIO.h"
+#include "../core/Netlist.h"
+#include "../core/Router.h"
+#include "../render/Exporter.h"
+#include "../render/Renderer.h"
 #include <cairomm/context.h>
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <filesystem>
 #include "../util/Constants.h"
+#include "../util/Units.h"
 
 
 CircuitCanvas::CircuitCanvas()
 : drawing_wire(false), drawing_mode(ComponentMode), current_component(ResistorType)
 {
     add_events(Gdk::BUTTON_PRESS_MASK | Gdk::BUTTON_RELEASE_MASK |
-               Gdk::POINTER_MOTION_MASK | Gdk::KEY_PRESS_MASK);
+               Gdk::POINTER_MOTION_MASK | Gdk::KEY_PRESS_MASK |
+               Gdk::SCROLL_MASK);
 
     set_can_focus(true);
     grab_focus();
+
+    saver.set_status_callback(sigc::mem_fun(*this, &CircuitCanvas::on_save_status));
+
+    always_record_metrics = std::getenv("ACAD_FRAME_STATS") != nullptr;
+    metrics.set_enabled(always_record_metrics);
+
+    if (const char* mb = std::getenv("ACAD_UNDO_MB"))
+        history.set_memory_limit(std::strtoull(mb, nullptr, 10) << 20);
+}
+
+void CircuitCanvas::add_component(ComponentKind kind, double x, double y) {
+    double width, height;
+    default_component_size(kind, width, height);
+    double value = default_component_value(kind);
+    ComponentHandle comp = design.add_component(kind, x, y, width, height, 0, value);
+    ComponentGeometry geometry = design.geometry(design.index_of(comp));
+    component_index.insert(comp, geometry.draw_bounds());
+    journal.record_add_component(geometry, value);
+    history.record_add_component(design.index_of(comp));
+    check_rules({comp}, {});
+    mark_dirty();
+    invalidate(geometry.draw_bounds());
+}
+
+void CircuitCanvas::to_world(double sx, double sy, double& wx, double& wy) const {
+    wx = view_x + sx / zoom;
+    wy = view_y + sy / zoom;
+}
+
+Rect CircuitCanvas::to_world(const Rect& r) const {
+    return Rect{view_x + r.x0 / zoom, view_y + r.y0 / zoom,
+                view_x + r.x1 / zoom, view_y + r.y1 / zoom};
+}
+
+Rect CircuitCanvas::to_screen(const Rect& r) const {
+    return Rect{(r.x0 - view_x) * zoom, (r.y0 - view_y) * zoom,
+                (r.x1 - view_x) * zoom, (r.y1 - view_y) * zoom};
 }
 
-void CircuitCanvas::add_component(std::shared_ptr<CircuitComponent> comp) {
-    components.push_back(comp);
+void CircuitCanvas::apply_view(const Cairo::RefPtr<Cairo::Context>& cr) const {
+    cr->scale(zoom, zoom);
+    cr->translate(-view_x, -view_y);
+}
+
+// Keeps the world point under (sx, sy) fixed while stepping through the zoom levels.
+void CircuitCanvas::zoom_at(double sx, double sy, int steps) {
+    int level = std::clamp(zoom_level + steps, 0, NUM_ZOOM_LEVELS - 1);
+    if (level == zoom_level) return;
+
+    double wx, wy;
+    to_world(sx, sy, wx, wy);
+    zoom_level = level;
+    zoom = static_cast<double>(ZOOM_SPACINGS[zoom_level]) / GRID_SIZE;
+    view_x = wx - sx / zoom;
+    view_y = wy - sy / zoom;
+    queue_draw();
+}
+
+void CircuitCanvas::pan_by(double dx, double dy) {
+    view_x -= dx / zoom;
+    view_y -= dy / zoom;
     queue_draw();
 }
 
+void CircuitCanvas::invalidate(const Rect& r) {
+    invalidate_screen(to_screen(r));
+}
+
+void CircuitCanvas::invalidate_screen(const Rect& r) {
+    if (r.empty()) return;
+    // One extra pixel on each side covers antialiasing spill.
+    int x0 = static_cast<int>(std::floor(r.x0)) - 1;
+    int y0 = static_cast<int>(std::floor(r.y0)) - 1;
+    int x1 = static_cast<int>(std::ceil(r.x1)) + 1;
+    int y1 = static_cast<int>(std::ceil(r.y1)) + 1;
+    queue_draw_area(x0, y0, x1 - x0, y1 - y0);
+}
+
+Rect CircuitCanvas::get_hover_rect() const {
+    Rect r;
+    if (hovered_component) {
+        ComponentGeometry g = design.geometry(design.index_of(hovered_component));
+        double draw_y = g.y;
+        if (g.kind == ComponentKind::Transistor)
+            draw_y += GRID_SIZE / 2.0;
+        r = Rect{g.x, draw_y, g.x + g.width, draw_y + g.height};
+    }
+    if (hovered_wire)
+        r = r.united(design.wire_bounds(design.index_of(hovered_wire)));
+    if (hovered_instance)
+        r = r.united(design.instance_bounds(design.index_of(hovered_instance)));
+    return r;
+}
+
+Rect CircuitCanvas::get_label_rect() const {
+    return Rect{pointer_x + 8, pointer_y - 4, pointer_x + 12 + label_width, pointer_y + 16};
+}
+
 inline double snap_to_grid(double val) {
     return GRID_SIZE * std::round(val / GRID_SIZE);
 }
@@ -41,49 +141,121 @@ bool CircuitCanvas::on_draw(const Cairo::RefPtr<Cairo::Context>& cr) {
     const int width = allocation.get_width();
     const int height = allocation.get_height();
 
-    cr->set_source_rgb(0.9, 0.9, 0.9);
-    cr->set_line_width(1.0);
-    for(int gx = 0; gx < width; gx += GRID_SIZE) {
-        cr->move_to(gx, 0);
-        cr->line_to(gx, height);
+    Metrics::Scope draw_scope(metrics, Metrics::Draw);
+    if (motion_awaiting_frame) {
+        metrics.record(Metrics::MotionToFrame, motion_time);
+        motion_awaiting_frame = false;
     }
-    for(int gy = 0; gy < height; gy += GRID_SIZE) {
-        cr->move_to(0, gy);
-        cr->line_to(width, gy);
+
+    // Only what intersects the damaged area gets redrawn.
+    Rect clip;
+    cr->get_clip_extents(clip.x0, clip.y0, clip.x1, clip.y1);
+
+    Rect grid_area{std::max(0.0, clip.x0), std::max(0.0, clip.y0),
+                   std::min<double>(width, clip.x1), std::min<double>(height, clip.y1)};
+    if (ZOOM_SPACINGS[zoom_level] >= MIN_GRID_SPACING) {
+        if (use_grid_cache) {
+            draw_cached_grid(cr, grid_area);
+        } else {
+            cr->save();
+            apply_view(cr);
+            draw_grid_lines(cr, to_world(grid_area));
+            cr->restore();
+        }
     }
-    cr->stroke();
+
+    // Everything below is in world coordinates and culled to the visible part of the clip.
+    Rect visible = to_world(clip);
+    cr->save();
+    apply_view(cr);
+
+    const DesignStore::ComponentColumns& comps = design.components();
+    const DesignStore::WireColumns& ws = design.wires();
 
     if (hovered_component) {
         cr->set_source_rgba(1, 0, 0, 0.3);
 
-        double draw_x = hovered_component->x;
-        double draw_y = hovered_component->y;
+        size_t i = design.index_of(hovered_component);
+        double draw_x = comps.x[i];
+        double draw_y = comps.y[i];
 
-        if (std::dynamic_pointer_cast<Transistor>(hovered_component))
+        if (comps.kind[i] == ComponentKind::Transistor)
             draw_y += GRID_SIZE / 2.0;
 
-        cr->rectangle(draw_x, draw_y,
-                    hovered_component->width, hovered_component->height);
+        cr->rectangle(draw_x, draw_y, comps.width[i], comps.height[i]);
         cr->fill();
     }
 
 
     if (hovered_wire) {
+        size_t i = design.index_of(hovered_wire);
         cr->set_source_rgba(1, 0, 0, 0.3);
         cr->set_line_width(3.0);
-        cr->move_to(hovered_wire->get_x1(), hovered_wire->get_y1());
-        cr->line_to(hovered_wire->get_x2(), hovered_wire->get_y2());
+        cr->move_to(ws.x1[i], ws.y1[i]);
+        cr->line_to(ws.x2[i], ws.y2[i]);
         cr->stroke();
     }
 
-    for(auto& wire : wires)
-        wire->draw(cr);
+    if (hovered_instance) {
+        Rect b = design.instance_bounds(design.index_of(hovered_instance));
+        cr->set_source_rgba(1, 0, 0, 0.3);
+        cr->rectangle(b.x0, b.y0, b.width(), b.height());
+        cr->fill();
+    }
 
-    for(auto& comp : components)
-        comp->draw(cr);
+    // Highlights cost what is visible, not the size of the selection.
+    if (has_selection()) {
+        cr->set_source_rgba(0, 0.4, 1, 0.3);
+        component_index.visit(visible, [&](ComponentHandle comp) {
+            if (!selected_components.contains(comp)) return;
+            Rect b = design.geometry(design.index_of(comp)).bounds();
+            if (b.intersects(visible)) cr->rectangle(b.x0, b.y0, b.width(), b.height());
+        });
+        instance_index.visit(visible, [&](InstanceHandle instance) {
+            if (!selected_instances.contains(instance)) return;
+            Rect b = design.instance_bounds(design.index_of(instance));
+            if (b.intersects(visible)) cr->rectangle(b.x0, b.y0, b.width(), b.height());
+        });
+        cr->fill();
+        cr->set_line_width(3.0);
+        wire_index.visit(visible, [&](WireHandle wire) {
+            if (!selected_wires.contains(wire)) return;
+            size_t i = design.index_of(wire);
+            cr->move_to(ws.x1[i], ws.y1[i]);
+            cr->line_to(ws.x2[i], ws.y2[i]);
+        });
+        cr->stroke();
+    }
+
+    if (zoom < LOD_ZOOM) {
+        draw_lod(cr, visible);
+    } else {
+        for(WireHandle wire : wire_index.query(visible)) {
+            size_t i = design.index_of(wire);
+            draw_wire(cr, ws.x1[i], ws.y1[i], ws.x2[i], ws.y2[i]);
+        }
+
+        for(ComponentHandle comp : component_index.query(visible))
+            draw_component(cr, design.geometry(design.index_of(comp)));
+    }
+    draw_instances(cr, visible);
+
+    if (show_rule_markers) draw_rule_markers(cr, visible);
 
     if(drawing_wire && temp_wire)
-        temp_wire->draw(cr);
+        draw_wire(cr, *temp_wire);
+
+    if (selecting) {
+        Rect band = get_rubber_band_rect();
+        cr->rectangle(band.x0, band.y0, band.width(), band.height());
+        cr->set_source_rgba(0, 0.4, 1, 0.1);
+        cr->fill_preserve();
+        cr->set_source_rgba(0, 0.4, 1, 0.8);
+        cr->set_line_width(1.0 / zoom);
+        cr->stroke();
+    }
+
+    cr->restore();
 
     std::ostringstream label;
     switch(drawing_mode) {
@@ -97,113 +269,481 @@ bool CircuitCanvas::on_draw(const Cairo::RefPtr<Cairo::Context>& cr) {
             break;
         case MoveMode: label << "Move Mode"; break;
     }
+    if (hovered_component) {
+        size_t i = design.index_of(hovered_component);
+        label << "  " << format_si_value(comps.value[i]) << component_value_unit(comps.kind[i]);
+    } else if (hovered_instance) {
+        label << "  " << design.instance_definition(design.index_of(hovered_instance)).name();
+    }
+    if (size_t count = selected_components.size() + selected_wires.size() + selected_instances.size())
+        label << "  " << count << " selected";
     cr->set_source_rgb(0, 0, 0);
-    cr->move_to(mouse_x + 10, mouse_y + 10);
+    cr->move_to(pointer_x + 10, pointer_y + 10);
     cr->show_text(label.str());
     cr->stroke();
 
+    Cairo::TextExtents extents;
+    cr->get_text_extents(label.str(), extents);
+    label_width = extents.x_advance;
+
+    draw_scope.stop();
+    if (show_metrics) draw_metrics(cr);
     return true;
 }
 
+Rect CircuitCanvas::get_metrics_rect() const {
+    return Rect{8, 8, 8 + 330, 8 + 8 + 14.0 * (static_cast<int>(Metrics::PROBE_COUNT) + 1)};
+}
+
+void CircuitCanvas::draw_metrics(const Cairo::RefPtr<Cairo::Context>& cr) {
+    Rect r = get_metrics_rect();
+    cr->save();
+    cr->set_source_rgba(1, 1, 1, 0.85);
+    cr->rectangle(r.x0, r.y0, r.x1 - r.x0, r.y1 - r.y0);
+    cr->fill();
+    cr->set_source_rgb(0, 0, 0);
+    cr->select_font_face("monospace", Cairo::FONT_SLANT_NORMAL, Cairo::FONT_WEIGHT_NORMAL);
+    cr->set_font_size(11);
+    for (int p = 0; p < Metrics::PROBE_COUNT; ++p) {
+        const LatencyHistogram& h = metrics.histogram(static_cast<Metrics::Probe>(p));
+        char line[128];
+        std::snprintf(line, sizeof(line), "%-15s p50 %8.2f  p99 %8.2f  max %8.2f ms",
+                      Metrics::probe_name(static_cast<Metrics::Probe>(p)), h.percentile(0.5),
+                      h.percentile(0.99), h.max());
+        cr->move_to(r.x0 + 4, r.y0 + 15 + 14 * p);
+        cr->show_text(line);
+    }
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-15s received %llu  handled %llu", "motion events",
+                  static_cast<unsigned long long>(metrics.counter(Metrics::MotionEvents)),
+                  static_cast<unsigned long long>(metrics.counter(Metrics::MotionUpdates)));
+    cr->move_to(r.x0 + 4, r.y0 + 15 + 14 * Metrics::PROBE_COUNT);
+    cr->show_text(line);
+    cr->restore();
+}
+
+void CircuitCanvas::set_metrics_overlay(bool visible) {
+    show_metrics = visible;
+    metrics.set_enabled(show_metrics || always_record_metrics);
+    metrics_connection.disconnect();
+    if (show_metrics) {
+        metrics_connection = Glib::signal_timeout().connect([this]() {
+            invalidate_screen(get_metrics_rect());
+            return true;
+        }, METRICS_REFRESH_MS);
+    }
+    invalidate_screen(get_metrics_rect());
+}
+
+// Far zoomed out, parts are drawn as plain boxes and wires as one path, which
+// keeps huge designs responsive when symbol detail is too small to see anyway.
+void CircuitCanvas::draw_lod(const Cairo::RefPtr<Cairo::Context>& cr, const Rect& visible) {
+    cr->set_source_rgb(0, 0, 0);
+    cr->set_line_width(2.0);
+    const DesignStore::WireColumns& ws = design.wires();
+    for(WireHandle wire : wire_index.query(visible)) {
+        size_t i = design.index_of(wire);
+        cr->move_to(ws.x1[i], ws.y1[i]);
+        cr->line_to(ws.x2[i], ws.y2[i]);
+    }
+    cr->stroke();
+
+    cr->set_source_rgb(0.3, 0.3, 0.3);
+    for(ComponentHandle comp : component_index.query(visible)) {
+        Rect b = design.geometry(design.index_of(comp)).bounds();
+        cr->rectangle(b.x0, b.y0, b.width(), b.height());
+    }
+    cr->fill();
+}
+
+// A ring at each violation: red for parts or wires in each other's way,
+// orange for wires that are loose or empty. Kept a constant size on screen.
+void CircuitCanvas::draw_rule_markers(const Cairo::RefPtr<Cairo::Context>& cr, const Rect& visible) {
+    if (rule_markers_stale) {
+        rules.collect(rule_markers);
+        rule_markers_stale = false;
+    }
+    const double radius = 6.0 / zoom;
+    const Rect area = visible.expanded(radius);
+    cr->set_line_width(2.0 / zoom);
+    for (int pass = 0; pass < 2; ++pass) {
+        for (const DrcViolation& v : rule_markers) {
+            const bool loose = v.rule == DrcViolation::DanglingWire || v.rule == DrcViolation::ZeroLengthWire;
+            if (loose != (pass == 0) || !area.contains(v.x, v.y)) continue;
+            cr->begin_new_sub_path();
+            cr->arc(v.x, v.y, radius, 0, 2 * M_PI);
+        }
+        if (pass == 0) cr->set_source_rgb(1, 0.55, 0);
+        else cr->set_source_rgb(0.9, 0, 0);
+        cr->stroke();
+    }
+}
+
+// Each instance draws its block's parts where it places them, so a block
+// placed many times is still stored once. A faint box marks each block.
+void CircuitCanvas::draw_instances(const Cairo::RefPtr<Cairo::Context>& cr, const Rect& visible) {
+    for (InstanceHandle instance : instance_index.query(visible)) {
+        const size_t n = design.index_of(instance);
+        const Rect box = design.instance_bounds(n);
+        if (zoom < LOD_ZOOM) {
+            cr->set_source_rgb(0.3, 0.3, 0.3);
+            cr->rectangle(box.x0, box.y0, box.width(), box.height());
+            cr->fill();
+            continue;
+        }
+        const Placement at = design.placement(n);
+        const DesignStore& parts = design.instance_definition(n).contents();
+        const DesignStore::WireColumns& ws = parts.wires();
+        for (size_t i = 0; i < parts.wire_count(); ++i) {
+            double x1, y1, x2, y2;
+            at.to_world(ws.x1[i], ws.y1[i], x1, y1);
+            at.to_world(ws.x2[i], ws.y2[i], x2, y2);
+            draw_wire(cr, x1, y1, x2, y2);
+        }
+        for (size_t i = 0; i < parts.component_count(); ++i) {
+            const ComponentGeometry g = at.to_world(parts.geometry(i));
+            if (g.draw_bounds().intersects(visible)) draw_component(cr, g);
+        }
+        cr->set_source_rgba(0.2, 0.4, 0.8, 0.5);
+        cr->set_line_width(1.0 / zoom);
+        cr->rectangle(box.x0, box.y0, box.width(), box.height());
+        cr->stroke();
+    }
+}
+
+// Strokes the grid over a world-space area; used when the cached tile is off.
+void CircuitCanvas::draw_grid_lines(const Cairo::RefPtr<Cairo::Context>& cr, const Rect& area) {
+    if (area.empty()) return;
+    cr->set_source_rgb(0.9, 0.9, 0.9);
+    cr->set_line_width(1.0 / zoom);
+    int first_gx = static_cast<int>(std::floor(area.x0 / GRID_SIZE)) * GRID_SIZE;
+    int first_gy = static_cast<int>(std::floor(area.y0 / GRID_SIZE)) * GRID_SIZE;
+    for(int gx = first_gx; gx <= area.x1 + 1; gx += GRID_SIZE) {
+        cr->move_to(gx, area.y0);
+        cr->line_to(gx, area.y1);
+    }
+    for(int gy = first_gy; gy <= area.y1 + 1; gy += GRID_SIZE) {
+        cr->move_to(area.x0, gy);
+        cr->line_to(area.x1, gy);
+    }
+    cr->stroke();
+}
+
+void CircuitCanvas::draw_cached_grid(const Cairo::RefPtr<Cairo::Context>& cr, const Rect& area) {
+    if (area.empty()) return;
+    int scale = get_scale_factor();
+    int spacing = ZOOM_SPACINGS[zoom_level];
+    if (!grid_pattern || grid_pattern_size != spacing || grid_pattern_scale != scale)
+        build_grid_pattern(spacing, scale);
+
+    // Shift the tile so grid lines stay on world multiples of GRID_SIZE while panning.
+    grid_pattern->set_matrix(Cairo::translation_matrix(view_x * zoom, view_y * zoom));
+
+    cr->save();
+    cr->set_source(grid_pattern);
+    cr->rectangle(area.x0, area.y0, area.width(), area.height());
+    cr->fill();
+    cr->restore();
+}
+
+// Renders one grid cell, spacing screen pixels wide, into a tile that is
+// repeated across the canvas. Lines are stroked at both tile edges so the half
+// of each line that falls inside the tile matches what stroking the full grid
+// produces. Zoom levels keep the spacing a whole number of pixels so the tile
+// repeats without resampling.
+void CircuitCanvas::build_grid_pattern(int spacing, int scale) {
+    Cairo::RefPtr<Cairo::Surface> tile;
+    if (auto window = get_window())
+        tile = window->create_similar_surface(Cairo::CONTENT_COLOR_ALPHA, spacing, spacing);
+    else
+        tile = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, spacing, spacing);
+
+    auto tcr = Cairo::Context::create(tile);
+    tcr->set_source_rgb(0.9, 0.9, 0.9);
+    tcr->set_line_width(1.0);
+    tcr->move_to(0, 0); tcr->line_to(0, spacing);
+    tcr->move_to(spacing, 0); tcr->line_to(spacing, spacing);
+    tcr->move_to(0, 0); tcr->line_to(spacing, 0);
+    tcr->move_to(0, spacing); tcr->line_to(spacing, spacing);
+    tcr->stroke();
+
+    grid_pattern = Cairo::SurfacePattern::create(tile);
+    grid_pattern->set_extend(Cairo::EXTEND_REPEAT);
+    grid_pattern_size = spacing;
+    grid_pattern_scale = scale;
+}
+
 bool CircuitCanvas::on_button_press_event(GdkEventButton* event) {
+    flush_motion();
+    if(event->button == 2) {
+        panning = true;
+        pan_last_x = event->x;
+        pan_last_y = event->y;
+        return true;
+    }
     if(event->button != 1) return false;
 
+    double wx, wy;
+    to_world(event->x, event->y, wx, wy);
+
     if(drawing_mode == ComponentMode) {
         double comp_width = 40;
         double comp_height = 20;
-        double x = snap_to_grid_center(event->x, comp_width);
-        double y = snap_to_grid_center(event->y, comp_height);
+        double x = snap_to_grid_center(wx, comp_width);
+        double y = snap_to_grid_center(wy, comp_height);
 
         switch (current_component) {
             case ResistorType:
-                components.push_back(std::make_shared<Resistor>(x, y));
+                add_component(ComponentKind::Resistor, x, y);
                 break;
             case CapacitorType:
-                components.push_back(std::make_shared<Capacitor>(x, y));
+                add_component(ComponentKind::Capacitor, x, y);
                 break;
             case TransistorType:
-                components.push_back(std::make_shared<Transistor>(x, y));
+                add_component(ComponentKind::Transistor, x, y);
                 break;
             case CoilType:
-                components.push_back(std::make_shared<Coil>(x, y));
+                add_component(ComponentKind::Coil, x, y);
                 break;
             default:
                 break;
         }
-
-        queue_draw();
     }
     else if(drawing_mode == WireMode) {
-        double x = snap_to_grid(event->x);
-        double y = snap_to_grid(event->y);
+        double x = snap_to_grid(wx);
+        double y = snap_to_grid(wy);
         drawing_wire = true;
-        temp_wire = std::make_shared<Wire>(x, y, x, y);
+        temp_wire.emplace(x, y, x, y);
+        invalidate(temp_wire->get_draw_bounds());
     } 
     else if(drawing_mode == MoveMode) {
-        dragged_component = get_component_at(event->x, event->y);
-        if(dragged_component) {
-            drag_offset_x = event->x - (dragged_component->x + dragged_component->width/2.0);
-            drag_offset_y = event->y - (dragged_component->y + dragged_component->height/2.0);
+        // Shift toggles what is under the pointer, or adds a rubber band to
+        // the selection. A plain press drags the selection when it lands on
+        // part of it, and otherwise selects what it hit or starts a band.
+        bool extend = event->state & GDK_SHIFT_MASK;
+        ComponentHandle comp = get_component_at(wx, wy);
+        InstanceHandle instance = comp ? InstanceHandle{} : get_instance_at(wx, wy);
+        WireHandle wire = comp || instance ? WireHandle{} : get_wire_at(wx, wy);
+        invalidate(get_selection_rect());
+        if (!comp && !instance && !wire) {
+            if (!extend) clear_selection();
+            selecting = true;
+            select_start_x = mouse_x = wx;
+            select_start_y = mouse_y = wy;
+        } else if (extend) {
+            if (comp && is_selected(comp))
+                selected_components.erase(comp);
+            else if (comp)
+                selected_components.insert(comp);
+            else if (instance && is_selected(instance))
+                selected_instances.erase(instance);
+            else if (instance)
+                selected_instances.insert(instance);
+            else if (is_selected(wire))
+                selected_wires.erase(wire);
+            else
+                selected_wires.insert(wire);
+        } else {
+            if (comp ? !is_selected(comp) : instance ? !is_selected(instance) : !is_selected(wire)) {
+                clear_selection();
+                if (comp) selected_components.insert(comp);
+                else if (instance) selected_instances.insert(instance);
+                else selected_wires.insert(wire);
+            }
+            dragging_selection = true;
+            drag_recorded = false;
+            drag_press_x = wx;
+            drag_press_y = wy;
+            drag_dx = drag_dy = 0;
         }
+        invalidate(get_selection_rect());
     }
     return true;
 }
 
+// Motion events only note where the pointer is. The frame clock's next tick
+// handles the latest position once, before that frame is laid out and
+// painted, so however fast the pointer reports, hover, drags and the
+// repaint they queue cost one pass per frame and still show in that frame.
 bool CircuitCanvas::on_motion_notify_event(GdkEventMotion* event) {
-    mouse_x = event->x;
-    mouse_y = event->y;
-
-    hovered_component = get_component_at(mouse_x, mouse_y);
-
-    hovered_wire = nullptr;
-    if (!drawing_wire) {
-        for (auto it = wires.rbegin(); it != wires.rend(); ++it) {
-            if ((*it)->contains_point(mouse_x, mouse_y)) {
-                hovered_wire = *it;
-                break;
-            }
+    metrics.count(Metrics::MotionEvents);
+    if (metrics.is_enabled()) {
+        // Event times come from the monotonic clock on Wayland and on most X
+        // servers; anything implausible means this one uses another clock.
+        const guint32 now = static_cast<guint32>(g_get_monotonic_time() / 1000);
+        const guint32 wait = now - event->time;
+        if (wait < 10000) metrics.record(Metrics::EventWait, static_cast<double>(wait));
+        if (!motion_awaiting_frame) {
+            motion_awaiting_frame = true;
+            motion_time = Metrics::Clock::now();
         }
     }
 
-    if(drawing_wire && temp_wire) {
-        temp_wire->set_end(snap_to_grid(event->x), snap_to_grid(event->y));
+    pending_motion_x = event->x;
+    pending_motion_y = event->y;
+    motion_pending = true;
+    if (!motion_tick)
+        motion_tick = add_tick_callback(sigc::mem_fun(*this, &CircuitCanvas::on_motion_tick));
+    return true;
+}
+
+bool CircuitCanvas::on_motion_tick(const Glib::RefPtr<Gdk::FrameClock>&) {
+    motion_tick = 0;
+    flush_motion();
+    return false;
+}
+
+// Presses, releases and keys act where the pointer is now, so they handle
+// any motion still waiting for its frame first.
+void CircuitCanvas::flush_motion() {
+    if (!motion_pending) return;
+    motion_pending = false;
+    metrics.count(Metrics::MotionUpdates);
+    handle_motion(pending_motion_x, pending_motion_y);
+}
+
+void CircuitCanvas::handle_motion(double sx, double sy) {
+    Metrics::Scope motion_scope(metrics, Metrics::Motion);
+    if (panning) {
+        pan_by(sx - pan_last_x, sy - pan_last_y);
+        pan_last_x = sx;
+        pan_last_y = sy;
+        pointer_x = sx;
+        pointer_y = sy;
+        return;
     }
 
-    if(drawing_mode == MoveMode && dragged_component) {
-        double new_center_x = event->x - drag_offset_x;
-        double new_center_y = event->y - drag_offset_y;
+    Rect old_hover = get_hover_rect();
+    Rect old_label = get_label_rect();
+    Rect old_temp = temp_wire ? temp_wire->get_draw_bounds() : Rect{};
+    Rect old_band = selecting ? get_rubber_band_rect() : Rect{};
 
-        double snapped_x = snap_to_grid(new_center_x) - dragged_component->width/2.0;
-        double snapped_y = snap_to_grid(new_center_y) - dragged_component->height/2.0;
+    pointer_x = sx;
+    pointer_y = sy;
+    to_world(sx, sy, mouse_x, mouse_y);
 
-        if (std::dynamic_pointer_cast<Transistor>(dragged_component))
-            snapped_y += GRID_SIZE / 2.0;
+    // While dragging the selection or a band, hover stays as it was when
+    // the drag began; nothing acts on it until the button is released.
+    if (!dragging_selection && !selecting) {
+        hovered_component = get_component_at(mouse_x, mouse_y);
+        hovered_instance = hovered_component ? InstanceHandle{} : get_instance_at(mouse_x, mouse_y);
 
-        dragged_component->x = snapped_x;
-        dragged_component->y = snapped_y;
+        hovered_wire = WireHandle{};
+        if (!drawing_wire) {
+            hovered_wire = get_wire_at(mouse_x, mouse_y);
+        }
     }
 
-    queue_draw();
-    return true;
+    if(drawing_wire && temp_wire) {
+        temp_wire->set_end(snap_to_grid(mouse_x), snap_to_grid(mouse_y));
+    }
+
+    if (dragging_selection) {
+        double dx = snap_to_grid(mouse_x - drag_press_x);
+        double dy = snap_to_grid(mouse_y - drag_press_y);
+        if (dx != drag_dx || dy != drag_dy) {
+            invalidate(get_selection_rect());
+            if (!drag_recorded) {
+                record_selection_moves();
+                drag_recorded = true;
+            }
+            move_selection(dx - drag_dx, dy - drag_dy);
+            drag_dx = dx;
+            drag_dy = dy;
+            invalidate(get_selection_rect());
+        }
+    }
+
+    Rect new_hover = get_hover_rect();
+    if (new_hover != old_hover) {
+        invalidate(old_hover);
+        invalidate(new_hover);
+    }
+    invalidate_screen(old_label);
+    invalidate_screen(get_label_rect());
+    if (temp_wire) {
+        invalidate(old_temp);
+        invalidate(temp_wire->get_draw_bounds());
+    }
+    if (selecting) {
+        invalidate(old_band.expanded(1.0 / zoom));
+        invalidate(get_rubber_band_rect().expanded(1.0 / zoom));
+    }
 }
 
 bool CircuitCanvas::on_button_release_event(GdkEventButton* event) {
+    flush_motion();
+    if(event->button == 2) {
+        panning = false;
+        return true;
+    }
+
     if(drawing_wire && temp_wire && event->button == 1) {
-        temp_wire->set_end(snap_to_grid(event->x), snap_to_grid(event->y));
-        wires.push_back(temp_wire);
-        temp_wire = nullptr;
+        double wx, wy;
+        to_world(event->x, event->y, wx, wy);
+        invalidate(temp_wire->get_draw_bounds());
+        temp_wire->set_end(snap_to_grid(wx), snap_to_grid(wy));
+        const Wire& w = *temp_wire;
+        if (event->state & GDK_SHIFT_MASK) {
+            route_wire(w.get_x1(), w.get_y1(), w.get_x2(), w.get_y2());
+        } else {
+            WireHandle wire = design.add_wire(w.get_x1(), w.get_y1(), w.get_x2(), w.get_y2());
+            wire_index.insert(wire, w.get_draw_bounds());
+            journal.record_add_wire(w.get_x1(), w.get_y1(), w.get_x2(), w.get_y2());
+            history.record_add_wire(design.wire_count() - 1);
+            check_rules({}, {wire});
+            mark_dirty();
+        }
+        invalidate(w.get_draw_bounds());
+        temp_wire.reset();
         drawing_wire = false;
-        queue_draw();
     }
 
-    if(drawing_mode == MoveMode && dragged_component) {
-        dragged_component = nullptr;
+    if (dragging_selection && event->button == 1) {
+        // The journal and the rule check only need where the drag ended,
+        // not every step of it.
+        if (drag_dx != 0 || drag_dy != 0) {
+            journal_selection_moves();
+            check_rules(selected_components, selected_wires, selected_instances);
+        }
+        dragging_selection = false;
+    }
+
+    if (selecting && event->button == 1) {
+        to_world(event->x, event->y, mouse_x, mouse_y);
+        Rect band = get_rubber_band_rect();
+        invalidate(band.expanded(1.0 / zoom));
+        selecting = false;
+        select_in_rect(band);
+        invalidate(get_selection_rect());
     }
 
     return true;
 }
 
+// Ctrl+scroll zooms around the pointer, plain scroll pans (Shift for horizontal).
+bool CircuitCanvas::on_scroll_event(GdkEventScroll* event) {
+    const double step = 3 * GRID_SIZE;
+    bool horizontal = event->state & GDK_SHIFT_MASK;
+
+    if (event->state & GDK_CONTROL_MASK) {
+        if (event->direction == GDK_SCROLL_UP) zoom_at(event->x, event->y, 1);
+        else if (event->direction == GDK_SCROLL_DOWN) zoom_at(event->x, event->y, -1);
+        return true;
+    }
+
+    switch (event->direction) {
+        case GDK_SCROLL_UP: horizontal ? pan_by(step, 0) : pan_by(0, step); break;
+        case GDK_SCROLL_DOWN: horizontal ? pan_by(-step, 0) : pan_by(0, -step); break;
+        case GDK_SCROLL_LEFT: pan_by(step, 0); break;
+        case GDK_SCROLL_RIGHT: pan_by(-step, 0); break;
+        default: break;
+    }
+    return true;
+}
+
 bool CircuitCanvas::on_key_press_event(GdkEventKey* event) {
+    flush_motion();
     switch(event->keyval) {
         case GDK_KEY_w: case GDK_KEY_W:
             drawing_mode = WireMode;
@@ -211,10 +751,27 @@ bool CircuitCanvas::on_key_press_event(GdkEventKey* event) {
             break;
 
         case GDK_KEY_r: case GDK_KEY_R:
-            if(hovered_component) {
-                double new_rotation = hovered_component->get_rotation() + 90.0;
+            if (has_selection()) {
+                rotate_selection();
+            } else if(hovered_component) {
+                size_t i = design.index_of(hovered_component);
+                double new_rotation = design.components().rotation[i] + 90.0;
                 if(new_rotation >= 360.0) new_rotation -= 360.0;
-                hovered_component->set_rotation(new_rotation);
+                history.record_rotate_component(design, i);
+                design.set_rotation(i, new_rotation);
+                component_index.update(hovered_component, design.geometry(i).draw_bounds());
+                journal.record_rotate_component(i, new_rotation);
+                check_rules({hovered_component}, {});
+                mark_dirty();
+            } else if (hovered_instance) {
+                // About the grid point nearest its middle, as a selection turns.
+                size_t n = design.index_of(hovered_instance);
+                Rect box = design.instance_bounds(n);
+                invalidate(design.instance_draw_bounds(n));
+                history.record_move_instance(design, n);
+                rotate_instance(n, snap_to_grid((box.x0 + box.x1) / 2), snap_to_grid((box.y0 + box.y1) / 2));
+                check_rules({}, {}, {hovered_instance});
+                mark_dirty();
             } else {
                 drawing_mode = ComponentMode;
                 current_component = ResistorType;
@@ -240,20 +797,110 @@ bool CircuitCanvas::on_key_press_event(GdkEventKey* event) {
             std::cout << "Coil Mode\n";
             break;
 
+        case GDK_KEY_v: case GDK_KEY_V:
+            if (hovered_component) edit_value(hovered_component);
+            break;
+
+        case GDK_KEY_b: case GDK_KEY_B:
+            if (event->state & GDK_SHIFT_MASK) redefine_block();
+            else block_from_selection();
+            break;
+
+        case GDK_KEY_x: case GDK_KEY_X:
+            explode_instances();
+            break;
+
+        case GDK_KEY_i: case GDK_KEY_I:
+            place_instance(snap_to_grid(mouse_x), snap_to_grid(mouse_y));
+            break;
+
         case GDK_KEY_m: case GDK_KEY_M:
             drawing_mode = MoveMode;
             std::cout << "Move Mode\n";
             break;
 
+        case GDK_KEY_g: case GDK_KEY_G:
+            use_grid_cache = !use_grid_cache;
+            std::cout << (use_grid_cache ? "Cached grid\n" : "Stroked grid\n");
+            break;
+
+        case GDK_KEY_p: case GDK_KEY_P:
+            set_metrics_overlay(!show_metrics);
+            break;
+
+        case GDK_KEY_d: case GDK_KEY_D:
+            show_rule_markers = !show_rule_markers;
+            std::cout << (show_rule_markers ? "Design rule markers shown\n" : "Design rule markers hidden\n");
+            break;
+
+        case GDK_KEY_plus: case GDK_KEY_equal:
+            zoom_at(pointer_x, pointer_y, 1);
+            break;
+
+        case GDK_KEY_minus:
+            zoom_at(pointer_x, pointer_y, -1);
+            break;
+
+        case GDK_KEY_0:
+            zoom_level = DEFAULT_ZOOM_LEVEL;
+            zoom = 1.0;
+            view_x = 0;
+            view_y = 0;
+            break;
+
+        case GDK_KEY_a: case GDK_KEY_A:
+            if (event->state & GDK_CONTROL_MASK) select_all();
+            break;
+
+        case GDK_KEY_z: case GDK_KEY_Z:
+            if (!(event->state & GDK_CONTROL_MASK)) break;
+            if (event->state & GDK_SHIFT_MASK) redo();
+            else undo();
+            break;
+
+        case GDK_KEY_y: case GDK_KEY_Y:
+            if (event->state & GDK_CONTROL_MASK) redo();
+            break;
+
+        case GDK_KEY_Escape:
+            clear_selection();
+            break;
+
         case GDK_KEY_Delete: case GDK_KEY_BackSpace:
-            if (hovered_component) {
-                components.erase(std::remove(components.begin(), components.end(), hovered_component), components.end());
-                hovered_component = nullptr;
+            if (dragging_selection) break;
+            if (has_selection()) {
+                delete_selection();
+            } else if (hovered_component) {
+                size_t i = design.index_of(hovered_component);
+                history.record_remove_component(design, i);
+                journal.record_delete_component(i);
+                component_index.remove(hovered_component);
+                design.remove_component(i);
+                check_rules({hovered_component}, {});
+                mark_dirty();
+                hovered_component = ComponentHandle{};
                 std::cout << "Component deleted\n";
             } else if (hovered_wire) {
-                wires.erase(std::remove(wires.begin(), wires.end(), hovered_wire), wires.end());
-                hovered_wire = nullptr;
+                size_t i = design.index_of(hovered_wire);
+                history.record_remove_wire(design, i);
+                journal.record_delete_wire(i);
+                wire_index.remove(hovered_wire);
+                design.remove_wire(i);
+                check_rules({}, {hovered_wire});
+                mark_dirty();
+                hovered_wire = WireHandle{};
                 std::cout << "Wire deleted\n";
+            } else if (hovered_instance) {
+                size_t n = design.index_of(hovered_instance);
+                invalidate(design.instance_draw_bounds(n));
+                history.record_remove_instance(design, n);
+                journal.record_delete_instance(n);
+                instance_index.remove(hovered_instance);
+                design.remove_instance(n);
+                check_rules({}, {}, {hovered_instance});
+                mark_dirty();
+                hovered_instance = InstanceHandle{};
+                std::cout << "Block deleted\n";
             }
             break;
     }
@@ -262,60 +909,791 @@ bool CircuitCanvas::on_key_press_event(GdkEventKey* event) {
 }
 
 
-std::shared_ptr<CircuitComponent> CircuitCanvas::get_component_at(double x, double y) {
-    for (auto it = components.rbegin(); it != components.rend(); ++it) {
-        if ((*it)->contains_point(x, y)) {
-            return *it;
+namespace {
+
+// Stacking positions of the candidates, ascending, as the batched hit tests want them.
+template <typename Handle>
+void candidate_positions(const DesignStore& design, const std::vector<Handle>& candidates,
+                         std::vector<uint32_t>& out) {
+    out.clear();
+    for (Handle h : candidates)
+        out.push_back(static_cast<uint32_t>(design.index_of(h)));
+    std::sort(out.begin(), out.end());
+}
+
+}
+
+ComponentHandle CircuitCanvas::get_component_at(double x, double y) {
+    Metrics::Scope scope(metrics, Metrics::HitTest);
+    component_index.candidates_at(x, y, component_candidates);
+    candidate_positions(design, component_candidates, hit_positions);
+    size_t i = topmost_component_at(design, hit_positions, x, y);
+    return i == DesignStore::NPOS ? ComponentHandle{} : design.component_handle(i);
+}
+
+WireHandle CircuitCanvas::get_wire_at(double x, double y) {
+    Metrics::Scope scope(metrics, Metrics::HitTest);
+    wire_index.candidates_at(x, y, wire_candidates);
+    candidate_positions(design, wire_candidates, hit_positions);
+    size_t i = topmost_wire_at(design, hit_positions, x, y);
+    return i == DesignStore::NPOS ? WireHandle{} : design.wire_handle(i);
+}
+
+// Instances are few and each hit test is a walk over a block's parts, so
+// the candidates are tested one by one from the top.
+InstanceHandle CircuitCanvas::get_instance_at(double x, double y) {
+    Metrics::Scope scope(metrics, Metrics::HitTest);
+    instance_index.candidates_at(x, y, instance_candidates);
+    size_t top = DesignStore::NPOS;
+    for (InstanceHandle h : instance_candidates) {
+        size_t n = design.index_of(h);
+        if ((top == DesignStore::NPOS || n > top) && design.instance_contains_point(n, x, y)) top = n;
+    }
+    return top == DesignStore::NPOS ? InstanceHandle{} : design.instance_handle(top);
+}
+
+bool CircuitCanvas::is_selected(ComponentHandle comp) const {
+    return selected_components.contains(comp);
+}
+
+bool CircuitCanvas::is_selected(WireHandle wire) const {
+    return selected_wires.contains(wire);
+}
+
+bool CircuitCanvas::is_selected(InstanceHandle instance) const {
+    return selected_instances.contains(instance);
+}
+
+void CircuitCanvas::clear_selection() {
+    if (!has_selection()) return;
+    invalidate(get_selection_rect());
+    selected_components.clear();
+    selected_wires.clear();
+    selected_instances.clear();
+}
+
+void CircuitCanvas::select_all() {
+    selected_components.clear();
+    selected_wires.clear();
+    selected_instances.clear();
+    for (size_t i = 0; i < design.component_count(); ++i)
+        selected_components.insert(design.component_handle(i));
+    for (size_t i = 0; i < design.wire_count(); ++i)
+        selected_wires.insert(design.wire_handle(i));
+    for (size_t n = 0; n < design.instance_count(); ++n)
+        selected_instances.insert(design.instance_handle(n));
+    queue_draw();
+}
+
+namespace {
+
+// Adds the objects at the found positions to a selection, keeping each once.
+template <typename Handle, typename HandleAt>
+void merge_selection(const DesignStore& design, HandleSet<Handle>& selection,
+                     std::vector<size_t>& found, HandleAt handle_at) {
+    if (found.empty()) return;
+    for (Handle h : selection) {
+        size_t i = design.index_of(h);
+        if (i != DesignStore::NPOS) found.push_back(i);
+    }
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+    selection.clear();
+    for (size_t i : found)
+        selection.insert(handle_at(i));
+}
+
+// Stacking positions of the live handles, ascending.
+template <typename Handle>
+std::vector<size_t> selected_positions(const DesignStore& design, const std::vector<Handle>& selection) {
+    std::vector<size_t> positions;
+    positions.reserve(selection.size());
+    for (Handle h : selection) {
+        size_t i = design.index_of(h);
+        if (i != DesignStore::NPOS) positions.push_back(i);
+    }
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    return positions;
+}
+
+}
+
+// Selects everything lying entirely inside r, tested in batches over the
+// whole store rather than through the index, since a band can cover most
+// of the design.
+void CircuitCanvas::select_in_rect(const Rect& r) {
+    std::vector<size_t> found;
+    components_inside_rect(design, nullptr, r, found);
+    merge_selection(design, selected_components, found, [this](size_t i) { return design.component_handle(i); });
+    found.clear();
+    wires_inside_rect(design, nullptr, r, found);
+    merge_selection(design, selected_wires, found, [this](size_t i) { return design.wire_handle(i); });
+    found.clear();
+    for (size_t n = 0; n < design.instance_count(); ++n) {
+        const Rect b = design.instance_bounds(n);
+        if (r.contains(b.x0, b.y0) && r.contains(b.x1, b.y1)) found.push_back(n);
+    }
+    merge_selection(design, selected_instances, found, [this](size_t n) { return design.instance_handle(n); });
+}
+
+void CircuitCanvas::prune_selection() {
+    selected_components.erase_if([this](ComponentHandle h) { return design.index_of(h) == DesignStore::NPOS; });
+    selected_wires.erase_if([this](WireHandle h) { return design.index_of(h) == DesignStore::NPOS; });
+    selected_instances.erase_if([this](InstanceHandle h) { return design.index_of(h) == DesignStore::NPOS; });
+}
+
+Rect CircuitCanvas::get_selection_rect() const {
+    Rect r;
+    for (ComponentHandle comp : selected_components) {
+        size_t i = design.index_of(comp);
+        if (i != DesignStore::NPOS) r = r.united(design.geometry(i).draw_bounds());
+    }
+    for (WireHandle wire : selected_wires) {
+        size_t i = design.index_of(wire);
+        if (i != DesignStore::NPOS) r = r.united(design.wire_bounds(i));
+    }
+    for (InstanceHandle instance : selected_instances) {
+        size_t n = design.index_of(instance);
+        if (n != DesignStore::NPOS) r = r.united(design.instance_draw_bounds(n));
+    }
+    return r;
+}
+
+Rect CircuitCanvas::get_rubber_band_rect() const {
+    return Rect::from_points(select_start_x, select_start_y, mouse_x, mouse_y);
+}
+
+void CircuitCanvas::move_selection(double dx, double dy) {
+    prune_selection();
+    if (!has_selection()) return;
+    const DesignStore::ComponentColumns& comps = design.components();
+    for (ComponentHandle comp : selected_components) {
+        size_t i = design.index_of(comp);
+        design.move_component(i, comps.x[i] + dx, comps.y[i] + dy);
+        component_index.update(comp, design.geometry(i).draw_bounds());
+    }
+    const DesignStore::WireColumns& ws = design.wires();
+    for (WireHandle wire : selected_wires) {
+        size_t i = design.index_of(wire);
+        design.move_wire(i, ws.x1[i] + dx, ws.y1[i] + dy, ws.x2[i] + dx, ws.y2[i] + dy);
+        wire_index.update(wire, design.wire_bounds(i));
+    }
+    const DesignStore::InstanceColumns& ns = design.instances();
+    for (InstanceHandle instance : selected_instances) {
+        size_t n = design.index_of(instance);
+        design.move_instance(n, ns.x[n] + dx, ns.y[n] + dy);
+        instance_index.update(instance, design.instance_draw_bounds(n));
+    }
+    mark_dirty();
+}
+
+// Where the selection is before a drag or rotation, as one undo step.
+void CircuitCanvas::record_selection_moves() {
+    history.begin_group();
+    for (ComponentHandle comp : selected_components) {
+        size_t i = design.index_of(comp);
+        if (i != DesignStore::NPOS) history.record_move_component(design, i);
+    }
+    for (WireHandle wire : selected_wires) {
+        size_t i = design.index_of(wire);
+        if (i != DesignStore::NPOS) history.record_move_wire(design, i);
+    }
+    for (InstanceHandle instance : selected_instances) {
+        size_t n = design.index_of(instance);
+        if (n != DesignStore::NPOS) history.record_move_instance(design, n);
+    }
+    history.end_group();
+}
+
+void CircuitCanvas::journal_selection_moves() {
+    const DesignStore::ComponentColumns& comps = design.components();
+    for (ComponentHandle comp : selected_components) {
+        size_t i = design.index_of(comp);
+        if (i != DesignStore::NPOS) journal.record_move_component(i, comps.x[i], comps.y[i]);
+    }
+    const DesignStore::WireColumns& ws = design.wires();
+    for (WireHandle wire : selected_wires) {
+        size_t i = design.index_of(wire);
+        if (i != DesignStore::NPOS) journal.record_move_wire(i, ws.x1[i], ws.y1[i], ws.x2[i], ws.y2[i]);
+    }
+    const DesignStore::InstanceColumns& ns = design.instances();
+    for (InstanceHandle instance : selected_instances) {
+        size_t n = design.index_of(instance);
+        if (n != DesignStore::NPOS) journal.record_move_instance(n, ns.x[n], ns.y[n], ns.rotation[n]);
+    }
+}
+
+// Turns the selection a quarter turn clockwise around the grid point
+// nearest its center, so parts on the grid stay on it.
+void CircuitCanvas::rotate_selection() {
+    prune_selection();
+    if (!has_selection()) return;
+    Rect extent;
+    for (ComponentHandle comp : selected_components)
+        extent = extent.united(design.geometry(design.index_of(comp)).bounds());
+    for (WireHandle wire : selected_wires) {
+        size_t i = design.index_of(wire);
+        const DesignStore::WireColumns& ws = design.wires();
+        extent = extent.united(Rect::from_points(ws.x1[i], ws.y1[i], ws.x2[i], ws.y2[i]));
+    }
+    for (InstanceHandle instance : selected_instances)
+        extent = extent.united(design.instance_bounds(design.index_of(instance)));
+    const double px = snap_to_grid((extent.x0 + extent.x1) / 2);
+    const double py = snap_to_grid((extent.y0 + extent.y1) / 2);
+    invalidate(get_selection_rect());
+
+    history.begin_group();
+    record_selection_moves();
+    for (ComponentHandle comp : selected_components)
+        history.record_rotate_component(design, design.index_of(comp));
+    history.end_group();
+
+    const DesignStore::ComponentColumns& comps = design.components();
+    for (ComponentHandle comp : selected_components) {
+        size_t i = design.index_of(comp);
+        double cx = comps.x[i] + comps.width[i] / 2;
+        double cy = comps.y[i] + comps.height[i] / 2;
+        double rotation = comps.rotation[i] + 90.0;
+        if (rotation >= 360.0) rotation -= 360.0;
+        design.move_component(i, px - (cy - py) - comps.width[i] / 2, py + (cx - px) - comps.height[i] / 2);
+        design.set_rotation(i, rotation);
+        component_index.update(comp, design.geometry(i).draw_bounds());
+        journal.record_rotate_component(i, rotation);
+        journal.record_move_component(i, comps.x[i], comps.y[i]);
+    }
+    const DesignStore::WireColumns& ws = design.wires();
+    for (WireHandle wire : selected_wires) {
+        size_t i = design.index_of(wire);
+        design.move_wire(i, px - (ws.y1[i] - py), py + (ws.x1[i] - px), px - (ws.y2[i] - py), py + (ws.x2[i] - px));
+        wire_index.update(wire, design.wire_bounds(i));
+        journal.record_move_wire(i, ws.x1[i], ws.y1[i], ws.x2[i], ws.y2[i]);
+    }
+    for (InstanceHandle instance : selected_instances)
+        rotate_instance(design.index_of(instance), px, py);
+    check_rules(selected_components, selected_wires, selected_instances);
+    mark_dirty();
+    invalidate(get_selection_rect());
+}
+
+// A quarter turn clockwise around (px, py). The whole placement turns, so
+// the block's parts turn with it.
+void CircuitCanvas::rotate_instance(size_t n, double px, double py) {
+    const DesignStore::InstanceColumns& ns = design.instances();
+    double rotation = ns.rotation[n] + 90.0;
+    if (rotation >= 360.0) rotation -= 360.0;
+    design.move_instance(n, px - (ns.y[n] - py), py + (ns.x[n] - px));
+    design.set_instance_rotation(n, rotation);
+    instance_index.update(design.instance_handle(n), design.instance_draw_bounds(n));
+    journal.record_move_instance(n, ns.x[n], ns.y[n], rotation);
+    invalidate(design.instance_draw_bounds(n));
+}
+
+// Removes the whole selection with one compaction pass per column. The
+// journal gets the deletes at descending positions, which replay applies
+// as one pass too.
+void CircuitCanvas::delete_selection() {
+    std::vector<size_t> comps = selected_positions(design, selected_components.items());
+    std::vector<size_t> wires = selected_positions(design, selected_wires.items());
+    std::vector<size_t> instances = selected_positions(design, selected_instances.items());
+    invalidate(get_selection_rect());
+
+    history.begin_group();
+    for (auto i = comps.rbegin(); i != comps.rend(); ++i)
+        history.record_remove_component(design, *i);
+    for (auto i = wires.rbegin(); i != wires.rend(); ++i)
+        history.record_remove_wire(design, *i);
+    for (auto n = instances.rbegin(); n != instances.rend(); ++n)
+        history.record_remove_instance(design, *n);
+    history.end_group();
+
+    for (auto i = comps.rbegin(); i != comps.rend(); ++i) {
+        journal.record_delete_component(*i);
+        component_index.remove(design.component_handle(*i));
+    }
+    for (auto i = wires.rbegin(); i != wires.rend(); ++i) {
+        journal.record_delete_wire(*i);
+        wire_index.remove(design.wire_handle(*i));
+    }
+    for (auto n = instances.rbegin(); n != instances.rend(); ++n) {
+        journal.record_delete_instance(*n);
+        instance_index.remove(design.instance_handle(*n));
+        design.remove_instance(*n);
+    }
+    design.remove_components(comps);
+    design.remove_wires(wires);
+    check_rules(selected_components, selected_wires, selected_instances);
+
+    selected_components.clear();
+    selected_wires.clear();
+    selected_instances.clear();
+    if (design.index_of(hovered_component) == DesignStore::NPOS) hovered_component = ComponentHandle{};
+    if (design.index_of(hovered_wire) == DesignStore::NPOS) hovered_wire = WireHandle{};
+    if (design.index_of(hovered_instance) == DesignStore::NPOS) hovered_instance = InstanceHandle{};
+    mark_dirty();
+    std::cout << comps.size() << " components and " << wires.size() << " wires deleted\n";
+    if (!instances.empty()) std::cout << instances.size() << " blocks deleted\n";
+}
+
+// Replaces the selected parts and wires with one instance, placed at `at`,
+// of a new block holding them. The journal can't hold the new definition,
+// so it is dropped and the next save writes the whole design.
+uint32_t CircuitCanvas::make_block(const Placement& at, const std::string& name) {
+    DesignStore contents;
+    const DesignStore::ComponentColumns& comps = design.components();
+    for (size_t i : selected_positions(design, selected_components.items())) {
+        const ComponentGeometry g = at.to_local(design.geometry(i));
+        contents.add_component(g.kind, g.x, g.y, g.width, g.height, g.rotation, comps.value[i]);
+    }
+    const DesignStore::WireColumns& ws = design.wires();
+    for (size_t i : selected_positions(design, selected_wires.items())) {
+        double x1, y1, x2, y2;
+        at.to_local(ws.x1[i], ws.y1[i], x1, y1);
+        at.to_local(ws.x2[i], ws.y2[i], x2, y2);
+        contents.add_wire(x1, y1, x2, y2);
+    }
+    const uint32_t definition =
+        design.add_definition(std::make_shared<const SubcircuitDefinition>(name, std::move(contents)));
+
+    history.begin_group();
+    delete_selection();
+    InstanceHandle instance = design.add_instance(definition, at.x, at.y, at.rotation);
+    const size_t n = design.index_of(instance);
+    history.record_add_instance(n);
+    history.end_group();
+    journal.record_add_instance(design.instance_row(n));
+    journal.detach();
+    instance_index.insert(instance, design.instance_draw_bounds(n));
+    check_rules({}, {}, {instance});
+    selected_instances.insert(instance);
+    invalidate(design.instance_draw_bounds(n));
+    return definition;
+}
+
+// B: the selection becomes a block with its origin at the grid point at
+// its top-left.
+void CircuitCanvas::block_from_selection() {
+    prune_selection();
+    if (!selected_instances.empty()) {
+        std::cerr << "Blocks can't hold other blocks; explode them first" << std::endl;
+        return;
+    }
+    if (selected_components.empty() && selected_wires.empty()) return;
+    const Rect extent = get_selection_rect();
+    const std::string name = "Block " + std::to_string(design.definition_count() + 1);
+    current_definition = make_block(Placement{snap_to_grid(extent.x0), snap_to_grid(extent.y0), 0}, name);
+    exploded_definition = NO_DEFINITION;
+    std::cout << name << " made\n";
+}
+
+// Shift+B: builds the block last exploded again from the selection, where
+// the exploded instance was, and points every instance of it at the result.
+void CircuitCanvas::redefine_block() {
+    prune_selection();
+    if (exploded_definition == NO_DEFINITION) {
+        std::cerr << "No exploded block to update; explode one with X first" << std::endl;
+        return;
+    }
+    if (!selected_instances.empty()) {
+        std::cerr << "Blocks can't hold other blocks; explode them first" << std::endl;
+        return;
+    }
+    if (selected_components.empty() && selected_wires.empty()) return;
+
+    const uint32_t old_definition = exploded_definition;
+    const std::string name = design.definition(old_definition).name();
+    history.begin_group();
+    const uint32_t definition = make_block(exploded_at, name);
+    std::vector<InstanceHandle> changed;
+    for (size_t n = 0; n < design.instance_count(); ++n) {
+        if (design.instances().definition[n] != old_definition) continue;
+        invalidate(design.instance_draw_bounds(n));
+        history.record_set_instance_definition(design, n);
+        design.set_instance_definition(n, definition);
+        journal.record_set_instance_definition(n, definition);
+        instance_index.update(design.instance_handle(n), design.instance_draw_bounds(n));
+        invalidate(design.instance_draw_bounds(n));
+        changed.push_back(design.instance_handle(n));
+    }
+    history.end_group();
+    check_rules({}, {}, changed);
+    mark_dirty();
+    current_definition = definition;
+    exploded_definition = NO_DEFINITION;
+    std::cout << name << " updated in " << changed.size() + 1 << " places\n";
+}
+
+// X: replaces the selected instances, or the hovered one, with the parts
+// and wires they place, and selects those.
+void CircuitCanvas::explode_instances() {
+    prune_selection();
+    std::vector<InstanceHandle> targets = selected_instances;
+    if (targets.empty() && hovered_instance) targets.push_back(hovered_instance);
+    const std::vector<size_t> positions = selected_positions(design, targets);
+    if (positions.empty()) return;
+    clear_selection();
+
+    history.begin_group();
+    for (auto p = positions.rbegin(); p != positions.rend(); ++p) {
+        const size_t n = *p;
+        const size_t first_component = design.component_count(), first_wire = design.wire_count();
+        design.expand_instance(n);
+        for (size_t i = first_component; i < design.component_count(); ++i) {
+            const ComponentGeometry g = design.geometry(i);
+            component_index.insert(design.component_handle(i), g.draw_bounds());
+            history.record_add_component(i);
+            journal.record_add_component(g, design.components().value[i]);
+            selected_components.insert(design.component_handle(i));
+        }
+        const DesignStore::WireColumns& ws = design.wires();
+        for (size_t i = first_wire; i < design.wire_count(); ++i) {
+            wire_index.insert(design.wire_handle(i), design.wire_bounds(i));
+            history.record_add_wire(i);
+            journal.record_add_wire(ws.x1[i], ws.y1[i], ws.x2[i], ws.y2[i]);
+            selected_wires.insert(design.wire_handle(i));
         }
+
+        exploded_definition = design.instances().definition[n];
+        exploded_at = design.placement(n);
+        invalidate(design.instance_draw_bounds(n));
+        history.record_remove_instance(design, n);
+        journal.record_delete_instance(n);
+        instance_index.remove(design.instance_handle(n));
+        design.remove_instance(n);
+    }
+    history.end_group();
+    check_rules(selected_components, selected_wires, targets);
+    if (design.index_of(hovered_instance) == DesignStore::NPOS) hovered_instance = InstanceHandle{};
+    mark_dirty();
+    invalidate(get_selection_rect());
+}
+
+// I: another instance of the last block made, with its origin at (x, y).
+void CircuitCanvas::place_instance(double x, double y) {
+    if (current_definition == NO_DEFINITION) {
+        std::cerr << "No block to place; make one with B first" << std::endl;
+        return;
+    }
+    InstanceHandle instance = design.add_instance(current_definition, x, y, 0);
+    const size_t n = design.index_of(instance);
+    instance_index.insert(instance, design.instance_draw_bounds(n));
+    journal.record_add_instance(design.instance_row(n));
+    history.record_add_instance(n);
+    check_rules({}, {}, {instance});
+    mark_dirty();
+    invalidate(design.instance_draw_bounds(n));
+}
+
+// Asks for a new value in SPICE notation, e.g. "4.7k" or "100n".
+void CircuitCanvas::edit_value(ComponentHandle comp) {
+    const ComponentKind kind = design.components().kind[design.index_of(comp)];
+    Gtk::Window* window = dynamic_cast<Gtk::Window*>(get_toplevel());
+    Gtk::Dialog dialog(std::string(component_type_name(kind)) + " Value", true);
+    if (window) dialog.set_transient_for(*window);
+    dialog.add_button("_Cancel", Gtk::RESPONSE_CANCEL);
+    dialog.add_button("_OK", Gtk::RESPONSE_OK);
+    dialog.set_default_response(Gtk::RESPONSE_OK);
+
+    Gtk::Entry entry;
+    entry.set_text(format_si_value(design.components().value[design.index_of(comp)]));
+    entry.set_activates_default(true);
+    dialog.get_content_area()->pack_start(entry);
+    dialog.show_all();
+
+    if (dialog.run() != Gtk::RESPONSE_OK) return;
+    double value;
+    if (!parse_si_value(entry.get_text(), value) || !(value > 0)) {
+        std::cerr << "Invalid value: " << entry.get_text() << std::endl;
+        return;
     }
-    return nullptr;
+    // The dialog runs a nested main loop, so the part may be gone by now.
+    size_t i = design.index_of(comp);
+    if (i == DesignStore::NPOS || value == design.components().value[i]) return;
+    history.record_set_value(design, i);
+    design.set_value(i, value);
+    journal.record_set_value(i, value);
+    mark_dirty();
+    invalidate_screen(get_label_rect());
 }
 
 bool CircuitCanvas::save_to_file(const std::string& filename) {
-    try {
-        nlohmann::json j;
-        j["components"] = nlohmann::json::array();
-        for (const auto& comp : components) {
-            j["components"].push_back(comp->serialize());
-        }
+    Metrics::Scope scope(metrics, Metrics::Save);
+    if (!save_design_atomic(filename, design)) return false;
+    current_filename = filename;
+    saved_generation = edit_generation;
+    if (journal.is_recording() && !compaction_pending)
+        journal.reset(filename, design_checksum(design), design.component_count(), design.wire_count(),
+                      journal.pending_count(), design.placed_definition_numbers());
+    return true;
+}
 
-        j["wires"] = nlohmann::json::array();
-        for (const auto& wire : wires) {
-            j["wires"].push_back(wire->serialize());
-        }
+void CircuitCanvas::save_to_file_async(const std::string& filename) {
+    Metrics::Scope scope(metrics, Metrics::Save);
+    if (commit_journal(filename)) return;
 
-        std::ofstream file(filename);
-        if (!file.is_open()) return false;
-        file << j.dump(4);  
-        return true;
-    } catch (...) {
+    if (journal.is_recording()) {
+        compaction_pending = true;
+        compaction_filename = filename;
+        compaction_generation = edit_generation;
+        compaction_components = design.component_count();
+        compaction_wires = design.wire_count();
+        compaction_included = journal.pending_count();
+        compaction_definitions = design.placed_definition_numbers();
+    }
+    timing_save = metrics.is_enabled();
+    if (timing_save) {
+        timed_save_generation = edit_generation;
+        save_requested = Metrics::Clock::now();
+    }
+    saver.save(filename, design, edit_generation, false, journal.is_recording());
+}
+
+// Appends pending edits to the journal of the current file. Returns false when
+// a full save is needed instead: no journal yet, a different file, a full save
+// still in flight, a journal long enough that rewriting it is cheaper to load,
+// or a commit that failed: one that couldn't be written, or that places a
+// block the snapshot left out.
+bool CircuitCanvas::commit_journal(const std::string& filename) {
+    if (!journal.is_recording() || compaction_pending || filename != current_filename ||
+        !journal.is_attached_to(filename))
+        return false;
+
+    size_t limit = std::max(MIN_JOURNAL_COMPACTION, (design.component_count() + design.wire_count()) / 2);
+    if (journal.written_count() + journal.pending_count() > limit) return false;
+
+    uint64_t generation = edit_generation;
+    if (!journal.commit(design)) {
+        std::cerr << "Failed to commit journal for " << filename << ", saving in full" << std::endl;
+        journal.detach();
         return false;
     }
+    saved_generation = generation;
+
+    AsyncSaver::Status status{AsyncSaver::Status::Finished, filename, generation, false, 0};
+    if (save_status_callback) save_status_callback(status);
+    return true;
 }
 
-bool CircuitCanvas::load_from_file(const std::string& filename) {
-    try {
-        std::ifstream file(filename);
-        if (!file.is_open()) return false;
+void CircuitCanvas::set_journal_enabled(bool enabled) {
+    if (enabled == journal.is_recording()) return;
+    journal.detach();
+    journal.set_recording(enabled);
+    compaction_pending = false;
+}
 
-        nlohmann::json j;
-        file >> j;
+void CircuitCanvas::set_autosave_enabled(bool enabled) {
+    autosave_connection.disconnect();
+    if (enabled) {
+        autosave_connection = Glib::signal_timeout().connect_seconds(
+            sigc::mem_fun(*this, &CircuitCanvas::on_autosave_timeout), AUTOSAVE_INTERVAL_SECONDS);
+    }
+}
 
-        components.clear();
-        wires.clear();
+// Autosave only writes when there are edits that are neither saved nor autosaved.
+bool CircuitCanvas::on_autosave_timeout() {
+    if (is_dirty() && edit_generation != autosaved_generation && !saver.busy())
+        saver.save(autosave_path(), design, edit_generation, true);
+    return true;
+}
 
-        for (const auto& jc : j["components"]) {
-            components.push_back(CircuitComponent::deserialize(jc));
+void CircuitCanvas::on_save_status(const AsyncSaver::Status& status) {
+    if (status.state == AsyncSaver::Status::Finished) {
+        if (status.autosave) {
+            autosaved_generation = status.generation;
+        } else {
+            current_filename = status.filename;
+            saved_generation = std::max(saved_generation, status.generation);
+            if (timing_save && status.generation == timed_save_generation) {
+                metrics.record(Metrics::SaveComplete, save_requested);
+                timing_save = false;
+            }
         }
+    }
 
-        for (const auto& jw : j["wires"]) {
-            wires.push_back(Wire::deserialize(jw));
+    // Older full saves finishing first have already dropped the journal;
+    // only the newest one restarts it.
+    if (compaction_pending && !status.autosave && status.filename == compaction_filename &&
+        status.generation == compaction_generation) {
+        if (status.state == AsyncSaver::Status::Finished) {
+            compaction_pending = false;
+            journal.reset(compaction_filename, status.checksum, compaction_components,
+                          compaction_wires, compaction_included, std::move(compaction_definitions));
+        } else if (status.state == AsyncSaver::Status::Failed) {
+            compaction_pending = false;
+            journal.detach();
         }
+    }
+    if (save_status_callback) save_status_callback(status);
+}
 
-        queue_draw();  
-        return true;
-    } catch (...) {
-        return false;
+// design.json autosaves to design.autosave.json; untitled designs go to the temp directory.
+std::string CircuitCanvas::autosave_path() const {
+    if (current_filename.empty())
+        return (std::filesystem::temp_directory_path() / "ACad-untitled.autosave.json").string();
+
+    std::filesystem::path path(current_filename);
+    std::string name = path.stem().string() + ".autosave" + path.extension().string();
+    return (path.parent_path() / name).string();
+}
+
+bool CircuitCanvas::load_from_file(const std::string& filename) {
+    Metrics::Scope scope(metrics, Metrics::Load);
+    DesignStore loaded;
+    bool journal_replayed;
+    if (!load_design(filename, loaded, journal_replayed)) return false;
+
+    design = std::move(loaded);
+    hovered_component = ComponentHandle{};
+    hovered_wire = WireHandle{};
+    hovered_instance = InstanceHandle{};
+    clear_selection();
+    current_definition = design.definition_count() > 0 ? design.definition_count() - 1 : NO_DEFINITION;
+    exploded_definition = NO_DEFINITION;
+    selecting = false;
+    dragging_selection = false;
+    history.clear();
+    rebuild_indexes();
+    rules.check_all(design);
+    rule_markers_stale = true;
+    if (size_t count = rules.violation_count())
+        std::cout << count << " design rule violations\n";
+
+    current_filename = filename;
+    saved_generation = autosaved_generation = ++edit_generation;
+
+    // A design without a usable journal gets a fresh one on its next full save.
+    compaction_pending = false;
+    if (journal.is_recording() && journal_replayed)
+        journal.attach(filename, design);
+    else
+        journal.detach();
+    queue_draw();
+    return true;
+}
+
+// Replaces a straight wire with an orthogonal route around the parts in
+// the way. The route's segments are added and undone together.
+void CircuitCanvas::route_wire(double x1, double y1, double x2, double y2) {
+    // Parts inside blocks are in the way too.
+    const DesignStore flat = design.instance_count() > 0 ? design.flattened() : DesignStore{};
+    Router router(design.instance_count() > 0 ? flat : design);
+    RoutePath path;
+    if (!router.route(RouteRequest{x1, y1, x2, y2}, path)) {
+        std::cerr << "No route found" << std::endl;
+        return;
+    }
+    const size_t first = design.wire_count();
+    add_route_wires(design, path);
+    std::vector<WireHandle> added;
+    history.begin_group();
+    for (size_t i = first; i < design.wire_count(); ++i) {
+        const DesignStore::WireColumns& ws = design.wires();
+        added.push_back(design.wire_handle(i));
+        wire_index.insert(design.wire_handle(i), design.wire_bounds(i));
+        journal.record_add_wire(ws.x1[i], ws.y1[i], ws.x2[i], ws.y2[i]);
+        history.record_add_wire(i);
+        invalidate(design.wire_bounds(i));
     }
+    history.end_group();
+    check_rules({}, added);
+    mark_dirty();
 }
 
+void CircuitCanvas::rebuild_indexes() {
+    component_index.clear();
+    wire_index.clear();
+    for (size_t i = 0; i < design.component_count(); ++i)
+        component_index.insert(design.component_handle(i), design.geometry(i).draw_bounds());
+    for (size_t i = 0; i < design.wire_count(); ++i)
+        wire_index.insert(design.wire_handle(i), design.wire_bounds(i));
+    instance_index.clear();
+    for (size_t n = 0; n < design.instance_count(); ++n)
+        instance_index.insert(design.instance_handle(n), design.instance_draw_bounds(n));
+}
+
+// Re-checks the design rules around objects just added, moved, rotated or
+// removed.
+void CircuitCanvas::check_rules(const std::vector<ComponentHandle>& components, const std::vector<WireHandle>& wires,
+                               const std::vector<InstanceHandle>& instances) {
+    rules.update(design, components, wires, instances);
+    rule_markers_stale = true;
+}
+
+bool CircuitCanvas::undo() {
+    if (dragging_selection || drawing_wire) return false;
+    if (!history.undo(design, journal, history_changes)) return false;
+    apply_history_changes();
+    return true;
+}
+
+bool CircuitCanvas::redo() {
+    if (dragging_selection || drawing_wire) return false;
+    if (!history.redo(design, journal, history_changes)) return false;
+    apply_history_changes();
+    return true;
+}
+
+// Brings the indexes up to date with what the last undo or redo changed.
+// Objects put back below others are out of the indexes' insertion order,
+// so those steps rebuild them instead.
+void CircuitCanvas::apply_history_changes() {
+    const HistoryChanges& changes = history_changes;
+    if (changes.reordered) {
+        rebuild_indexes();
+    } else {
+        for (ComponentHandle comp : changes.removed_components) component_index.remove(comp);
+        for (WireHandle wire : changes.removed_wires) wire_index.remove(wire);
+        for (ComponentHandle comp : changes.changed_components) {
+            size_t i = design.index_of(comp);
+            if (i == DesignStore::NPOS) continue;
+            if (component_index.contains(comp)) component_index.update(comp, design.geometry(i).draw_bounds());
+            else component_index.insert(comp, design.geometry(i).draw_bounds());
+        }
+        for (WireHandle wire : changes.changed_wires) {
+            size_t i = design.index_of(wire);
+            if (i == DesignStore::NPOS) continue;
+            if (wire_index.contains(wire)) wire_index.update(wire, design.wire_bounds(i));
+            else wire_index.insert(wire, design.wire_bounds(i));
+        }
+        for (InstanceHandle instance : changes.removed_instances) instance_index.remove(instance);
+        for (InstanceHandle instance : changes.changed_instances) {
+            size_t n = design.index_of(instance);
+            if (n == DesignStore::NPOS) continue;
+            if (instance_index.contains(instance)) instance_index.update(instance, design.instance_draw_bounds(n));
+            else instance_index.insert(instance, design.instance_draw_bounds(n));
+        }
+    }
+    std::vector<ComponentHandle> comps = changes.changed_components;
+    comps.insert(comps.end(), changes.removed_components.begin(), changes.removed_components.end());
+    std::vector<WireHandle> wires = changes.changed_wires;
+    wires.insert(wires.end(), changes.removed_wires.begin(), changes.removed_wires.end());
+    std::vector<InstanceHandle> instances = changes.changed_instances;
+    instances.insert(instances.end(), changes.removed_instances.begin(), changes.removed_instances.end());
+    check_rules(comps, wires, instances);
+    prune_selection();
+    if (design.index_of(hovered_component) == DesignStore::NPOS) hovered_component = ComponentHandle{};
+    if (design.index_of(hovered_wire) == DesignStore::NPOS) hovered_wire = WireHandle{};
+    if (design.index_of(hovered_instance) == DesignStore::NPOS) hovered_instance = InstanceHandle{};
+    mark_dirty();
+    queue_draw();
+}
+
+bool CircuitCanvas::export_netlist(const std::string& filename) const {
+    ComponentList components;
+    WireList wires;
+    design.to_lists(components, wires);
+    return export_spice_netlist(filename, components, wires);
+}
+
+bool CircuitCanvas::export_image(const std::string& filename) {
+    ExportFormat format;
+    if (!export_format_for(filename, format)) {
+        std::cerr << "Unknown image format: " << filename << std::endl;
+        return false;
+    }
+    ExportOptions options;
+    if (has_selection())
+        options.region = get_selection_rect().expanded(options.margin);
+    exporter.export_image(filename, design, format, options);
+    return true;
+}
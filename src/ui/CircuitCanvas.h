@@ -6,23 +6,60 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <optional>
 #include <gtkmm.h>
-#include "../core/CircuitComponent.h"
-#include "../core/Resistor.h"
-#include "../core/Capacitor.h"
-#include "../core/Transistor.h"
-#include "../core/Coil.h"
+#include "../core/DesignRules.h"
+#include "../core/DesignStore.h"
 #include "../core/Wire.h"
+#include "../core/SpatialIndex.h"
+#include "../core/Subcircuit.h"
+#include "../core/Journal.h"
+#include "../core/EditHistory.h"
+#include "../util/Metrics.h"
+#include "AsyncExporter.h"
+#include "AsyncSaver.h"
+#include "HandleSet.h"
 
 class CircuitCanvas : public Gtk::DrawingArea {
 public:
     enum Mode { ComponentMode, WireMode, MoveMode };
     enum ComponentType { ResistorType, CapacitorType, TransistorType, CoilType };
     CircuitCanvas();
-    void add_component(std::shared_ptr<CircuitComponent> comp);
+    // Places a part of the given kind with its default size and value.
+    void add_component(ComponentKind kind, double x, double y);
     void set_mode(Mode m) { drawing_mode = m; }
     bool save_to_file(const std::string& filename);
     bool load_from_file(const std::string& filename);
+    bool export_netlist(const std::string& filename) const;
+    // PNG, SVG or PDF by extension, of the selection if there is one and
+    // of the whole design otherwise. Renders a snapshot on the exporter's
+    // worker thread; false if the extension names no format.
+    bool export_image(const std::string& filename);
+    void set_export_status_callback(std::function<void(const AsyncExporter::Status&)> callback) {
+        exporter.set_status_callback(std::move(callback));
+    }
+
+    // Captures a snapshot and writes it on the saver's worker thread.
+    void save_to_file_async(const std::string& filename);
+    void set_autosave_enabled(bool enabled);
+    // When on, saves to the current file append the edits since the last
+    // save to its journal instead of rewriting the whole design.
+    void set_journal_enabled(bool enabled);
+    void set_save_status_callback(std::function<void(const AsyncSaver::Status&)> callback) {
+        save_status_callback = std::move(callback);
+    }
+    bool is_dirty() const { return edit_generation != saved_generation; }
+
+    // Ctrl+Z and Ctrl+Shift+Z / Ctrl+Y. A loaded design starts with an
+    // empty history; ACAD_UNDO_MB overrides the default memory cap.
+    bool undo();
+    bool redo();
+    void set_undo_memory_limit(size_t bytes) { history.set_memory_limit(bytes); }
+
+    // Timing probes are recorded while the overlay is shown, or always when
+    // ACAD_FRAME_STATS is set. "-" dumps to standard output.
+    void set_metrics_overlay(bool visible);
+    bool dump_metrics(const std::string& filename) const { return metrics.dump(filename); }
 
 protected:
     bool on_draw(const Cairo::RefPtr<Cairo::Context>& cr) override;
@@ -30,22 +67,191 @@ protected:
     bool on_button_release_event(GdkEventButton* event) override;
     bool on_motion_notify_event(GdkEventMotion* event) override;
     bool on_key_press_event(GdkEventKey* event) override;
+    bool on_scroll_event(GdkEventScroll* event) override;
 
 private:
-    std::shared_ptr<CircuitComponent> get_component_at(double x, double y);
-    std::vector<std::shared_ptr<CircuitComponent>> components;
-    std::vector<std::shared_ptr<Wire>> wires;
+    bool on_motion_tick(const Glib::RefPtr<Gdk::FrameClock>& clock);
+    void flush_motion();
+    void handle_motion(double sx, double sy);
+    ComponentHandle get_component_at(double x, double y);
+    WireHandle get_wire_at(double x, double y);
+    InstanceHandle get_instance_at(double x, double y);
+    void edit_value(ComponentHandle comp);
+    bool is_selected(ComponentHandle comp) const;
+    bool is_selected(WireHandle wire) const;
+    bool is_selected(InstanceHandle instance) const;
+    bool has_selection() const {
+        return !selected_components.empty() || !selected_wires.empty() || !selected_instances.empty();
+    }
+    void clear_selection();
+    void select_all();
+    void select_in_rect(const Rect& r);
+    void prune_selection();
+    Rect get_selection_rect() const;
+    Rect get_rubber_band_rect() const;
+    void move_selection(double dx, double dy);
+    void journal_selection_moves();
+    void record_selection_moves();
+    void rotate_selection();
+    void delete_selection();
+    void rotate_instance(size_t i, double px, double py);
+    uint32_t make_block(const Placement& at, const std::string& name);
+    void block_from_selection();
+    void redefine_block();
+    void explode_instances();
+    void place_instance(double x, double y);
+    void route_wire(double x1, double y1, double x2, double y2);
+    void apply_history_changes();
+    void rebuild_indexes();
+    void check_rules(const std::vector<ComponentHandle>& components, const std::vector<WireHandle>& wires,
+                     const std::vector<InstanceHandle>& instances = {});
+    void draw_rule_markers(const Cairo::RefPtr<Cairo::Context>& cr, const Rect& visible);
+    void mark_dirty() { ++edit_generation; }
+    bool on_autosave_timeout();
+    void on_save_status(const AsyncSaver::Status& status);
+    std::string autosave_path() const;
+    bool commit_journal(const std::string& filename);
+    void to_world(double sx, double sy, double& wx, double& wy) const;
+    Rect to_world(const Rect& r) const;
+    Rect to_screen(const Rect& r) const;
+    void apply_view(const Cairo::RefPtr<Cairo::Context>& cr) const;
+    void zoom_at(double sx, double sy, int steps);
+    void pan_by(double dx, double dy);
+    void invalidate(const Rect& r);
+    void invalidate_screen(const Rect& r);
+    Rect get_hover_rect() const;
+    Rect get_label_rect() const;
+    void draw_grid_lines(const Cairo::RefPtr<Cairo::Context>& cr, const Rect& area);
+    void draw_cached_grid(const Cairo::RefPtr<Cairo::Context>& cr, const Rect& area);
+    void build_grid_pattern(int spacing, int scale);
+    void draw_lod(const Cairo::RefPtr<Cairo::Context>& cr, const Rect& visible);
+    void draw_instances(const Cairo::RefPtr<Cairo::Context>& cr, const Rect& visible);
+    Rect get_metrics_rect() const;
+    void draw_metrics(const Cairo::RefPtr<Cairo::Context>& cr);
+    // Hovered and selected objects are held by handle, so deleting or
+    // reloading anything can't leave them pointing at the wrong part.
+    DesignStore design;
+    SpatialIndex<ComponentHandle> component_index;
+    SpatialIndex<WireHandle> wire_index;
+    SpatialIndex<InstanceHandle> instance_index;
+    // Scratch for hit tests, kept to avoid allocating per motion event.
+    std::vector<ComponentHandle> component_candidates;
+    std::vector<WireHandle> wire_candidates;
+    std::vector<InstanceHandle> instance_candidates;
+    std::vector<uint32_t> hit_positions;
     bool drawing_wire = false;
-    std::shared_ptr<Wire> temp_wire;
+    std::optional<Wire> temp_wire;
     Mode drawing_mode = ComponentMode;
     ComponentType current_component = ResistorType;
     double mouse_x = 0;
     double mouse_y = 0;
-    std::shared_ptr<CircuitComponent> hovered_component = nullptr;
-    std::shared_ptr<Wire> hovered_wire = nullptr;
-    std::shared_ptr<CircuitComponent> dragged_component = nullptr;
-    double drag_offset_x = 0;
-    double drag_offset_y = 0;
+    double pointer_x = 0;
+    double pointer_y = 0;
+    double label_width = 120;
+    ComponentHandle hovered_component;
+    WireHandle hovered_wire;
+    InstanceHandle hovered_instance;
+    // The selection, in stacking order while nothing is toggled. Handles
+    // of objects deleted since are skipped and pruned by bulk operations.
+    HandleSet<ComponentHandle> selected_components;
+    HandleSet<WireHandle> selected_wires;
+    HandleSet<InstanceHandle> selected_instances;
+    // Blocks: I places the last one made, X explodes instances into parts
+    // and Shift+B builds the exploded block again from the selection,
+    // changing every instance of it.
+    static constexpr uint32_t NO_DEFINITION = DesignStore::NO_DEFINITION;
+    uint32_t current_definition = NO_DEFINITION;
+    uint32_t exploded_definition = NO_DEFINITION;
+    Placement exploded_at{0, 0, 0};
+    // Rubber band from where the press landed to the pointer, in world coordinates.
+    bool selecting = false;
+    double select_start_x = 0;
+    double select_start_y = 0;
+    // A drag moves the whole selection in whole grid steps; drag_dx and
+    // drag_dy are how far it has been moved so far.
+    bool dragging_selection = false;
+    double drag_press_x = 0;
+    double drag_press_y = 0;
+    double drag_dx = 0;
+    double drag_dy = 0;
+    // Set once the drag's starting positions are in the history.
+    bool drag_recorded = false;
+    // World coordinate shown at the widget's top-left corner, and the zoom level.
+    // Zoom levels are grid spacings in screen pixels, so spacing / GRID_SIZE is the scale.
+    static constexpr int ZOOM_SPACINGS[] = {1, 2, 3, 4, 5, 6, 8, 10, 12, 15, 20, 25, 30, 40, 50, 60, 80};
+    static constexpr int NUM_ZOOM_LEVELS = sizeof(ZOOM_SPACINGS) / sizeof(ZOOM_SPACINGS[0]);
+    static constexpr int DEFAULT_ZOOM_LEVEL = 10;
+    static constexpr int MIN_GRID_SPACING = 5;
+    static constexpr double LOD_ZOOM = 0.3;
+    double view_x = 0;
+    double view_y = 0;
+    int zoom_level = DEFAULT_ZOOM_LEVEL;
+    double zoom = 1.0;
+    bool panning = false;
+    double pan_last_x = 0;
+    double pan_last_y = 0;
+    bool use_grid_cache = true;
+    Cairo::RefPtr<Cairo::SurfacePattern> grid_pattern;
+    int grid_pattern_size = 0;
+    int grid_pattern_scale = 0;
+
+    // The overlay is redrawn on a timer rather than every frame, so showing
+    // it doesn't keep the canvas busy. A motion's frame latency is measured
+    // from the first motion event since the last frame.
+    static constexpr unsigned METRICS_REFRESH_MS = 500;
+    Metrics metrics;
+    bool always_record_metrics = false;
+    bool show_metrics = false;
+    sigc::connection metrics_connection;
+    bool motion_awaiting_frame = false;
+    Metrics::Clock::time_point motion_time;
+
+    // The latest pointer position not yet handled, and the tick callback
+    // that will handle it.
+    bool motion_pending = false;
+    double pending_motion_x = 0;
+    double pending_motion_y = 0;
+    guint motion_tick = 0;
+    bool timing_save = false;
+    uint64_t timed_save_generation = 0;
+    Metrics::Clock::time_point save_requested;
+
+    // Every edit bumps edit_generation; a design is dirty while it differs
+    // from the generation last written to current_filename.
+    static constexpr unsigned AUTOSAVE_INTERVAL_SECONDS = 60;
+    AsyncSaver saver;
+    AsyncExporter exporter;
+    std::string current_filename;
+    uint64_t edit_generation = 0;
+    uint64_t saved_generation = 0;
+    uint64_t autosaved_generation = 0;
+    sigc::connection autosave_connection;
+    std::function<void(const AsyncSaver::Status&)> save_status_callback;
+
+    // A full save of current_filename restarts the journal once it finishes.
+    // compaction_* describe that pending snapshot, whose checksum comes back
+    // with the save's status; the first compaction_included pending journal
+    // records are already part of it.
+    static constexpr size_t MIN_JOURNAL_COMPACTION = 4096;
+    Journal journal;
+    bool compaction_pending = false;
+    std::string compaction_filename;
+    uint64_t compaction_generation = 0;
+    size_t compaction_components = 0;
+    size_t compaction_wires = 0;
+    size_t compaction_included = 0;
+    std::vector<uint32_t> compaction_definitions;
+
+    // Undo and redo write their changes to the journal like any other edit.
+    EditHistory history;
+    HistoryChanges history_changes;
+
+    // Design rules are checked in full on load and then around each edit;
+    // the markers are collected again on the first frame after a check.
+    DesignRuleChecker rules;
+    std::vector<DrcViolation> rule_markers;
+    bool rule_markers_stale = false;
+    bool show_rule_markers = true;
     static constexpr int GRID_SIZE = 20;
     double snap_to_grid(double val) { return std::round(val / GRID_SIZE) * GRID_SIZE; }
 };
@@ -0,0 +1,63 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// DesignStore handles in the order they were added, with a mark per handle
+// slot so membership is one lookup instead of a scan. A mark holds the
+// generation it was set for, so a later object reusing the slot isn't taken
+// for a member.
+template <typename Handle>
+class HandleSet {
+public:
+    bool contains(Handle h) const {
+        return h && h.slot < marks.size() && marks[h.slot] == h.generation + 1;
+    }
+
+    // Adds h unless it is already there.
+    void insert(Handle h) {
+        if (!h || contains(h)) return;
+        if (h.slot >= marks.size()) marks.resize(h.slot + 1, 0);
+        marks[h.slot] = h.generation + 1;
+        handles.push_back(h);
+    }
+
+    void erase(Handle h) {
+        erase_if([h](Handle other) { return other == h; });
+    }
+
+    template <typename Pred>
+    void erase_if(Pred&& pred) {
+        std::erase_if(handles, [&](Handle h) {
+            if (!pred(h)) return false;
+            unmark(h);
+            return true;
+        });
+    }
+
+    void clear() {
+        for (Handle h : handles)
+            unmark(h);
+        handles.clear();
+    }
+
+    const std::vector<Handle>& items() const { return handles; }
+    operator const std::vector<Handle>&() const { return handles; }
+    auto begin() const { return handles.begin(); }
+    auto end() const { return handles.end(); }
+    size_t size() const { return handles.size(); }
+    bool empty() const { return handles.empty(); }
+
+private:
+    void unmark(Handle h) {
+        if (contains(h)) marks[h.slot] = 0;
+    }
+
+    std::vector<Handle> handles;
+    std::vector<uint32_t> marks;
+};
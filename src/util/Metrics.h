@@ -0,0 +1,179 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Distribution of the last WINDOW samples of a duration, in log-spaced
+// buckets of about 19% width from 1 us to about 16 s, so percentiles cost
+// one pass over the buckets and recording never allocates.
+class LatencyHistogram {
+public:
+    static constexpr size_t WINDOW = 1024;
+    static constexpr int BUCKETS_PER_OCTAVE = 4;
+    static constexpr int BUCKETS = 24 * BUCKETS_PER_OCTAVE;
+
+    void add(double ms) {
+        if (count == WINDOW) --counts[window[next]];
+        else ++count;
+        const uint8_t b = bucket(ms);
+        ++counts[b];
+        window[next] = b;
+        next = (next + 1) % WINDOW;
+        max_ms = std::max(max_ms, ms);
+        ++total;
+    }
+
+    void clear() { *this = LatencyHistogram(); }
+
+    // Upper edge of the bucket holding the q-quantile of the window, in ms,
+    // capped at the longest sample.
+    double percentile(double q) const {
+        if (count == 0) return 0;
+        const size_t rank = std::min(count - 1, static_cast<size_t>(q * count));
+        size_t seen = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            seen += counts[b];
+            if (seen > rank) return std::min(upper_edge(b), max_ms);
+        }
+        return max_ms;
+    }
+
+    size_t samples() const { return count; }
+    // Samples since the last clear, including those that left the window.
+    uint64_t total_samples() const { return total; }
+    // Longest sample since the last clear.
+    double max() const { return max_ms; }
+
+private:
+    static uint8_t bucket(double ms) {
+        const double us = ms * 1000;
+        if (!(us > 1)) return 0;
+        return static_cast<uint8_t>(std::min<double>(BUCKETS - 1, std::log2(us) * BUCKETS_PER_OCTAVE));
+    }
+    static double upper_edge(int b) {
+        return std::exp2(static_cast<double>(b + 1) / BUCKETS_PER_OCTAVE) / 1000;
+    }
+
+    std::array<uint16_t, BUCKETS> counts{};
+    std::array<uint8_t, WINDOW> window{};
+    size_t next = 0;
+    size_t count = 0;
+    uint64_t total = 0;
+    double max_ms = 0;
+};
+
+// Timings of the editor's interactive paths. The probes stay compiled in;
+// while disabled a Scope is one branch and never reads the clock. Only
+// meant to be used from the UI thread.
+class Metrics {
+public:
+    enum Probe {
+        Draw,           // one on_draw call
+        HitTest,        // component or wire lookup under the pointer
+        Motion,         // handling the latest pointer motion of a frame
+        EventWait,      // from the event's timestamp to its handler
+        MotionToFrame,  // from a motion event to the frame that shows it
+        Load,
+        Save,           // synchronous part of a save, or a whole journal commit
+        SaveComplete,   // from a save request to its write finishing
+        PROBE_COUNT
+    };
+
+    // Event counts, kept beside the timings.
+    enum Counter {
+        MotionEvents,   // pointer motion events received
+        MotionUpdates,  // frames that handled the latest of them
+        COUNTER_COUNT
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    // Times from construction to stop() or destruction.
+    class Scope {
+    public:
+        Scope(Metrics& metrics, Probe probe)
+            : metrics(metrics.enabled ? &metrics : nullptr), probe(probe) {
+            if (this->metrics) start = Clock::now();
+        }
+        ~Scope() { stop(); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        void stop() {
+            if (!metrics) return;
+            metrics->record(probe, start);
+            metrics = nullptr;
+        }
+
+    private:
+        Metrics* metrics;
+        Probe probe;
+        Clock::time_point start;
+    };
+
+    static const char* probe_name(Probe probe) {
+        static const char* const names[PROBE_COUNT] = {
+            "draw", "hit_test", "motion", "event_wait", "motion_to_frame", "load", "save", "save_complete"};
+        return names[probe];
+    }
+
+    static const char* counter_name(Counter counter) {
+        static const char* const names[COUNTER_COUNT] = {"motion_events", "motion_updates"};
+        return names[counter];
+    }
+
+    bool is_enabled() const { return enabled; }
+    void set_enabled(bool on) { enabled = on; }
+
+    void record(Probe probe, double ms) { histograms[probe].add(ms); }
+    void record(Probe probe, Clock::time_point start) {
+        record(probe, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+
+    void count(Counter counter) {
+        if (enabled) ++counters[counter];
+    }
+    uint64_t counter(Counter counter) const { return counters[counter]; }
+
+    const LatencyHistogram& histogram(Probe probe) const { return histograms[probe]; }
+    void clear() {
+        for (auto& h : histograms) h.clear();
+        counters.fill(0);
+    }
+
+    // Writes one CSV row per probe, then one per counter with only the
+    // samples column filled; "-" writes to standard output.
+    bool dump(const std::string& filename) const {
+        const bool to_stdout = filename == "-";
+        std::FILE* file = to_stdout ? stdout : std::fopen(filename.c_str(), "w");
+        if (!file) return false;
+        std::fprintf(file, "probe,samples,window,p50_ms,p90_ms,p99_ms,max_ms\n");
+        for (int p = 0; p < PROBE_COUNT; ++p) {
+            const LatencyHistogram& h = histograms[p];
+            std::fprintf(file, "%s,%llu,%zu,%.4f,%.4f,%.4f,%.4f\n", probe_name(static_cast<Probe>(p)),
+                         static_cast<unsigned long long>(h.total_samples()), h.samples(), h.percentile(0.5),
+                         h.percentile(0.9), h.percentile(0.99), h.max());
+        }
+        for (int c = 0; c < COUNTER_COUNT; ++c)
+            std::fprintf(file, "%s,%llu,,,,,\n", counter_name(static_cast<Counter>(c)),
+                         static_cast<unsigned long long>(counters[c]));
+        bool ok = !std::ferror(file);
+        if (to_stdout) ok = std::fflush(file) == 0 && ok;
+        else ok = std::fclose(file) == 0 && ok;
+        return ok;
+    }
+
+private:
+    bool enabled = false;
+    std::array<LatencyHistogram, PROBE_COUNT> histograms;
+    std::array<uint64_t, COUNTER_COUNT> counters{};
+};
@@ -0,0 +1,43 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <algorithm>
+
+// Axis-aligned rectangle in canvas coordinates, stored as min/max corners.
+struct Rect {
+    double x0 = 0, y0 = 0;
+    double x1 = 0, y1 = 0;
+
+    bool operator==(const Rect& o) const = default;
+
+    double width() const { return x1 - x0; }
+    double height() const { return y1 - y0; }
+    bool empty() const { return x1 <= x0 || y1 <= y0; }
+
+    bool contains(double px, double py) const {
+        return px >= x0 && px <= x1 && py >= y0 && py <= y1;
+    }
+
+    bool intersects(const Rect& o) const {
+        return x0 <= o.x1 && o.x0 <= x1 && y0 <= o.y1 && o.y0 <= y1;
+    }
+
+    Rect expanded(double m) const {
+        return Rect{x0 - m, y0 - m, x1 + m, y1 + m};
+    }
+
+    Rect united(const Rect& o) const {
+        if (empty()) return o;
+        if (o.empty()) return *this;
+        return Rect{std::min(x0, o.x0), std::min(y0, o.y0),
+                    std::max(x1, o.x1), std::max(y1, o.y1)};
+    }
+
+    static Rect from_points(double ax, double ay, double bx, double by) {
+        return Rect{std::min(ax, bx), std::min(ay, by),
+                    std::max(ax, bx), std::max(ay, by)};
+    }
+};
@@ -0,0 +1,47 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// A vector whose copies share one buffer until one of them changes it, so a
+// copy costs a reference count instead of the elements. Reads go through the
+// const interface; edit() hands out the buffer to change, first copying it
+// if another copy, say a snapshot on a worker thread, still holds it.
+template <typename T>
+class SharedVector {
+public:
+    SharedVector() : items(std::make_shared<std::vector<T>>()) {}
+
+    size_t size() const { return items->size(); }
+    bool empty() const { return items->empty(); }
+    size_t capacity() const { return items->capacity(); }
+    const T& operator[](size_t i) const { return (*items)[i]; }
+    const T& back() const { return items->back(); }
+    const T* data() const { return items->data(); }
+    auto begin() const { return items->cbegin(); }
+    auto end() const { return items->cend(); }
+    operator const std::vector<T>&() const { return *items; }
+
+    std::vector<T>& edit() {
+        if (items.use_count() > 1) {
+            items = std::make_shared<std::vector<T>>(*items);
+        } else {
+            // The last other holder may have just let go on another
+            // thread; its reads have to be finished before we write.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *items;
+    }
+
+    void push_back(const T& value) { edit().push_back(value); }
+    void reserve(size_t n) { edit().reserve(n); }
+
+private:
+    std::shared_ptr<std::vector<T>> items;
+};
@@ -0,0 +1,180 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads with a task deque each. A worker pushes and
+// pops its own tasks at the back, so recently split work stays hot in its
+// cache, and when it runs dry it steals the oldest (largest) task from the
+// front of another worker's deque.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency()) {
+        threads = std::max<size_t>(threads, 1);
+        for (size_t i = 0; i < threads; ++i)
+            queues.push_back(std::make_unique<Queue>());
+        for (size_t i = 0; i < threads; ++i)
+            workers.emplace_back([this, i] { work(i); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    // Index of the calling worker, or size() for any other thread.
+    size_t current_worker() const {
+        return worker_pool == this ? worker_index : workers.size();
+    }
+
+    void submit(Task task) {
+        size_t w = current_worker();
+        if (w == workers.size()) w = next_queue++ % workers.size();
+        {
+            std::lock_guard<std::mutex> lock(queues[w]->mutex);
+            queues[w]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            ++queued;
+        }
+        wake.notify_one();
+    }
+
+    // Calls body(begin, end) over disjoint ranges covering [0, count), none
+    // longer than grain, and returns when all have run. Ranges are split in
+    // half recursively so idle workers steal big pieces. The calling thread
+    // helps run tasks while it waits. The first exception thrown by body is
+    // rethrown here once every range has finished.
+    template <typename Body>
+    void parallel_for(size_t count, size_t grain, Body&& body) {
+        if (count == 0) return;
+        grain = std::max<size_t>(grain, 1);
+
+        struct Group {
+            std::atomic<size_t> pending{1};
+            std::mutex mutex;
+            std::condition_variable done;
+            std::exception_ptr failure;
+        } group;
+
+        std::function<void(size_t, size_t)> run = [&](size_t begin, size_t end) {
+            while (end - begin > grain) {
+                size_t mid = begin + (end - begin) / 2;
+                group.pending.fetch_add(1);
+                submit([&run, mid, end] { run(mid, end); });
+                end = mid;
+            }
+            try {
+                body(begin, end);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(group.mutex);
+                if (!group.failure) group.failure = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(group.mutex);
+            if (group.pending.fetch_sub(1) == 1) group.done.notify_all();
+        };
+
+        run(0, count);
+        while (group.pending.load() > 0) {
+            if (run_one(current_worker())) continue;
+            std::unique_lock<std::mutex> lock(group.mutex);
+            group.done.wait_for(lock, std::chrono::milliseconds(1),
+                                [&] { return group.pending.load() == 0; });
+        }
+        // The last range still holds the lock while it notifies; wait for it
+        // before the group goes out of scope.
+        std::lock_guard<std::mutex> lock(group.mutex);
+        if (group.failure) std::rethrow_exception(group.failure);
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // Pops from the back of the caller's own deque, else steals from the
+    // front of the others'.
+    bool take(size_t self, Task& task) {
+        const size_t n = queues.size();
+        if (self < n) {
+            std::lock_guard<std::mutex> lock(queues[self]->mutex);
+            if (!queues[self]->tasks.empty()) {
+                task = std::move(queues[self]->tasks.back());
+                queues[self]->tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t i = 1; i <= n; ++i) {
+            Queue& victim = *queues[(self + i) % n];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool run_one(size_t self) {
+        Task task;
+        if (!take(self, task)) return false;
+        --queued;
+        task();
+        return true;
+    }
+
+    void work(size_t index) {
+        worker_pool = this;
+        worker_index = index;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(sleep_mutex);
+                wake.wait(lock, [&] { return stopping || queued.load() > 0; });
+                if (stopping && queued.load() == 0) return;
+            }
+            while (run_one(index)) {}
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next_queue{0};
+
+    // Tasks submitted but not yet taken. Incremented under sleep_mutex so a
+    // worker can't miss a wakeup between checking it and going to sleep.
+    std::atomic<size_t> queued{0};
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    static inline thread_local const ThreadPool* worker_pool = nullptr;
+    static inline thread_local size_t worker_index = 0;
+};
@@ -0,0 +1,54 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+// Disjoint sets over 0..n-1 with union by size and path halving, so any
+// sequence of operations runs in near-linear time.
+class UnionFind {
+public:
+    explicit UnionFind(size_t n = 0) { reset(n); }
+
+    void reset(size_t n) {
+        parent.resize(n);
+        std::iota(parent.begin(), parent.end(), 0u);
+        size.assign(n, 1);
+    }
+
+    uint32_t add() {
+        parent.push_back(static_cast<uint32_t>(parent.size()));
+        size.push_back(1);
+        return parent.back();
+    }
+
+    uint32_t find(uint32_t a) {
+        while (parent[a] != a) {
+            parent[a] = parent[parent[a]];
+            a = parent[a];
+        }
+        return a;
+    }
+
+    // Returns false if a and b were already in the same set.
+    bool unite(uint32_t a, uint32_t b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return false;
+        if (size[a] < size[b]) std::swap(a, b);
+        parent[b] = a;
+        size[a] += size[b];
+        return true;
+    }
+
+    size_t count() const { return parent.size(); }
+
+private:
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> size;
+};
@@ -0,0 +1,60 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+#pragma once
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// SPICE-style scale suffixes: 4.7k, 100n, 2.2meg. As in SPICE, suffixes are
+// case insensitive ("m" is milli, "meg" is mega) and any letters after the
+// number that aren't a suffix, such as a unit name, are ignored.
+struct SiSuffix {
+    const char* name;
+    double scale;
+};
+
+inline constexpr SiSuffix SI_SUFFIXES[] = {
+    {"T", 1e12}, {"G", 1e9}, {"Meg", 1e6}, {"k", 1e3}, {"", 1.0},
+    {"m", 1e-3}, {"u", 1e-6}, {"n", 1e-9}, {"p", 1e-12}, {"f", 1e-15},
+};
+
+inline bool parse_si_value(const std::string& text, double& out) {
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    double v = std::strtod(begin, &end);
+    if (end == begin || !std::isfinite(v)) return false;
+
+    std::string rest;
+    for (; *end; ++end) {
+        if (!std::isspace(static_cast<unsigned char>(*end)))
+            rest += static_cast<char>(std::tolower(static_cast<unsigned char>(*end)));
+    }
+    double scale = 1.0;
+    if (rest.rfind("meg", 0) == 0) {
+        scale = 1e6;
+    } else if (!rest.empty()) {
+        for (const SiSuffix& s : SI_SUFFIXES) {
+            if (s.name[0] && s.name[1] == '\0' && rest[0] == std::tolower(s.name[0])) scale = s.scale;
+        }
+    }
+    out = v * scale;
+    return true;
+}
+
+// Shortest suffix form with up to 4 significant digits, e.g. 4700 -> "4.7k".
+inline std::string format_si_value(double v) {
+    if (v == 0 || !std::isfinite(v)) return v == 0 ? "0" : std::to_string(v);
+    for (const SiSuffix& s : SI_SUFFIXES) {
+        if (std::abs(v) >= s.scale * 0.9999995 || s.scale == 1e-15) {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%.4g%s", v / s.scale, s.name);
+            return buf;
+        }
+    }
+    return std::to_string(v);
+}
@@ -0,0 +1,644 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+// Batch processing of saved designs without a display. Every command takes
+// any number of files and works through them on all cores; results are
+// printed in the order the files were given.
+//
+//   acad-cli stats designs/*.acb
+//   acad-cli validate --strict designs/*.json
+//   acad-cli drc --json designs/*.acb
+//   acad-cli convert --to acb -o out/ designs/*.json
+//   acad-cli netlist -o netlists/ designs/*.acb
+//   acad-cli render --scale 2 -o png/ designs/*.acb
+//   acad-cli render --format pdf -o pdf/ designs/*.acb
+//   acad-cli route --connect R1.2 C1.1 --connect C1.2 Q1.B designs/*.acb
+//   acad-cli journal-check --edits 5000 designs/*.acb
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "../src/core/BinaryDesign.h"
+#include "../src/core/DesignIO.h"
+#include "../src/core/DesignRules.h"
+#include "../src/core/EditHistory.h"
+#include "../src/core/Journal.h"
+#include "../src/core/Netlist.h"
+#include "../src/core/Router.h"
+#include "../src/core/Subcircuit.h"
+#include "../src/render/Exporter.h"
+#include "../src/util/ThreadPool.h"
+
+namespace {
+
+struct Options {
+    std::string command;
+    std::vector<std::string> files;
+    // Pin pairs for route, written COMPONENT.PIN.
+    std::vector<std::pair<std::string, std::string>> connections;
+    std::string output_dir;
+    std::string to = "acb";
+    std::string format = "png";
+    double scale = 1.0;
+    size_t edits = 2000;
+    uint32_t seed = 1;
+    bool strict = false;
+    bool json = false;
+    size_t threads = std::thread::hardware_concurrency();
+};
+
+// text goes to stdout; error, for files that couldn't be processed at all,
+// goes to stderr.
+struct Outcome {
+    bool ok = true;
+    std::string text;
+    std::string error;
+};
+
+void usage(const char* program) {
+    std::cerr << "usage: " << program << " COMMAND [options] FILE...\n"
+              << "commands:\n"
+              << "  stats      component, wire and net counts and extents\n"
+              << "  validate   check values, wires and connectivity\n"
+              << "  drc        check design rules: overlaps, loose, crossing and doubled wires\n"
+              << "  convert    rewrite in another format (--to acb|json)\n"
+              << "  netlist    write a SPICE netlist (.cir)\n"
+              << "  render     draw to a PNG, SVG or PDF image\n"
+              << "  route      wire the --connect pin pairs around the parts (-routed copy)\n"
+              << "  journal-check  edit a scratch copy at random and check journal replay rebuilds it\n"
+              << "options:\n"
+              << "  -o, --output-dir DIR  write outputs to DIR instead of next to each input\n"
+              << "  -j, --threads N       worker threads (default: all cores)\n"
+              << "  --to FORMAT           convert target, acb or json (default acb)\n"
+              << "  --format FORMAT       render output, png, svg or pdf (default png)\n"
+              << "  --scale S             render scale, pixels or points per canvas unit (default 1)\n"
+              << "  --connect FROM TO     route a wire between two pins, e.g. R1.2 Q1.B (repeatable)\n"
+              << "  --edits N             journal-check edits per file (default 2000)\n"
+              << "  --seed S              journal-check random seed (default 1)\n"
+              << "  --strict              validate treats warnings as errors\n"
+              << "  --json                stats, validate and drc print one JSON object per file\n";
+}
+
+// Path of the file derived from input with a new extension, in output_dir
+// if one was given.
+std::string output_path(const Options& options, const std::string& input, const std::string& extension) {
+    size_t slash = input.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "" : input.substr(0, slash + 1);
+    std::string name = slash == std::string::npos ? input : input.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos && dot > 0) name.resize(dot);
+    if (!options.output_dir.empty()) {
+        dir = options.output_dir;
+        if (dir.back() != '/') dir += '/';
+    }
+    return dir + name + extension;
+}
+
+Rect design_bounds(const ComponentList& components, const WireList& wires) {
+    Rect bounds;
+    for (const auto& comp : components) bounds = bounds.united(comp->get_draw_bounds());
+    for (const auto& wire : wires) bounds = bounds.united(wire->get_draw_bounds());
+    return bounds;
+}
+
+Outcome stats(const Options& options, const std::string& file, const ComponentList& components,
+              const WireList& wires, double load_ms) {
+    size_t kinds[4] = {0, 0, 0, 0};
+    for (const auto& comp : components) ++kinds[static_cast<int>(comp->get_kind())];
+    Netlist netlist = extract_netlist(components, wires);
+    const std::vector<bool> pins = find_dangling_pins(netlist);
+    const size_t dangling = std::count(pins.begin(), pins.end(), true);
+    Rect bounds = design_bounds(components, wires);
+
+    std::ostringstream out;
+    if (options.json) {
+        json j;
+        j["file"] = file;
+        j["components"] = components.size();
+        j["resistors"] = kinds[0];
+        j["capacitors"] = kinds[1];
+        j["coils"] = kinds[2];
+        j["transistors"] = kinds[3];
+        j["wires"] = wires.size();
+        j["nets"] = netlist.net_count;
+        j["dangling_pins"] = dangling;
+        j["width"] = bounds.width();
+        j["height"] = bounds.height();
+        j["load_ms"] = load_ms;
+        out << j.dump() << "\n";
+    } else {
+        out << file << ": " << components.size() << " components (" << kinds[0] << " R, " << kinds[1]
+            << " C, " << kinds[2] << " L, " << kinds[3] << " Q), " << wires.size() << " wires, "
+            << netlist.net_count << " nets, " << dangling << " dangling pins, " << bounds.width() << " x "
+            << bounds.height() << ", loaded in " << load_ms << " ms\n";
+    }
+    return Outcome{true, out.str(), ""};
+}
+
+Outcome validate(const Options& options, const std::string& file, const ComponentList& components,
+                 const WireList& wires) {
+    std::vector<std::string> errors, warnings;
+    const std::vector<std::string> names = component_designators(components);
+
+    std::set<std::tuple<int, double, double, double>> placed;
+    for (size_t i = 0; i < components.size(); ++i) {
+        const auto& comp = components[i];
+        const ComponentKind kind = comp->get_kind();
+        if (!std::isfinite(comp->x) || !std::isfinite(comp->y) || !(comp->width > 0) || !(comp->height > 0))
+            errors.push_back(names[i] + " has an invalid position or size");
+        bool strictly_positive = kind == ComponentKind::Resistor || kind == ComponentKind::Transistor;
+        if (!std::isfinite(comp->value) || comp->value < 0 || (strictly_positive && comp->value == 0))
+            errors.push_back(names[i] + " has an invalid value");
+        if (!placed.emplace(static_cast<int>(kind), comp->x, comp->y, comp->get_rotation()).second)
+            warnings.push_back(names[i] + " sits exactly on top of another " + comp->get_type());
+    }
+    for (size_t i = 0; i < wires.size(); ++i) {
+        const auto& w = wires[i];
+        if (!std::isfinite(w->get_x1()) || !std::isfinite(w->get_y1()) ||
+            !std::isfinite(w->get_x2()) || !std::isfinite(w->get_y2()))
+            errors.push_back("wire " + std::to_string(i + 1) + " has an invalid endpoint");
+        else if (w->get_x1() == w->get_x2() && w->get_y1() == w->get_y2())
+            warnings.push_back("wire " + std::to_string(i + 1) + " has zero length");
+    }
+
+    Netlist netlist = extract_netlist(components, wires);
+    const std::vector<bool> dangling = find_dangling_pins(netlist);
+    for (size_t i = 0; i < components.size(); ++i) {
+        for (size_t p = netlist.pin_offsets[i]; p < netlist.pin_offsets[i + 1]; ++p) {
+            if (dangling[p])
+                warnings.push_back(names[i] + "." + netlist.pins[p].name + " is not connected");
+        }
+    }
+
+    const bool ok = errors.empty() && (!options.strict || warnings.empty());
+    std::ostringstream out;
+    if (options.json) {
+        json j;
+        j["file"] = file;
+        j["ok"] = ok;
+        j["errors"] = errors;
+        j["warnings"] = warnings;
+        out << j.dump() << "\n";
+    } else {
+        out << file << ": " << (ok ? "ok" : "FAILED") << " (" << errors.size() << " errors, "
+            << warnings.size() << " warnings)\n";
+        for (const auto& e : errors) out << "  error: " << e << "\n";
+        for (const auto& w : warnings) out << "  warning: " << w << "\n";
+    }
+    return Outcome{ok, out.str(), ""};
+}
+
+// Every violation of the design rules, naming parts by designator and
+// wires by their 1-based position in the file.
+Outcome drc(const Options& options, const std::string& file, const ComponentList& components,
+            const WireList& wires) {
+    const DesignStore design(components, wires);
+    DesignRuleChecker rules;
+    rules.check_all(design);
+    std::vector<DrcViolation> violations;
+    rules.collect(violations);
+    std::sort(violations.begin(), violations.end(), [](const DrcViolation& a, const DrcViolation& b) {
+        return std::tie(a.rule, a.y, a.x) < std::tie(b.rule, b.y, b.x);
+    });
+
+    const std::vector<std::string> names = component_designators(components);
+    auto objects = [&](const DrcViolation& v) {
+        std::vector<std::string> out;
+        for (ComponentHandle h : {v.component, v.other_component})
+            if (h) out.push_back(names[design.index_of(h)]);
+        for (WireHandle h : {v.wire, v.other_wire})
+            if (h) out.push_back("wire " + std::to_string(design.index_of(h) + 1));
+        return out;
+    };
+
+    std::ostringstream out;
+    if (options.json) {
+        json list = json::array();
+        for (const DrcViolation& v : violations)
+            list.push_back({{"rule", drc_rule_name(v.rule)}, {"x", v.x}, {"y", v.y}, {"objects", objects(v)}});
+        json j;
+        j["file"] = file;
+        j["ok"] = violations.empty();
+        j["violations"] = list;
+        out << j.dump() << "\n";
+    } else {
+        out << file << ": " << (violations.empty() ? "ok" : "FAILED") << " (" << violations.size()
+            << " violations)\n";
+        for (const DrcViolation& v : violations) {
+            out << "  " << drc_rule_name(v.rule) << " at (" << v.x << ", " << v.y << "):";
+            for (const std::string& name : objects(v)) out << " " << name;
+            out << "\n";
+        }
+    }
+    return Outcome{violations.empty(), out.str(), ""};
+}
+
+Outcome convert(const Options& options, const std::string& file, const DesignStore& design) {
+    const std::string target = output_path(options, file, options.to == "json" ? ".json" : BINARY_DESIGN_EXTENSION);
+    if (target == file) return Outcome{false, "", file + ": already " + options.to + ", not overwriting\n"};
+    if (!save_design_atomic(target, design))
+        return Outcome{false, "", file + ": failed to write " + target + "\n"};
+    return Outcome{true, file + " -> " + target + "\n", ""};
+}
+
+Outcome netlist(const Options& options, const std::string& file, const ComponentList& components,
+                const WireList& wires) {
+    const std::string target = output_path(options, file, ".cir");
+    if (!export_spice_netlist(target, components, wires))
+        return Outcome{false, "", file + ": failed to write " + target + "\n"};
+    return Outcome{true, file + " -> " + target + "\n", ""};
+}
+
+// Large PNGs are rendered in tiles spread over the same pool as the files.
+Outcome render(const Options& options, const std::string& file, const ComponentList& components,
+               const WireList& wires, ThreadPool& pool) {
+    const std::string target = output_path(options, file, "." + options.format);
+    ExportFormat format;
+    export_format_for(target, format);
+    ExportOptions export_options;
+    export_options.scale = options.scale;
+    if (!export_design(DesignStore(components, wires), target, format, export_options, pool))
+        return Outcome{false, "", file + ": failed to render " + target + "\n"};
+    return Outcome{true, file + " -> " + target + "\n", ""};
+}
+
+// Routes are found together on the pool and see the parts but not each
+// other. Pins are named and parts avoided as in the expanded design, but the
+// wires go into the design as loaded, so its blocks are kept. The result is
+// saved beside the input with "-routed" added to its name, in the same
+// format; pairs that can't be routed are reported and left unwired.
+Outcome route(const Options& options, const std::string& file, DesignStore& design, ThreadPool& pool) {
+    const DesignStore expanded = design.instance_count() > 0 ? design.flattened() : DesignStore();
+    const DesignStore& view = design.instance_count() > 0 ? expanded : design;
+    ComponentList components;
+    WireList wires;
+    view.to_lists(components, wires);
+    const std::vector<std::string> names = component_designators(components);
+    auto find_pin = [&](const std::string& text, Pin& out) {
+        const size_t dot = text.find('.');
+        if (dot == std::string::npos) return false;
+        const auto it = std::find(names.begin(), names.end(), text.substr(0, dot));
+        if (it == names.end()) return false;
+        Pin pins[CircuitComponent::MAX_PINS];
+        const size_t count = components[it - names.begin()]->get_pins(pins);
+        for (size_t p = 0; p < count; ++p) {
+            if (text.compare(dot + 1, std::string::npos, pins[p].name) == 0) {
+                out = pins[p];
+                return true;
+            }
+        }
+        return false;
+    };
+
+    std::vector<RouteRequest> requests;
+    for (const auto& [from, to] : options.connections) {
+        Pin a{}, b{};
+        if (!find_pin(from, a)) return Outcome{false, "", file + ": no pin " + from + "\n"};
+        if (!find_pin(to, b)) return Outcome{false, "", file + ": no pin " + to + "\n"};
+        requests.push_back(RouteRequest{a.x, a.y, b.x, b.y});
+    }
+
+    std::vector<RoutePath> paths;
+    const size_t routed = Router(view).route_all(requests, paths, pool);
+    size_t added = 0;
+    for (const RoutePath& path : paths) added += add_route_wires(design, path);
+
+    const std::string extension = is_binary_design_file(file) ? BINARY_DESIGN_EXTENSION : ".json";
+    const std::string target = output_path(options, file, "-routed" + extension);
+    if (!save_design_atomic(target, design))
+        return Outcome{false, "", file + ": failed to write " + target + "\n"};
+
+    std::ostringstream out;
+    out << file << " -> " << target << ": " << routed << " of " << requests.size() << " routed, " << added
+        << " wires added\n";
+    for (size_t k = 0; k < paths.size(); ++k) {
+        if (paths[k].empty())
+            out << "  no route from " << options.connections[k].first << " to " << options.connections[k].second
+                << "\n";
+    }
+    return Outcome{routed == requests.size(), out.str(), ""};
+}
+
+// Random edits to a scratch copy of the design with the journal on, made as
+// the editor makes them: recorded in the undo history, with undos and redos
+// among them. After every commit the copy is loaded again with its journal
+// replayed, and has to match the design in memory. A commit the journal
+// can't hold is followed by a full save, as in the editor. Designs without
+// blocks get one, so instance edits are always covered.
+Outcome journal_check(const Options& options, const std::string& file, DesignStore& design) {
+    const std::filesystem::path dir =
+        options.output_dir.empty() ? std::filesystem::temp_directory_path() : std::filesystem::path(options.output_dir);
+    const std::filesystem::path input(file);
+    const std::string scratch = (dir / (input.stem().string() + "-journal-check-" +
+                                        std::to_string(std::hash<std::string>{}(file) % 1000000) +
+                                        input.extension().string())).string();
+
+    if (design.definition_count() == 0) {
+        DesignStore block;
+        block.add_component(ComponentKind::Resistor, 0, 0, 3 * GRID_SIZE, GRID_SIZE, 0, 1000);
+        block.add_wire(3 * GRID_SIZE, GRID_SIZE / 2.0, 5 * GRID_SIZE, GRID_SIZE / 2.0);
+        design.add_definition(std::make_shared<const SubcircuitDefinition>("Check", std::move(block)));
+        design.add_instance(0, 0, 0, 0);
+    }
+
+    Journal journal;
+    journal.set_recording(true);
+    size_t full_saves = 0;
+    auto full_save = [&] {
+        ++full_saves;
+        return save_design_atomic(scratch, design) &&
+               journal.reset(scratch, design_checksum(design), design.component_count(), design.wire_count(),
+                             journal.pending_count(), design.placed_definition_numbers());
+    };
+    auto cleanup = [&] {
+        journal.detach();
+        std::remove(scratch.c_str());
+        std::remove(journal_path(scratch).c_str());
+    };
+    if (!full_save()) {
+        cleanup();
+        return Outcome{false, "", file + ": failed to write " + scratch + "\n"};
+    }
+
+    std::mt19937 rng(options.seed);
+    auto pick = [&](size_t n) { return std::uniform_int_distribution<size_t>(0, n - 1)(rng); };
+    auto coordinate = [&] { return double(GRID_SIZE * std::uniform_int_distribution<int>(-500, 500)(rng)); };
+    auto rotation = [&] { return 90.0 * std::uniform_int_distribution<int>(0, 3)(rng); };
+
+    EditHistory history;
+    HistoryChanges changes;
+    size_t commits = 0;
+    for (size_t k = 0; k < options.edits; ++k) {
+        const size_t comps = design.component_count(), wires = design.wire_count();
+        const size_t instances = design.instance_count();
+        switch (pick(14)) {
+            case 0: {
+                const auto kind = static_cast<ComponentKind>(pick(4));
+                const ComponentGeometry g{kind, coordinate(), coordinate(), 3 * GRID_SIZE, GRID_SIZE, rotation()};
+                design.add_component(g.kind, g.x, g.y, g.width, g.height, g.rotation, 1 + pick(1000));
+                history.record_add_component(design.component_count() - 1);
+                journal.record_add_component(g, design.components().value.back());
+                break;
+            }
+            case 1: {
+                if (comps == 0) break;
+                const size_t i = pick(comps);
+                const double x = coordinate(), y = coordinate();
+                history.record_move_component(design, i);
+                design.move_component(i, x, y);
+                journal.record_move_component(i, x, y);
+                break;
+            }
+            case 2: {
+                if (comps == 0) break;
+                const size_t i = pick(comps);
+                const double r = rotation();
+                history.record_rotate_component(design, i);
+                design.set_rotation(i, r);
+                journal.record_rotate_component(i, r);
+                break;
+            }
+            case 3: {
+                if (comps == 0) break;
+                const size_t i = pick(comps);
+                const double value = 1 + pick(1000);
+                history.record_set_value(design, i);
+                design.set_value(i, value);
+                journal.record_set_value(i, value);
+                break;
+            }
+            case 4: {
+                const double x1 = coordinate(), y1 = coordinate();
+                design.add_wire(x1, y1, x1 + GRID_SIZE * (1 + pick(10)), y1);
+                history.record_add_wire(design.wire_count() - 1);
+                journal.record_add_wire(x1, y1, design.wires().x2.back(), y1);
+                break;
+            }
+            case 5: {
+                if (wires == 0) break;
+                const size_t i = pick(wires);
+                const double x1 = coordinate(), y1 = coordinate();
+                history.record_move_wire(design, i);
+                design.move_wire(i, x1, y1, x1, y1 + GRID_SIZE);
+                journal.record_move_wire(i, x1, y1, x1, y1 + GRID_SIZE);
+                break;
+            }
+            case 6: {
+                // A few parts and wires at once, as deleting a selection does;
+                // undoing it puts them back with insert runs.
+                std::set<size_t> picked_comps, picked_wires;
+                for (size_t n = pick(4) + 1; n > 0 && comps > 0; --n) picked_comps.insert(pick(comps));
+                for (size_t n = pick(4) + 1; n > 0 && wires > 0; --n) picked_wires.insert(pick(wires));
+                const std::vector<size_t> dead_comps(picked_comps.begin(), picked_comps.end());
+                const std::vector<size_t> dead_wires(picked_wires.begin(), picked_wires.end());
+                history.begin_group();
+                for (auto i = dead_comps.rbegin(); i != dead_comps.rend(); ++i)
+                    history.record_remove_component(design, *i);
+                for (auto i = dead_wires.rbegin(); i != dead_wires.rend(); ++i)
+                    history.record_remove_wire(design, *i);
+                history.end_group();
+                for (auto i = dead_comps.rbegin(); i != dead_comps.rend(); ++i)
+                    journal.record_delete_component(*i);
+                for (auto i = dead_wires.rbegin(); i != dead_wires.rend(); ++i)
+                    journal.record_delete_wire(*i);
+                design.remove_components(dead_comps);
+                design.remove_wires(dead_wires);
+                break;
+            }
+            case 7: {
+                const uint32_t d = static_cast<uint32_t>(pick(design.definition_count()));
+                const InstanceHandle h = design.add_instance(d, coordinate(), coordinate(), rotation());
+                const size_t n = design.index_of(h);
+                history.record_add_instance(n);
+                journal.record_add_instance(design.instance_row(n));
+                break;
+            }
+            case 8: {
+                if (instances == 0) break;
+                const size_t n = pick(instances);
+                const double x = coordinate(), y = coordinate(), r = rotation();
+                history.record_move_instance(design, n);
+                design.move_instance(n, x, y);
+                design.set_instance_rotation(n, r);
+                journal.record_move_instance(n, x, y, r);
+                break;
+            }
+            case 9: {
+                if (instances == 0) break;
+                const size_t n = pick(instances);
+                history.record_remove_instance(design, n);
+                journal.record_delete_instance(n);
+                design.remove_instance(n);
+                break;
+            }
+            case 10: {
+                if (instances == 0) break;
+                const size_t n = pick(instances);
+                const uint32_t d = static_cast<uint32_t>(pick(design.definition_count()));
+                history.record_set_instance_definition(design, n);
+                design.set_instance_definition(n, d);
+                journal.record_set_instance_definition(n, d);
+                break;
+            }
+            case 11:
+            case 12:
+                history.undo(design, journal, changes);
+                break;
+            default:
+                history.redo(design, journal, changes);
+                break;
+        }
+
+        // Saves come every few dozen edits, the odd one a full save.
+        if (pick(40) != 0 && k + 1 != options.edits) continue;
+        const bool saved = pick(10) == 0 ? full_save() : journal.commit(design) || full_save();
+        if (!saved) {
+            cleanup();
+            return Outcome{false, "", file + ": failed to save " + scratch + "\n"};
+        }
+        ++commits;
+
+        DesignStore loaded;
+        bool replayed = false;
+        const bool ok = load_design(scratch, loaded, replayed) && replayed;
+        if (!ok || design_checksum(loaded) != design_checksum(design)) {
+            cleanup();
+            return Outcome{false,
+                           file + ": FAILED: save " + std::to_string(commits) + ", after " + std::to_string(k + 1) +
+                               " edits, doesn't load back as saved (seed " + std::to_string(options.seed) + ")\n",
+                           ""};
+        }
+    }
+    cleanup();
+    std::ostringstream out;
+    out << file << ": ok (" << options.edits << " edits, " << commits << " saves checked, " << full_saves
+        << " of them full)\n";
+    return Outcome{true, out.str(), ""};
+}
+
+Outcome process(const Options& options, const std::string& file, ThreadPool& pool) {
+    // Converting, routing and journal checks keep subcircuit blocks;
+    // everything else sees them expanded.
+    if (options.command == "convert" || options.command == "route" || options.command == "journal-check") {
+        DesignStore design;
+        if (!load_design(file, design)) return Outcome{false, "", file + ": failed to load\n"};
+        if (options.command == "route") return route(options, file, design, pool);
+        if (options.command == "journal-check") return journal_check(options, file, design);
+        return convert(options, file, design);
+    }
+
+    ComponentList components;
+    WireList wires;
+    auto start = std::chrono::steady_clock::now();
+    if (!load_design(file, components, wires)) return Outcome{false, "", file + ": failed to load\n"};
+    double load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (options.command == "stats") return stats(options, file, components, wires, load_ms);
+    if (options.command == "validate") return validate(options, file, components, wires);
+    if (options.command == "drc") return drc(options, file, components, wires);
+    if (options.command == "netlist") return netlist(options, file, components, wires);
+    return render(options, file, components, wires, pool);
+}
+
+bool parse_options(int argc, char* argv[], Options& options) {
+    if (argc < 2) return false;
+    options.command = argv[1];
+    const std::set<std::string> commands = {"stats", "validate", "drc", "convert", "netlist", "render", "route",
+                                            "journal-check"};
+    if (!commands.count(options.command)) return false;
+
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if ((arg == "-o" || arg == "--output-dir") && has_value) {
+            options.output_dir = argv[++i];
+        } else if ((arg == "-j" || arg == "--threads") && has_value) {
+            options.threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--to" && has_value) {
+            options.to = argv[++i];
+            if (options.to != "acb" && options.to != "json") return false;
+        } else if (arg == "--format" && has_value) {
+            options.format = argv[++i];
+            if (options.format != "png" && options.format != "svg" && options.format != "pdf") return false;
+        } else if (arg == "--scale" && has_value) {
+            options.scale = std::atof(argv[++i]);
+            if (!(options.scale > 0)) return false;
+        } else if (arg == "--connect" && i + 2 < argc) {
+            options.connections.emplace_back(argv[i + 1], argv[i + 2]);
+            i += 2;
+        } else if (arg == "--edits" && has_value) {
+            options.edits = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && has_value) {
+            options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--strict") {
+            options.strict = true;
+        } else if (arg == "--json") {
+            options.json = true;
+        } else if (!arg.empty() && arg[0] == '-') {
+            return false;
+        } else {
+            options.files.push_back(arg);
+        }
+    }
+    if (options.command == "route" && options.connections.empty()) return false;
+    return !options.files.empty();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    const bool shares_pool = options.command == "render" || options.command == "route";
+    ThreadPool pool(shares_pool ? options.threads : std::min(options.threads, options.files.size()));
+
+    // Files finish in any order; print each as soon as all earlier ones have.
+    std::vector<Outcome> outcomes(options.files.size());
+    std::vector<bool> done(options.files.size(), false);
+    std::mutex output_mutex;
+    size_t next = 0;
+    size_t failures = 0;
+
+    pool.parallel_for(options.files.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Outcome outcome;
+            try {
+                outcome = process(options, options.files[i], pool);
+            } catch (const std::exception& e) {
+                outcome = Outcome{false, "", options.files[i] + ": " + e.what() + "\n"};
+            }
+
+            std::lock_guard<std::mutex> lock(output_mutex);
+            outcomes[i] = std::move(outcome);
+            done[i] = true;
+            for (; next < outcomes.size() && done[next]; ++next) {
+                std::cout << outcomes[next].text << std::flush;
+                std::cerr << outcomes[next].error;
+                if (!outcomes[next].ok) ++failures;
+                outcomes[next] = Outcome{};
+            }
+        }
+    });
+
+    return failures == 0 ? 0 : 1;
+}
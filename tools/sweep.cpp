@@ -0,0 +1,206 @@
+/*
+    Author: Aldanis Vigo <aldanisvigo@gmail.com>
+    Date: Fri Nov 21st 2025
+*/
+
+// Headless parameter sweep and Monte Carlo analysis of a saved design.
+//
+//   acad-sweep design.acb --source Q1.C R3.2 12 --probe Q1.E
+//              --tolerance R 5 --tolerance Q 20 --runs 10000 --output runs.csv
+//
+// Components are named by SPICE designator (R1, C2, Q1, numbered per kind in
+// stacking order) and pins by component and pin name (R1.1, Q1.B).
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include "../src/core/DesignIO.h"
+#include "../src/core/Netlist.h"
+#include "../src/sim/Sweep.h"
+#include "../src/util/ThreadPool.h"
+#include "../src/util/Units.h"
+
+namespace {
+
+void usage(const char* program) {
+    std::cerr << "usage: " << program << " design [options]\n"
+              << "  --source PIN+ PIN- VOLTS     DC source, PIN- is ground\n"
+              << "  --probe PIN                  record the voltage at a pin (repeatable)\n"
+              << "  --tolerance KIND PERCENT     Monte Carlo spread for R, C, L or Q (repeatable)\n"
+              << "  --gaussian                   draw tolerances from a normal distribution\n"
+              << "  --sweep COMP FROM TO STEPS   step a value, add 'log' for log spacing\n"
+              << "  --place COMP X Y [ROTATION]  alternative placement (repeatable)\n"
+              << "  --runs N                     Monte Carlo samples per sweep point (default 1)\n"
+              << "  --seed N                     random seed (default 1)\n"
+              << "  --threads N                  worker threads (default: all cores)\n"
+              << "  --output FILE                .csv, .bin, or - for CSV on stdout\n";
+}
+
+bool parse_kind(const std::string& text, ComponentKind& kind) {
+    if (text == "R") kind = ComponentKind::Resistor;
+    else if (text == "C") kind = ComponentKind::Capacitor;
+    else if (text == "L") kind = ComponentKind::Coil;
+    else if (text == "Q") kind = ComponentKind::Transistor;
+    else return false;
+    return true;
+}
+
+bool ends_with(const std::string& s, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argv[1][0] == '-') {
+        usage(argv[0]);
+        return 1;
+    }
+
+    ComponentList components;
+    WireList wires;
+    if (!load_design(argv[1], components, wires)) {
+        std::cerr << "Failed to load " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::map<std::string, uint32_t> by_name;
+    const std::vector<std::string> names = component_designators(components);
+    for (uint32_t i = 0; i < names.size(); ++i) by_name[names[i]] = i;
+
+    auto find_component = [&](const std::string& name, uint32_t& out) {
+        auto it = by_name.find(name);
+        if (it == by_name.end()) {
+            std::cerr << "No component " << name << std::endl;
+            return false;
+        }
+        out = it->second;
+        return true;
+    };
+    auto find_pin = [&](const std::string& text, PinRef& out) {
+        size_t dot = text.find('.');
+        if (dot == std::string::npos || !find_component(text.substr(0, dot), out.component)) {
+            if (dot == std::string::npos) std::cerr << "Pins are written COMPONENT.PIN, not " << text << std::endl;
+            return false;
+        }
+        Pin pins[CircuitComponent::MAX_PINS];
+        size_t count = components[out.component]->get_pins(pins);
+        for (uint32_t p = 0; p < count; ++p) {
+            if (text.compare(dot + 1, std::string::npos, pins[p].name) == 0) {
+                out.pin = p;
+                return true;
+            }
+        }
+        std::cerr << "No pin " << text << std::endl;
+        return false;
+    };
+    auto number = [](const char* text, double& out) {
+        if (parse_si_value(text, out)) return true;
+        std::cerr << "Not a number: " << text << std::endl;
+        return false;
+    };
+
+    SweepPlan plan;
+    std::string output;
+    size_t threads = std::thread::hardware_concurrency();
+    bool gaussian = false;
+
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto has = [&](int n) { return i + n < argc; };
+        bool ok = true;
+        if (arg == "--source" && has(3)) {
+            plan.has_source = true;
+            ok = find_pin(argv[i + 1], plan.source_positive) && find_pin(argv[i + 2], plan.source_negative) &&
+                 number(argv[i + 3], plan.source_voltage);
+            i += 3;
+        } else if (arg == "--probe" && has(1)) {
+            PinRef pin;
+            ok = find_pin(argv[++i], pin);
+            plan.probes.push_back(pin);
+        } else if (arg == "--tolerance" && has(2)) {
+            SweepPlan::Tolerance t{};
+            double percent = 0;
+            ok = parse_kind(argv[i + 1], t.kind) && number(argv[i + 2], percent);
+            t.relative = percent / 100;
+            plan.tolerances.push_back(t);
+            i += 2;
+        } else if (arg == "--gaussian") {
+            gaussian = true;
+        } else if (arg == "--sweep" && has(4)) {
+            SweepPlan::ValueSweep s{};
+            ok = find_component(argv[i + 1], s.component) && number(argv[i + 2], s.from) &&
+                 number(argv[i + 3], s.to);
+            s.steps = static_cast<uint32_t>(std::atoi(argv[i + 4]));
+            i += 4;
+            if (has(1) && std::string(argv[i + 1]) == "log") {
+                s.logarithmic = true;
+                ++i;
+            }
+            plan.value_sweeps.push_back(s);
+        } else if (arg == "--place" && has(3)) {
+            uint32_t component;
+            SweepPlan::Placement::Position pos{0, 0, 0};
+            ok = find_component(argv[i + 1], component) && number(argv[i + 2], pos.x) && number(argv[i + 3], pos.y);
+            i += 3;
+            if (has(1) && std::strncmp(argv[i + 1], "--", 2) != 0) ok = ok && number(argv[++i], pos.rotation);
+            auto p = std::find_if(plan.placements.begin(), plan.placements.end(),
+                                  [&](const SweepPlan::Placement& p) { return p.component == component; });
+            if (p == plan.placements.end()) p = plan.placements.insert(p, SweepPlan::Placement{component, {}});
+            p->alternatives.push_back(pos);
+        } else if (arg == "--runs" && has(1)) {
+            plan.samples = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && has(1)) {
+            plan.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && has(1)) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--output" && has(1)) {
+            output = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        if (!ok) return 1;
+    }
+    for (auto& t : plan.tolerances) t.gaussian = gaussian;
+
+    Sweep sweep(std::move(components), std::move(wires), plan);
+    if (!sweep.get_error().empty()) {
+        std::cerr << sweep.get_error() << std::endl;
+        return 1;
+    }
+    SweepWriter writer;
+    if (!output.empty()) {
+        auto format = ends_with(output, ".bin") ? SweepWriter::Format::Binary : SweepWriter::Format::Csv;
+        if (!writer.open(output, format, sweep.columns(), plan.run_count())) {
+            std::cerr << "Failed to open " << output << std::endl;
+            return 1;
+        }
+    }
+
+    ThreadPool pool(threads);
+    SweepSummary summary;
+    bool ok = sweep.run(pool, output.empty() ? nullptr : &writer, summary);
+    if (!writer.close()) ok = false;
+    if (!ok) {
+        std::cerr << (sweep.get_error().empty() ? "Failed to write " + output : sweep.get_error()) << std::endl;
+        return 1;
+    }
+
+    std::fprintf(stderr, "%llu runs (%llu failed) on %zu threads in %.3f s: %.0f runs/s\n",
+                 static_cast<unsigned long long>(summary.runs), static_cast<unsigned long long>(summary.failed),
+                 pool.size(), summary.seconds, summary.runs_per_second());
+    const std::vector<std::string> columns = sweep.columns();
+    const size_t first_probe = columns.size() - summary.probes.size();
+    for (size_t i = 0; i < summary.probes.size(); ++i) {
+        const ProbeStats& s = summary.probes[i];
+        std::fprintf(stderr, "  %-16s mean %-10.6g sd %-10.6g min %-10.6g max %-10.6g\n",
+                     columns[first_probe + i].c_str(), s.mean, s.stddev(), s.min, s.max);
+    }
+    return 0;
+}